@@ -0,0 +1,26 @@
+#include "AdaptiveTimer.h"
+
+namespace {
+    // Nearest-rank percentile of sorted samples
+    double percentile(const std::vector<double>& sorted, double fraction) {
+        std::size_t rank = static_cast<std::size_t>(std::ceil(fraction * sorted.size()));
+        return sorted[std::min(sorted.size(), std::max<std::size_t>(rank, 1)) - 1];
+    }
+}
+
+AdaptiveTimer::Result AdaptiveTimer::summarize(std::vector<double>& samples, double mean, double halfWidth,
+                                               bool converged) {
+    Result result;
+    if (samples.empty()) {
+        return result;
+    }
+    std::sort(samples.begin(), samples.end());
+    result.iterations = static_cast<int>(samples.size());
+    result.minimum = samples.front();
+    result.median = percentile(samples, 0.50);
+    result.p99 = percentile(samples, 0.99);
+    result.mean = mean;
+    result.halfWidth = halfWidth;
+    result.converged = converged;
+    return result;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+#include "Constants.h"
+
+// Times an operation that is too quick for one run to mean anything, such
+// as a search on the visualizer's 16x16 board, where a single run is mostly
+// timer noise and first-touch allocations.
+//
+// The warm-up runs are discarded. After that every run is timed on its
+// own until, past minRuns runs, the 95% confidence interval of the mean is
+// within `tolerance` of the mean, or until the budget, which covers the
+// warm-up as well, or the run limit is used up. At least one run is timed
+// whatever the budget.
+class AdaptiveTimer {
+public:
+    struct Settings {
+        int warmupRuns = Constants::TIMING_WARMUP_RUNS;
+        int minRuns = Constants::TIMING_MIN_RUNS;
+        int maxRuns = Constants::TIMING_MAX_RUNS;
+        double tolerance = Constants::TIMING_TOLERANCE;
+        double budgetMilliseconds = Constants::TIMING_BUDGET_MS;
+    };
+
+    // Times in milliseconds. converged says whether the interval got tight
+    // enough before the budget or the run limit stopped the runs.
+    struct Result {
+        int iterations = 0;
+        double minimum = 0.0;
+        double median = 0.0;
+        double p99 = 0.0;
+        double mean = 0.0;
+        double halfWidth = 0.0;
+        bool converged = false;
+    };
+
+    template <typename Operation>
+    static Result run(const Settings& settings, Operation&& operation) {
+        typedef std::chrono::steady_clock Clock;
+        auto begin = Clock::now();
+        auto deadline = begin + std::chrono::duration_cast<Clock::duration>(
+                                    std::chrono::duration<double, std::milli>(settings.budgetMilliseconds));
+        for (int i = 0; i < settings.warmupRuns && Clock::now() < deadline; ++i) {
+            operation();
+        }
+
+        // Welford's running mean and variance, so checking the interval
+        // after each run is O(1)
+        std::vector<double> samples;
+        samples.reserve(static_cast<std::size_t>(std::min(settings.maxRuns, 4096)));
+        double mean = 0.0;
+        double squares = 0.0;
+        bool converged = false;
+        while (static_cast<int>(samples.size()) < settings.maxRuns) {
+            auto start = Clock::now();
+            operation();
+            auto end = Clock::now();
+            double sample = std::chrono::duration<double, std::milli>(end - start).count();
+            samples.push_back(sample);
+
+            double delta = sample - mean;
+            mean += delta / static_cast<double>(samples.size());
+            squares += delta * (sample - mean);
+
+            int count = static_cast<int>(samples.size());
+            converged = count >= settings.minRuns && halfWidth(squares, count) <= settings.tolerance * mean;
+            if (converged || end >= deadline) {
+                break;
+            }
+        }
+        return summarize(samples, mean, halfWidth(squares, static_cast<int>(samples.size())), converged);
+    }
+
+private:
+    // Half the width of the 95% confidence interval of the mean, by the
+    // normal approximation, which is fine past a few dozen runs
+    static double halfWidth(double squares, int count) {
+        return count > 1 ? 1.96 * std::sqrt(squares / (count - 1) / count) : 0.0;
+    }
+
+    static Result summarize(std::vector<double>& samples, double mean, double halfWidth, bool converged);
+};
@@ -1,169 +1,1287 @@
 #include "Algorithms.h"
+#include <bitset>
+#include <type_traits>
+#include "SearchKernel.h"
+#include "Trace.h"
 
-bool Algorithms::isValidCell(int x, int y) {
-    return x >= 0 && x < Constants::COLS && y >= 0 && y < Constants::ROWS;
+// Directions: up, right, down, left. A plain array, so no search allocates it.
+static const sf::Vector2i DIRECTIONS[] = {
+    {0, -1}, {1, 0}, {0, 1}, {-1, 0}
+};
+
+// Direction-optimizing BFS only weighs a bottom-up step once the frontier
+// has BOTTOM_UP_MIN_FRONTIER cells. It goes bottom-up when the frontier's
+// bounding box holds fewer than BOTTOM_UP_ENTER cells per frontier cell and
+// back to top-down past BOTTOM_UP_LEAVE; the gap keeps it from flapping
+// between the two on alternate levels. A bottom-up step reads a cell's stamp
+// sequentially where a top-down step pays a scattered label write and a
+// queue push, hence the fairly generous ratios.
+static const int BOTTOM_UP_MIN_FRONTIER = 256;
+static const int BOTTOM_UP_ENTER = 16;
+static const int BOTTOM_UP_LEAVE = 24;
+
+// ARA* weights are fixed-point, in units of 1 / ARA_WEIGHT_SCALE: the first
+// round inflates the heuristic 3x and each later one by at least 0.5 less,
+// down to 1. The deadline is checked every ARA_CLOCK_INTERVAL expansions,
+// since reading the clock costs more than an expansion.
+static const int ARA_WEIGHT_SCALE = 4;
+static const int ARA_INITIAL_WEIGHT = 12;
+static const int ARA_WEIGHT_STEP = 2;
+static const int ARA_CLOCK_INTERVAL = 64;
+
+const char* Algorithms::algorithmName(Constants::AlgorithmType algorithm) {
+    switch (algorithm) {
+        case Constants::DFS: return "DFS";
+        case Constants::BFS: return "BFS";
+        case Constants::DIJKSTRA: return "Dijkstra";
+        case Constants::ASTAR: return "A*";
+        case Constants::ALT: return "ALT";
+        case Constants::ARA_STAR: return "ARA*";
+        case Constants::JPS: return "JPS";
+        case Constants::JPS_PLUS: return "JPS+";
+        case Constants::BIDIRECTIONAL_BFS: return "Bi-BFS";
+        case Constants::BIDIRECTIONAL_DIJKSTRA: return "Bi-Dijkstra";
+        case Constants::BIT_PARALLEL_BFS: return "Bit BFS";
+        case Constants::DIRECTION_OPTIMIZING_BFS: return "DO-BFS";
+        case Constants::HPA_STAR: return "HPA*";
+        case Constants::CONTRACTION_HIERARCHY: return "CH";
+        case Constants::D_STAR_LITE: return "D* Lite";
+        case Constants::FLOW_FIELD: return "Flow Field";
+        case Constants::COOPERATIVE_ASTAR: return "WHCA*";
+        case Constants::CONFLICT_BASED_SEARCH: return "CBS";
+    }
+    return "Unknown";
 }
 
-bool Algorithms::depthFirstSearch(int grid[Constants::ROWS][Constants::COLS], 
-                                 sf::Vector2i startCell, 
-                                 sf::Vector2i goalCell, 
+void Algorithms::reconstructPath(const Grid& grid,
+                                 const SearchWorkspace& workspace,
+                                 sf::Vector2i startCell,
+                                 sf::Vector2i goalCell,
                                  std::vector<sf::Vector2i>& path) {
+    TRACE_SCOPE("reconstructPath");
+    int start = grid.index(startCell.x, startCell.y);
+    int pos = grid.index(goalCell.x, goalCell.y);
+    while (pos != start) {
+        path.push_back({grid.indexX(pos), grid.indexY(pos)});
+        pos = workspace.parent(pos);
+    }
+    path.push_back(startCell);
+    std::reverse(path.begin(), path.end());
+}
+
+namespace {
+    // Compile-time connectivity and corner policy, for instantiating a search
+    template <Constants::Connectivity C, Constants::CornerPolicy P>
+    struct MovementTag {
+        static const Constants::Connectivity connectivity = C;
+        static const Constants::CornerPolicy corners = P;
+    };
+
+    // Calls search(tag) with the tag matching the runtime movement. All
+    // 4-connected searches share one instantiation, having no corners to cut.
+    template <typename Search>
+    bool withMovement(const Movement& movement, const Search& search) {
+        if (movement.connectivity == Constants::FOUR_CONNECTED) {
+            return search(MovementTag<Constants::FOUR_CONNECTED, Constants::CUT_CORNERS>());
+        }
+        switch (movement.corners) {
+            case Constants::CUT_CORNERS:
+                return search(MovementTag<Constants::EIGHT_CONNECTED, Constants::CUT_CORNERS>());
+            case Constants::NO_SQUEEZE:
+                return search(MovementTag<Constants::EIGHT_CONNECTED, Constants::NO_SQUEEZE>());
+            case Constants::NO_CUT_CORNERS:
+                return search(MovementTag<Constants::EIGHT_CONNECTED, Constants::NO_CUT_CORNERS>());
+        }
+        return false;
+    }
+
+    // ALT's heuristic: the landmark bounds, or Manhattan distance where the
+    // landmarks know less, say about a goal in a pocket they cannot reach
+    struct LandmarkDistance {
+        static const bool NEEDS_POSITION = true;
+        const Grid& grid;
+        const LandmarkTable& table;
+        sf::Vector2i goal;
+        int goalIndex;
+        int goalCost;
+
+        int operator()(int x, int y) const {
+            int bound = table.lowerBound(grid.index(x, y), grid.cost(x, y), goalIndex, goalCost);
+            return std::max(bound, std::abs(goal.x - x) + std::abs(goal.y - y));
+        }
+    };
+
+    // Runs one kernel instantiation on the workspace's bordered copy of the
+    // grid, refreshed only when the grid has changed since the last query
+    template <class Open, Constants::Connectivity C, Constants::CornerPolicy P, class Cost, class Heuristic>
+    bool runKernel(const Grid& grid,
+                   sf::Vector2i startCell,
+                   sf::Vector2i goalCell,
+                   std::vector<sf::Vector2i>& path,
+                   SearchWorkspace& workspace,
+                   const Heuristic& heuristic,
+                   SearchStats* stats) {
+        SearchStats::Scope scope(stats, &workspace, &grid, &path, Movement(C, P));
+        path.clear();
+        PaddedGrid& padded = workspace.padded;
+        if (!padded.isCurrent(grid)) {
+            padded.build(grid);
+        }
+        workspace.begin(static_cast<std::size_t>(padded.getSize()));
+
+        int start = padded.index(startCell.x, startCell.y);
+        int goal = padded.index(goalCell.x, goalCell.y);
+        int expanded = 0;
+        bool found = SearchKernel::search<Open, C, P, Cost>(padded, start, goal, workspace, heuristic, expanded);
+        if (found) {
+            SearchKernel::reconstructPath(padded, workspace, start, goal, path);
+        }
+        if (stats) stats->nodesExpanded = expanded;
+        return found;
+    }
+}
+
+bool Algorithms::depthFirstSearch(const Grid& grid,
+                                 sf::Vector2i startCell,
+                                 sf::Vector2i goalCell,
+                                 std::vector<sf::Vector2i>& path,
+                                 SearchWorkspace& workspace,
+                                 SearchStats* stats,
+                                 const Movement& movement) {
+    return withMovement(movement, [&](auto tag) {
+        typedef decltype(tag) Tag;
+        return runKernel<SearchKernel::Stack, Tag::connectivity, Tag::corners, SearchKernel::FirstReach>(
+            grid, startCell, goalCell, path, workspace, SearchKernel::NoHeuristic(), stats);
+    });
+}
+
+bool Algorithms::breadthFirstSearch(const Grid& grid,
+                                   sf::Vector2i startCell,
+                                   sf::Vector2i goalCell,
+                                   std::vector<sf::Vector2i>& path,
+                                   SearchWorkspace& workspace,
+                                   SearchStats* stats,
+                                   const Movement& movement) {
+    return withMovement(movement, [&](auto tag) {
+        typedef decltype(tag) Tag;
+        return runKernel<SearchKernel::Queue, Tag::connectivity, Tag::corners, SearchKernel::StepCount>(
+            grid, startCell, goalCell, path, workspace, SearchKernel::NoHeuristic(), stats);
+    });
+}
+
+bool Algorithms::directionOptimizingBreadthFirstSearch(const Grid& grid,
+                                                       sf::Vector2i startCell,
+                                                       sf::Vector2i goalCell,
+                                                       std::vector<sf::Vector2i>& path,
+                                                       SearchWorkspace& workspace,
+                                                       SearchStats* stats) {
+    SearchStats::Scope scope(stats, &workspace, &grid, &path);
+    path.clear();
+    int expanded = 0;
+    int bottomUpLevels = 0;
+    workspace.begin(grid);
+
+    std::vector<int>& frontier = workspace.frontier[0];
+    std::vector<int>& next = workspace.next;
+    int start = grid.index(startCell.x, startCell.y);
+    int goal = grid.index(goalCell.x, goalCell.y);
+    workspace.label(start, 0, -1);
+    frontier.push_back(start);
+    workspace.countPush(frontier.size());
+
+    bool bottomUp = false;
+
+    for (int level = 0; !frontier.empty() && !workspace.isLabelled(goal); ++level) {
+        // Only cells in the frontier's bounding box grown by one can join
+        // the next level, so that box is what a bottom-up step scans
+        int left = 0, right = -1, top = 0, bottom = -1;
+        if (frontier.size() >= static_cast<size_t>(BOTTOM_UP_MIN_FRONTIER)) {
+            int minX = INT_MAX, maxX = INT_MIN, minY = INT_MAX, maxY = INT_MIN;
+            for (int index : frontier) {
+                int x = grid.indexX(index);
+                int y = grid.indexY(index);
+                minX = std::min(minX, x); maxX = std::max(maxX, x);
+                minY = std::min(minY, y); maxY = std::max(maxY, y);
+            }
+            left = std::max(minX - 1, 0);
+            right = std::min(maxX + 1, grid.getCols() - 1);
+            top = std::max(minY - 1, 0);
+            bottom = std::min(maxY + 1, grid.getRows() - 1);
+
+            long long box = static_cast<long long>(right - left + 1) * (bottom - top + 1);
+            long long size = static_cast<long long>(frontier.size());
+            if (!bottomUp && box < size * BOTTOM_UP_ENTER) {
+                bottomUp = true;
+            } else if (bottomUp && box > size * BOTTOM_UP_LEAVE) {
+                bottomUp = false;
+            }
+        } else {
+            bottomUp = false;
+        }
+
+        next.clear();
+        if (bottomUp) {
+            // Each unvisited cell stops at the first neighbour on this level
+            ++bottomUpLevels;
+            for (int y = top; y <= bottom; ++y) {
+                for (int x = left; x <= right; ++x) {
+                    int index = grid.index(x, y);
+                    if (workspace.isLabelled(index) || grid.isWall(x, y)) {
+                        continue;
+                    }
+                    ++expanded;
+                    for (auto& dir : DIRECTIONS) {
+                        int newX = x + dir.x;
+                        int newY = y + dir.y;
+                        if (grid.isValidCell(newX, newY) && workspace.distance(grid.index(newX, newY)) == level) {
+                            workspace.label(index, level + 1, grid.index(newX, newY));
+                            next.push_back(index);
+                            workspace.countPush(frontier.size() + next.size());
+                            break;
+                        }
+                    }
+                }
+            }
+        } else {
+            for (int current : frontier) {
+                ++expanded;
+                int x = grid.indexX(current);
+                int y = grid.indexY(current);
+                for (auto& dir : DIRECTIONS) {
+                    int newX = x + dir.x;
+                    int newY = y + dir.y;
+                    if (grid.isValidCell(newX, newY) && !workspace.isLabelled(grid.index(newX, newY)) &&
+                        !grid.isWall(newX, newY)) {
+                        workspace.label(grid.index(newX, newY), level + 1, current);
+                        next.push_back(grid.index(newX, newY));
+                        workspace.countPush(frontier.size() + next.size());
+                    }
+                }
+            }
+        }
+        std::swap(frontier, next);
+    }
+
+    if (stats) {
+        stats->nodesExpanded = expanded;
+        stats->bottomUpLevels = bottomUpLevels;
+    }
+    if (!workspace.isLabelled(goal)) {
+        return false;
+    }
+    reconstructPath(grid, workspace, startCell, goalCell, path);
+    return true;
+}
+
+bool Algorithms::dijkstraAlgorithm(const Grid& grid,
+                                  sf::Vector2i startCell,
+                                  sf::Vector2i goalCell,
+                                  std::vector<sf::Vector2i>& path,
+                                  SearchWorkspace& workspace,
+                                  SearchStats* stats,
+                                  const Movement& movement) {
+    // 4-connected step costs are small integers, so a bucket queue replaces
+    // the binary heap. Fixed-point diagonal costs would need a ring a
+    // hundred times longer, so 8-connected searches keep the heap.
+    return withMovement(movement, [&](auto tag) {
+        typedef decltype(tag) Tag;
+        typedef typename std::conditional<Tag::connectivity == Constants::FOUR_CONNECTED,
+                                          SearchKernel::Buckets, SearchKernel::Heap>::type Open;
+        return runKernel<Open, Tag::connectivity, Tag::corners, SearchKernel::TerrainCost>(
+            grid, startCell, goalCell, path, workspace, SearchKernel::NoHeuristic(), stats);
+    });
+}
+
+int Algorithms::heuristicCost(Constants::HeuristicType heuristic, int dx, int dy,
+                              Constants::Connectivity connectivity) {
+    using SearchKernel::distanceBound;
+    bool eight = connectivity == Constants::EIGHT_CONNECTED;
+    switch (heuristic) {
+        case Constants::MANHATTAN:
+            return eight ? distanceBound<Constants::MANHATTAN, Constants::EIGHT_CONNECTED>(dx, dy)
+                         : distanceBound<Constants::MANHATTAN, Constants::FOUR_CONNECTED>(dx, dy);
+        case Constants::OCTILE:
+            return eight ? distanceBound<Constants::OCTILE, Constants::EIGHT_CONNECTED>(dx, dy)
+                         : distanceBound<Constants::OCTILE, Constants::FOUR_CONNECTED>(dx, dy);
+        case Constants::EUCLIDEAN:
+            return eight ? distanceBound<Constants::EUCLIDEAN, Constants::EIGHT_CONNECTED>(dx, dy)
+                         : distanceBound<Constants::EUCLIDEAN, Constants::FOUR_CONNECTED>(dx, dy);
+    }
+    return 0;
+}
+
+bool Algorithms::aStarSearch(const Grid& grid,
+                             sf::Vector2i startCell,
+                             sf::Vector2i goalCell,
+                             std::vector<sf::Vector2i>& path,
+                             SearchWorkspace& workspace,
+                             Constants::HeuristicType heuristic,
+                             SearchStats* stats,
+                             const Movement& movement) {
+    // The workspace heap orders by f = g + h, preferring the deeper node on
+    // ties; the heuristic is a template argument too, so it inlines
+    return withMovement(movement, [&](auto tag) {
+        typedef decltype(tag) Tag;
+        switch (heuristic) {
+            case Constants::MANHATTAN:
+                return runKernel<SearchKernel::Heap, Tag::connectivity, Tag::corners, SearchKernel::TerrainCost>(
+                    grid, startCell, goalCell, path, workspace,
+                    SearchKernel::GoalDistance<Constants::MANHATTAN, Tag::connectivity>{goalCell}, stats);
+            case Constants::OCTILE:
+                return runKernel<SearchKernel::Heap, Tag::connectivity, Tag::corners, SearchKernel::TerrainCost>(
+                    grid, startCell, goalCell, path, workspace,
+                    SearchKernel::GoalDistance<Constants::OCTILE, Tag::connectivity>{goalCell}, stats);
+            case Constants::EUCLIDEAN:
+                return runKernel<SearchKernel::Heap, Tag::connectivity, Tag::corners, SearchKernel::TerrainCost>(
+                    grid, startCell, goalCell, path, workspace,
+                    SearchKernel::GoalDistance<Constants::EUCLIDEAN, Tag::connectivity>{goalCell}, stats);
+        }
+        path.clear();
+        return false;
+    });
+}
+
+bool Algorithms::landmarkSearch(const Grid& grid,
+                                const LandmarkTable& table,
+                                sf::Vector2i startCell,
+                                sf::Vector2i goalCell,
+                                std::vector<sf::Vector2i>& path,
+                                SearchWorkspace& workspace,
+                                SearchStats* stats) {
+    LandmarkDistance heuristic = {grid, table, goalCell, grid.index(goalCell.x, goalCell.y),
+                                  grid.cost(goalCell.x, goalCell.y)};
+    return runKernel<SearchKernel::Heap, Constants::FOUR_CONNECTED, Constants::CUT_CORNERS, SearchKernel::TerrainCost>(
+        grid, startCell, goalCell, path, workspace, heuristic, stats);
+}
+
+bool Algorithms::anytimeSearch(const Grid& grid,
+                               sf::Vector2i startCell,
+                               sf::Vector2i goalCell,
+                               std::vector<sf::Vector2i>& path,
+                               SearchWorkspace& workspace,
+                               std::chrono::steady_clock::time_point deadline,
+                               SearchStats* stats,
+                               int pathLimit) {
+    SearchStats::Scope scope(stats, &workspace, &grid, &path);
     path.clear();
-    std::vector<std::vector<bool>> visited(Constants::ROWS, std::vector<bool>(Constants::COLS, false));
-    std::stack<sf::Vector2i> stack;
-    std::vector<std::vector<sf::Vector2i>> parent(Constants::ROWS, std::vector<sf::Vector2i>(Constants::COLS, {-1, -1}));
+    int expanded = 0;
+    int solutions = 0;
+    float bound = 1.0f;
+    bool timedOut = false;
+    if (stats) stats->timedOut = false;
+    if (!grid.isWalkable(startCell.x, startCell.y) || !grid.isWalkable(goalCell.x, goalCell.y)) {
+        if (stats) stats->nodesExpanded = 0;
+        return false;
+    }
 
-    // Directions: up, right, down, left
-    const std::vector<sf::Vector2i> DIRECTIONS = {
-        {0, -1}, {1, 0}, {0, 1}, {-1, 0}
+    // Side 0 labels hold g and the parent. A cell's side 1 distance is the
+    // last round that expanded it: a cell that gets cheaper after being
+    // expanded in this round waits in `inconsistent` for the next one
+    // instead of being expanded again, which is what keeps later rounds
+    // short.
+    workspace.begin(grid);
+    int start = grid.index(startCell.x, startCell.y);
+    int goal = grid.index(goalCell.x, goalCell.y);
+    std::vector<int>& inconsistent = workspace.stack;
+    std::vector<int>& open = workspace.queue;
+    auto heuristic = [&](int index) {
+        return heuristicCost(Constants::MANHATTAN, goalCell.x - grid.indexX(index), goalCell.y - grid.indexY(index));
     };
+    auto estimate = [&](int cost, int index, int weight) {
+        return static_cast<int>(cost + static_cast<long long>(heuristic(index)) * weight / ARA_WEIGHT_SCALE);
+    };
+
+    int weight = ARA_INITIAL_WEIGHT;
+    int sinceClock = 0;
+    workspace.label(start, 0, -1);
+    workspace.pushHeap({start, 0, estimate(0, start, weight)});
+
+    for (int round = 0;; ++round) {
+        // Weighted A*, until the goal's cost is no more than any open
+        // cell's inflated estimate
+        bool interrupted = false;
+        while (!workspace.heapEmpty() && workspace.heapTop().estimate < workspace.distance(goal)) {
+            SearchWorkspace::HeapNode current = workspace.popHeap();
+            if (current.cost > workspace.distance(current.index)) {
+                continue;
+            }
+            if (++sinceClock == ARA_CLOCK_INTERVAL) {
+                sinceClock = 0;
+                if (std::chrono::steady_clock::now() >= deadline) {
+                    interrupted = true;
+                    break;
+                }
+            }
 
-    stack.push(startCell);
-    visited[startCell.y][startCell.x] = true;
+            ++expanded;
+            workspace.label(current.index, round, -1, 1);
 
-    while (!stack.empty()) {
-        sf::Vector2i current = stack.top();
-        stack.pop();
+            int x = grid.indexX(current.index);
+            int y = grid.indexY(current.index);
+            for (auto& dir : DIRECTIONS) {
+                int newX = x + dir.x;
+                int newY = y + dir.y;
+                if (!grid.isValidCell(newX, newY) || grid.isWall(newX, newY)) {
+                    continue;
+                }
+                int neighbor = grid.index(newX, newY);
+                int newCost = current.cost + grid.cost(newX, newY);
+                if (newCost < workspace.distance(neighbor)) {
+                    workspace.countIfLabelled(neighbor);
+                    workspace.label(neighbor, newCost, current.index);
+                    if (workspace.distance(neighbor, 1) == round) {
+                        inconsistent.push_back(neighbor);
+                        workspace.countPush(workspace.heapSize() + inconsistent.size());
+                    } else {
+                        workspace.pushHeap({neighbor, newCost, estimate(newCost, neighbor, weight)});
+                    }
+                }
+            }
+        }
+
+        // An interrupted round leaves the parents half rewritten, so the
+        // path from the last finished round stands, if there is one
+        if (interrupted || !workspace.isLabelled(goal)) {
+            timedOut = interrupted && solutions == 0;
+            break;
+        }
+        path.clear();
+        reconstructPath(grid, workspace, startCell, goalCell, path);
+        ++solutions;
+
+        // Any cheaper path runs through an open or inconsistent cell, so the
+        // least g + h among them bounds the optimal cost from below
+        open.clear();
+        while (!workspace.heapEmpty()) {
+            SearchWorkspace::HeapNode node = workspace.popHeap();
+            if (node.cost == workspace.distance(node.index)) {
+                open.push_back(node.index);
+            }
+        }
+        open.insert(open.end(), inconsistent.begin(), inconsistent.end());
+        inconsistent.clear();
+        std::sort(open.begin(), open.end());
+        open.erase(std::unique(open.begin(), open.end()), open.end());
+
+        int goalCost = workspace.distance(goal);
+        long long lowest = goalCost;
+        for (int index : open) {
+            lowest = std::min(lowest, static_cast<long long>(workspace.distance(index)) + heuristic(index));
+        }
+        bound = lowest >= goalCost ? 1.0f
+                                   : std::min(static_cast<float>(weight) / ARA_WEIGHT_SCALE,
+                                              static_cast<float>(goalCost) / static_cast<float>(lowest));
+        if (bound <= 1.0f || (pathLimit > 0 && solutions >= pathLimit) ||
+            std::chrono::steady_clock::now() >= deadline) {
+            break;
+        }
+
+        // The next weight is below the bound just proven, or the round
+        // could not improve on it
+        weight = std::max(ARA_WEIGHT_SCALE,
+                          std::min(weight - ARA_WEIGHT_STEP, static_cast<int>(bound * ARA_WEIGHT_SCALE)));
+        for (int index : open) {
+            workspace.countDuplicate();
+            workspace.pushHeap({index, workspace.distance(index), estimate(workspace.distance(index), index, weight)});
+        }
+    }
+
+    if (stats) {
+        stats->nodesExpanded = expanded;
+        stats->solutions = solutions;
+        stats->suboptimalityBound = bound;
+        stats->timedOut = timedOut;
+    }
+    return solutions > 0;
+}
+
+int Algorithms::jumpHorizontal(const Grid& grid, int x, int y, int dx, sf::Vector2i goalCell) {
+    while (true) {
+        x += dx;
+        if (!grid.isWalkable(x, y)) {
+            return -1;
+        }
+        if ((x == goalCell.x && y == goalCell.y) || JumpPointTable::isHorizontalJumpPoint(grid, x, y, dx)) {
+            return grid.index(x, y);
+        }
+    }
+}
+
+int Algorithms::jumpVertical(const Grid& grid, int x, int y, int dy, sf::Vector2i goalCell) {
+    while (true) {
+        y += dy;
+        if (!grid.isWalkable(x, y)) {
+            return -1;
+        }
+        if (x == goalCell.x && y == goalCell.y) {
+            return grid.index(x, y);
+        }
+        // Vertical moves branch sideways at every step, so stop wherever a
+        // horizontal jump from this cell would find something
+        if (jumpHorizontal(grid, x, y, 1, goalCell) != -1 || jumpHorizontal(grid, x, y, -1, goalCell) != -1) {
+            return grid.index(x, y);
+        }
+    }
+}
+
+int Algorithms::jumpFromTable(const Grid& grid, const JumpPointTable& table,
+                              int x, int y, int dx, int dy, sf::Vector2i goalCell) {
+    JumpPointTable::Direction direction = dx > 0 ? JumpPointTable::RIGHT
+                                        : dx < 0 ? JumpPointTable::LEFT
+                                        : dy > 0 ? JumpPointTable::DOWN
+                                                 : JumpPointTable::UP;
+    int distance = table.distance(grid.index(x, y), direction);
+    int reach = std::abs(distance);
+
+    if (dy == 0) {
+        // The goal is not part of the table, so check whether this jump passes it
+        int along = (goalCell.x - x) * dx;
+        if (goalCell.y == y && along >= 1 && along <= reach) {
+            return grid.index(goalCell.x, goalCell.y);
+        }
+        return distance > 0 ? grid.index(x + dx * distance, y) : -1;
+    }
+
+    // Stop on the goal's row so the horizontal branch from there can reach it
+    int along = (goalCell.y - y) * dy;
+    if (along >= 1 && along <= reach) {
+        return grid.index(x, goalCell.y);
+    }
+    return distance > 0 ? grid.index(x, y + dy * distance) : -1;
+}
+
+bool Algorithms::jumpPointSearch(const Grid& grid,
+                                 sf::Vector2i startCell,
+                                 sf::Vector2i goalCell,
+                                 std::vector<sf::Vector2i>& path,
+                                 SearchWorkspace& workspace,
+                                 SearchStats* stats) {
+    return jumpSearch(grid, nullptr, startCell, goalCell, path, workspace, stats);
+}
+
+bool Algorithms::jumpPointSearchPlus(const Grid& grid,
+                                     const JumpPointTable& table,
+                                     sf::Vector2i startCell,
+                                     sf::Vector2i goalCell,
+                                     std::vector<sf::Vector2i>& path,
+                                     SearchWorkspace& workspace,
+                                     SearchStats* stats) {
+    return jumpSearch(grid, &table, startCell, goalCell, path, workspace, stats);
+}
 
-        if (current.x == goalCell.x && current.y == goalCell.y) {
-            // Reconstruct path
-            sf::Vector2i pos = goalCell;
-            while (pos.x != startCell.x || pos.y != startCell.y) {
-                path.push_back(pos);
-                pos = parent[pos.y][pos.x];
+bool Algorithms::jumpSearch(const Grid& grid,
+                            const JumpPointTable* table,
+                            sf::Vector2i startCell,
+                            sf::Vector2i goalCell,
+                            std::vector<sf::Vector2i>& path,
+                            SearchWorkspace& workspace,
+                            SearchStats* stats) {
+    SearchStats::Scope scope(stats, &workspace, &grid, &path);
+    path.clear();
+    int expanded = 0;
+    workspace.begin(grid);
+
+    int start = grid.index(startCell.x, startCell.y);
+    int goal = grid.index(goalCell.x, goalCell.y);
+    workspace.pushHeap({start, 0, std::abs(goalCell.x - startCell.x) + std::abs(goalCell.y - startCell.y)});
+    workspace.label(start, 0, -1);
+
+    while (!workspace.heapEmpty()) {
+        SearchWorkspace::HeapNode current = workspace.popHeap();
+
+        if (current.index == goal) {
+            // Parents are jump points, so fill in the straight runs between them
+            int pos = goal;
+            while (pos != start) {
+                int prev = workspace.parent(pos);
+                int x = grid.indexX(pos), y = grid.indexY(pos);
+                int px = grid.indexX(prev), py = grid.indexY(prev);
+                int dx = (px > x) - (px < x);
+                int dy = (py > y) - (py < y);
+                while (x != px || y != py) {
+                    path.push_back({x, y});
+                    x += dx;
+                    y += dy;
+                }
+                pos = prev;
             }
             path.push_back(startCell);
             std::reverse(path.begin(), path.end());
+            if (stats) stats->nodesExpanded = expanded;
             return true;
         }
 
-        // Try all possible directions
-        for (auto& dir : DIRECTIONS) {
-            int newX = current.x + dir.x;
-            int newY = current.y + dir.y;
+        if (current.cost > workspace.distance(current.index)) {
+            continue;
+        }
 
-            if (isValidCell(newX, newY) && !visited[newY][newX] && grid[newY][newX] != Constants::WALL) {
-                stack.push({newX, newY});
-                visited[newY][newX] = true;
-                parent[newY][newX] = current;
+        ++expanded;
+
+        int x = grid.indexX(current.index);
+        int y = grid.indexY(current.index);
+
+        // Prune by the direction we arrived from: horizontal arrivals carry
+        // on straight plus any forced vertical turn, vertical arrivals may
+        // also branch both ways horizontally
+        sf::Vector2i directions[4];
+        int count = 0;
+        int parent = workspace.parent(current.index);
+        if (parent == -1) {
+            directions[count++] = {0, -1};
+            directions[count++] = {1, 0};
+            directions[count++] = {0, 1};
+            directions[count++] = {-1, 0};
+        } else {
+            int px = grid.indexX(parent);
+            int py = grid.indexY(parent);
+            int dx = (x > px) - (x < px);
+            int dy = (y > py) - (y < py);
+            if (dy == 0) {
+                directions[count++] = {dx, 0};
+                if (grid.isWalkable(x, y - 1) && !grid.isWalkable(x - dx, y - 1)) directions[count++] = {0, -1};
+                if (grid.isWalkable(x, y + 1) && !grid.isWalkable(x - dx, y + 1)) directions[count++] = {0, 1};
+            } else {
+                directions[count++] = {0, dy};
+                directions[count++] = {1, 0};
+                directions[count++] = {-1, 0};
+            }
+        }
+
+        for (int i = 0; i < count; ++i) {
+            const sf::Vector2i& dir = directions[i];
+            int next;
+            if (table) {
+                next = jumpFromTable(grid, *table, x, y, dir.x, dir.y, goalCell);
+            } else {
+                next = dir.y == 0 ? jumpHorizontal(grid, x, y, dir.x, goalCell)
+                                  : jumpVertical(grid, x, y, dir.y, goalCell);
+            }
+            if (next == -1) {
+                continue;
+            }
+
+            int newX = grid.indexX(next);
+            int newY = grid.indexY(next);
+            int newCost = current.cost + std::abs(newX - x) + std::abs(newY - y);
+
+            if (newCost < workspace.distance(next)) {
+                workspace.countIfLabelled(next);
+                workspace.label(next, newCost, current.index);
+                workspace.pushHeap({next, newCost, newCost + std::abs(goalCell.x - newX) + std::abs(goalCell.y - newY)});
             }
         }
     }
 
+    if (stats) stats->nodesExpanded = expanded;
     return false;
 }
 
-bool Algorithms::breadthFirstSearch(int grid[Constants::ROWS][Constants::COLS], 
-                                   sf::Vector2i startCell, 
-                                   sf::Vector2i goalCell, 
-                                   std::vector<sf::Vector2i>& path) {
+void Algorithms::reconstructBidirectionalPath(const Grid& grid,
+                                              const SearchWorkspace& workspace,
+                                              int meeting,
+                                              std::vector<sf::Vector2i>& path) {
+    TRACE_SCOPE("reconstructPath");
+    // Start half, walked back from the meeting cell and then reversed
+    for (int pos = meeting; pos != -1; pos = workspace.parent(pos, 0)) {
+        path.push_back({grid.indexX(pos), grid.indexY(pos)});
+    }
+    std::reverse(path.begin(), path.end());
+
+    // Goal half, whose parents already point towards the goal
+    for (int pos = workspace.parent(meeting, 1); pos != -1; pos = workspace.parent(pos, 1)) {
+        path.push_back({grid.indexX(pos), grid.indexY(pos)});
+    }
+}
+
+bool Algorithms::bidirectionalBreadthFirstSearch(const Grid& grid,
+                                                 sf::Vector2i startCell,
+                                                 sf::Vector2i goalCell,
+                                                 std::vector<sf::Vector2i>& path,
+                                                 SearchWorkspace& workspace,
+                                                 SearchStats* stats) {
+    SearchStats::Scope scope(stats, &workspace, &grid, &path);
     path.clear();
-    std::vector<std::vector<bool>> visited(Constants::ROWS, std::vector<bool>(Constants::COLS, false));
-    std::vector<std::vector<sf::Vector2i>> parent(Constants::ROWS, std::vector<sf::Vector2i>(Constants::COLS, {-1, -1}));
-    std::queue<sf::Vector2i> queue;
+    int expanded = 0;
+    workspace.begin(grid);
 
-    // Directions: up, right, down, left
-    const std::vector<sf::Vector2i> DIRECTIONS = {
-        {0, -1}, {1, 0}, {0, 1}, {-1, 0}
-    };
+    // Side 0 is the search from the start, side 1 the one from the goal
+    std::vector<int>* frontier = workspace.frontier;
+    std::vector<int>& next = workspace.next;
+
+    int start = grid.index(startCell.x, startCell.y);
+    int goal = grid.index(goalCell.x, goalCell.y);
+    workspace.label(start, 0, -1, 0);
+    workspace.label(goal, 0, -1, 1);
+    frontier[0].push_back(start);
+    workspace.countPush(1);
+    frontier[1].push_back(goal);
+    workspace.countPush(2);
 
-    queue.push(startCell);
-    visited[startCell.y][startCell.x] = true;
+    int meeting = start == goal ? start : -1;
+    int bestLength = meeting == -1 ? INT_MAX : 0;
 
-    while (!queue.empty()) {
-        sf::Vector2i current = queue.front();
-        queue.pop();
+    while (meeting == -1 && !frontier[0].empty() && !frontier[1].empty()) {
+        int side = frontier[0].size() <= frontier[1].size() ? 0 : 1;
+        int other = 1 - side;
+        next.clear();
 
-        if (current.x == goalCell.x && current.y == goalCell.y) {
-            // Reconstruct path
-            sf::Vector2i pos = goalCell;
-            while (pos.x != startCell.x || pos.y != startCell.y) {
-                path.push_back(pos);
-                pos = parent[pos.y][pos.x];
+        for (int current : frontier[side]) {
+            ++expanded;
+            int x = grid.indexX(current);
+            int y = grid.indexY(current);
+
+            for (auto& dir : DIRECTIONS) {
+                int newX = x + dir.x;
+                int newY = y + dir.y;
+
+                if (grid.isValidCell(newX, newY) && !grid.isWall(newX, newY)) {
+                    int neighbor = grid.index(newX, newY);
+                    if (workspace.isLabelled(neighbor, side)) {
+                        continue;
+                    }
+                    int depth = workspace.distance(current, side) + 1;
+                    workspace.label(neighbor, depth, current, side);
+                    next.push_back(neighbor);
+                    workspace.countPush(frontier[0].size() + frontier[1].size() + next.size());
+
+                    if (workspace.isLabelled(neighbor, other) &&
+                        depth + workspace.distance(neighbor, other) < bestLength) {
+                        bestLength = depth + workspace.distance(neighbor, other);
+                        meeting = neighbor;
+                    }
+                }
             }
-            path.push_back(startCell);
-            std::reverse(path.begin(), path.end());
-            return true;
         }
 
+        // Copy rather than swap so each buffer keeps its own capacity and
+        // a warmed-up workspace never has to grow again
+        frontier[side].assign(next.begin(), next.end());
+    }
+
+    if (stats) {
+        stats->nodesExpanded = expanded;
+        stats->forwardFrontier = static_cast<int>(frontier[0].size());
+        stats->backwardFrontier = static_cast<int>(frontier[1].size());
+    }
+
+    if (meeting == -1) {
+        return false;
+    }
+    reconstructBidirectionalPath(grid, workspace, meeting, path);
+    return true;
+}
+
+bool Algorithms::bidirectionalDijkstra(const Grid& grid,
+                                       sf::Vector2i startCell,
+                                       sf::Vector2i goalCell,
+                                       std::vector<sf::Vector2i>& path,
+                                       SearchWorkspace& workspace,
+                                       SearchStats* stats) {
+    SearchStats::Scope scope(stats, &workspace, &grid, &path);
+    path.clear();
+    int expanded = 0;
+    workspace.begin(grid);
+
+    // Side 0 is the search from the start, side 1 the one from the goal.
+    // With no heuristic the heap estimate is just the cost.
+    int start = grid.index(startCell.x, startCell.y);
+    int goal = grid.index(goalCell.x, goalCell.y);
+    workspace.pushHeap({start, 0, 0}, 0);
+    workspace.pushHeap({goal, 0, 0}, 1);
+    workspace.label(start, 0, -1, 0);
+    workspace.label(goal, 0, -1, 1);
+
+    int meeting = start == goal ? start : -1;
+    int bestCost = meeting == -1 ? INT_MAX : 0;
+
+    while (!workspace.heapEmpty(0) && !workspace.heapEmpty(1)) {
+        // No unsettled cell can lie on a cheaper path than the best one found
+        if (static_cast<long long>(workspace.heapTop(0).cost) + workspace.heapTop(1).cost >= bestCost) {
+            break;
+        }
+
+        int side = workspace.heapTop(0).cost <= workspace.heapTop(1).cost ? 0 : 1;
+        int other = 1 - side;
+        SearchWorkspace::HeapNode current = workspace.popHeap(side);
+
+        // If we've already found a better path
+        if (current.cost > workspace.distance(current.index, side)) {
+            continue;
+        }
+
+        ++expanded;
+
+        int x = grid.indexX(current.index);
+        int y = grid.indexY(current.index);
         for (auto& dir : DIRECTIONS) {
-            int newX = current.x + dir.x;
-            int newY = current.y + dir.y;
+            int newX = x + dir.x;
+            int newY = y + dir.y;
 
-            if (isValidCell(newX, newY) && !visited[newY][newX] && grid[newY][newX] != Constants::WALL) {
-                queue.push({newX, newY});
-                visited[newY][newX] = true;
-                parent[newY][newX] = current;
+            if (grid.isValidCell(newX, newY) && !grid.isWall(newX, newY)) {
+                // Costs are paid on entering a cell, so the search from the
+                // goal pays for the cell it is leaving instead
+                int neighbor = grid.index(newX, newY);
+                int newCost = current.cost + (side == 0 ? grid.cost(newX, newY) : grid.cost(x, y));
+
+                if (newCost < workspace.distance(neighbor, side)) {
+                    workspace.countIfLabelled(neighbor, side);
+                    workspace.label(neighbor, newCost, current.index, side);
+                    workspace.pushHeap({neighbor, newCost, newCost}, side);
+                }
+                if (workspace.isLabelled(neighbor, other) &&
+                    workspace.distance(neighbor, side) + workspace.distance(neighbor, other) < bestCost) {
+                    bestCost = workspace.distance(neighbor, side) + workspace.distance(neighbor, other);
+                    meeting = neighbor;
+                }
             }
         }
     }
 
-    return false;
+    if (stats) {
+        stats->nodesExpanded = expanded;
+        stats->forwardFrontier = workspace.heapSize(0);
+        stats->backwardFrontier = workspace.heapSize(1);
+    }
+
+    if (meeting == -1) {
+        return false;
+    }
+    reconstructBidirectionalPath(grid, workspace, meeting, path);
+    return true;
 }
 
-bool Algorithms::dijkstraAlgorithm(int grid[Constants::ROWS][Constants::COLS], 
-                                  sf::Vector2i startCell, 
-                                  sf::Vector2i goalCell, 
-                                  std::vector<sf::Vector2i>& path) {
-    path.clear();
+int Algorithms::wavefrontSearch(const WallBitmap& bitmap,
+                                sf::Vector2i startCell,
+                                sf::Vector2i goalCell,
+                                SearchWorkspace& workspace,
+                                bool recordLevels,
+                                SearchStats* stats) {
+    typedef WallBitmap::Word Word;
+
+    if (!bitmap.isOpen(startCell.x, startCell.y) || !bitmap.isOpen(goalCell.x, goalCell.y)) {
+        if (stats) {
+            stats->nodesExpanded = 0;
+            stats->nodesGenerated = 0;
+            stats->peakOpen = 0;
+        }
+        return -1;
+    }
 
-    // Node struct for priority queue
-    struct Node {
-        int x, y, cost;
-        bool operator>(const Node& other) const {
-            return cost > other.cost;
+    // The planes are left all-zero by the previous query, so only a change
+    // of map size needs a full clear
+    for (auto& plane : workspace.bitPlanes) {
+        if (plane.size() != bitmap.planeSize()) {
+            plane.assign(bitmap.planeSize(), 0);
         }
+    }
+
+    const Word* open = bitmap.data();
+    Word* frontier = workspace.bitPlanes[0].data();
+    Word* next = workspace.bitPlanes[1].data();
+    Word* visited = workspace.bitPlanes[2].data();
+    const int stride = bitmap.getWordsPerRow();
+    const WallBitmap::RowKernel expand = WallBitmap::rowKernel();
+
+    std::size_t startWord = bitmap.wordIndex(startCell.x, startCell.y);
+    std::size_t goalWord = bitmap.wordIndex(goalCell.x, goalCell.y);
+    Word goalBit = WallBitmap::bit(goalCell.x);
+    frontier[startWord] = WallBitmap::bit(startCell.x);
+    visited[startWord] = WallBitmap::bit(startCell.x);
+    if (recordLevels) {
+        workspace.levelStarts.push_back(0);
+        workspace.levelWords.push_back({static_cast<int>(startWord), frontier[startWord]});
+    }
+
+    // Rows holding the current frontier, and every row visited so far
+    const int rows = bitmap.getRows();
+    int low = startCell.y, high = startCell.y;
+    int touchedLow = low, touchedHigh = high;
+    int level = 0;
+    bool found = startWord == goalWord && (frontier[goalWord] & goalBit) != 0;
+    long long widest = 1;
+
+    auto rowIsEmpty = [&](const Word* plane, int y) {
+        const Word* row = plane + static_cast<std::size_t>(y + 1) * stride;
+        return std::all_of(row, row + stride, [](Word word) { return word == 0; });
     };
 
-    // Directions: up, right, down, left
-    const std::vector<sf::Vector2i> DIRECTIONS = {
-        {0, -1}, {1, 0}, {0, 1}, {-1, 0}
+    while (!found) {
+        // Rows are stored back to back, so the whole band is one kernel call;
+        // bits carried across a row boundary land in padding that is never open
+        int first = std::max(low - 1, 0);
+        int last = std::min(high + 1, rows - 1);
+        std::size_t offset = static_cast<std::size_t>(first + 1) * stride;
+        int words = (last - first + 1) * stride;
+        int newLow = INT_MAX, newHigh = -1;
+        if (expand(open + offset, frontier + offset, next + offset, visited + offset, words, stride)) {
+            newLow = first;
+            while (rowIsEmpty(next, newLow)) ++newLow;
+            newHigh = last;
+            while (rowIsEmpty(next, newHigh)) --newHigh;
+        }
+
+        // Retire the old frontier so its plane is clean when reused as next
+        std::fill(frontier + static_cast<std::size_t>(low + 1) * stride,
+                  frontier + static_cast<std::size_t>(high + 2) * stride, 0);
+        std::swap(frontier, next);
+        if (newHigh == -1) {
+            break;
+        }
+
+        ++level;
+        low = newLow;
+        high = newHigh;
+        touchedLow = std::min(touchedLow, low);
+        touchedHigh = std::max(touchedHigh, high);
+
+        // The widest frontier is the most cells ever open; counting it costs
+        // little while the level is recorded anyway
+        bool countWidth = SearchStats::ENABLED && stats;
+        long long width = 0;
+        if (recordLevels) {
+            workspace.levelStarts.push_back(static_cast<int>(workspace.levelWords.size()));
+            std::size_t end = static_cast<std::size_t>(high + 2) * stride;
+            for (std::size_t i = static_cast<std::size_t>(low + 1) * stride; i < end; ++i) {
+                if (frontier[i] != 0) {
+                    workspace.levelWords.push_back({static_cast<int>(i), frontier[i]});
+                    if (countWidth) {
+                        width += static_cast<long long>(std::bitset<64>(frontier[i]).count());
+                    }
+                }
+            }
+        } else if (countWidth) {
+            std::size_t end = static_cast<std::size_t>(high + 2) * stride;
+            for (std::size_t i = static_cast<std::size_t>(low + 1) * stride; i < end; ++i) {
+                width += static_cast<long long>(std::bitset<64>(frontier[i]).count());
+            }
+        }
+        widest = std::max(widest, width);
+        found = (frontier[goalWord] & goalBit) != 0;
+    }
+
+    // Every cell that entered a frontier is in visited
+    if (stats) {
+        long long reached = 0;
+        for (int y = touchedLow; y <= touchedHigh; ++y) {
+            const Word* row = visited + static_cast<std::size_t>(y + 1) * stride;
+            for (int w = 0; w < stride; ++w) {
+                reached += static_cast<long long>(std::bitset<64>(row[w]).count());
+            }
+        }
+        stats->nodesExpanded = static_cast<int>(reached);
+        if (SearchStats::ENABLED) {
+            stats->nodesGenerated = reached;
+            stats->duplicatePushes = 0;
+            stats->peakOpen = widest;
+        }
+    }
+
+    // Leave every plane zeroed for the next query
+    std::fill(frontier + static_cast<std::size_t>(low + 1) * stride,
+              frontier + static_cast<std::size_t>(high + 2) * stride, 0);
+    std::fill(visited + static_cast<std::size_t>(touchedLow + 1) * stride,
+              visited + static_cast<std::size_t>(touchedHigh + 2) * stride, 0);
+
+    return found ? level : -1;
+}
+
+int Algorithms::bitParallelDistance(const WallBitmap& bitmap,
+                                    sf::Vector2i startCell,
+                                    sf::Vector2i goalCell,
+                                    SearchWorkspace& workspace,
+                                    SearchStats* stats) {
+    SearchStats::Scope scope(stats, nullptr, nullptr, nullptr);
+    int distance = wavefrontSearch(bitmap, startCell, goalCell, workspace, false, stats);
+    if (SearchStats::ENABLED && stats) {
+        stats->pathLength = std::max(distance, 0);
+        stats->pathCost = std::max(distance, 0);
+    }
+    return distance;
+}
+
+bool Algorithms::bitParallelBreadthFirstSearch(const WallBitmap& bitmap,
+                                               sf::Vector2i startCell,
+                                               sf::Vector2i goalCell,
+                                               std::vector<sf::Vector2i>& path,
+                                               SearchWorkspace& workspace,
+                                               SearchStats* stats) {
+    SearchStats::Scope scope(stats, nullptr, nullptr, &path);
+    path.clear();
+    workspace.levelWords.clear();
+    workspace.levelStarts.clear();
+    int length = wavefrontSearch(bitmap, startCell, goalCell, workspace, true, stats);
+    if (length == -1) {
+        return false;
+    }
+
+    const std::vector<SearchWorkspace::LevelWord>& words = workspace.levelWords;
+    const std::vector<int>& starts = workspace.levelStarts;
+    auto inLevel = [&](int level, int x, int y) {
+        int index = static_cast<int>(bitmap.wordIndex(x, y));
+        auto first = words.begin() + starts[level];
+        auto last = level + 1 < static_cast<int>(starts.size()) ? words.begin() + starts[level + 1] : words.end();
+        auto it = std::lower_bound(first, last, index, [](const SearchWorkspace::LevelWord& word, int value) {
+            return word.index < value;
+        });
+        return it != last && it->index == index && (it->bits & WallBitmap::bit(x)) != 0;
     };
 
-    std::priority_queue<Node, std::vector<Node>, std::greater<Node>> pq;
-    std::vector<std::vector<int>> distance(Constants::ROWS, std::vector<int>(Constants::COLS, INT_MAX));
-    std::vector<std::vector<sf::Vector2i>> parent(Constants::ROWS, std::vector<sf::Vector2i>(Constants::COLS, {-1, -1}));
+    // Any neighbour on the previous level is one step closer to the start
+    sf::Vector2i current = goalCell;
+    path.push_back(current);
+    for (int level = length - 1; level >= 0; --level) {
+        for (auto& dir : DIRECTIONS) {
+            sf::Vector2i neighbor(current.x + dir.x, current.y + dir.y);
+            if (bitmap.isOpen(neighbor.x, neighbor.y) && inLevel(level, neighbor.x, neighbor.y)) {
+                current = neighbor;
+                break;
+            }
+        }
+        path.push_back(current);
+    }
+    std::reverse(path.begin(), path.end());
+    return true;
+}
+
+bool Algorithms::contractionHierarchySearch(const Grid& grid,
+                                            const ContractionHierarchy& hierarchy,
+                                            sf::Vector2i startCell,
+                                            sf::Vector2i goalCell,
+                                            std::vector<sf::Vector2i>& path,
+                                            SearchWorkspace& workspace,
+                                            SearchStats* stats) {
+    SearchStats::Scope scope(stats, &workspace, &grid, &path);
+    path.clear();
+    int expanded = 0;
+    if (!grid.isWalkable(startCell.x, startCell.y) || !grid.isWalkable(goalCell.x, goalCell.y)) {
+        if (stats) stats->nodesExpanded = 0;
+        return false;
+    }
+
+    // Labels are indexed by hierarchy node. Side 0 climbs forward edges
+    // from the start, side 1 backward edges from the goal.
+    workspace.begin(static_cast<std::size_t>(hierarchy.getNodeCount()));
+    int source = hierarchy.nodeOf(grid.index(startCell.x, startCell.y));
+    int target = hierarchy.nodeOf(grid.index(goalCell.x, goalCell.y));
+    workspace.pushHeap({source, 0, 0}, 0);
+    workspace.pushHeap({target, 0, 0}, 1);
+    workspace.label(source, 0, -1, 0);
+    workspace.label(target, 0, -1, 1);
+
+    int meeting = -1;
+    int bestCost = INT_MAX;
+    while (true) {
+        // The two searches meet at the top of the path, not in the middle,
+        // so each side runs until nothing left on it can beat the best path
+        bool forward = !workspace.heapEmpty(0) && workspace.heapTop(0).cost < bestCost;
+        bool backward = !workspace.heapEmpty(1) && workspace.heapTop(1).cost < bestCost;
+        if (!forward && !backward) {
+            break;
+        }
+        int side = forward && (!backward || workspace.heapTop(0).cost <= workspace.heapTop(1).cost) ? 0 : 1;
+        SearchWorkspace::HeapNode current = workspace.popHeap(side);
+        if (current.cost > workspace.distance(current.index, side)) {
+            continue;
+        }
 
-    pq.push({startCell.x, startCell.y, 0});
-    distance[startCell.y][startCell.x] = 0;
+        ++expanded;
+        if (workspace.isLabelled(current.index, 1 - side) &&
+            current.cost + workspace.distance(current.index, 1 - side) < bestCost) {
+            bestCost = current.cost + workspace.distance(current.index, 1 - side);
+            meeting = current.index;
+        }
 
-    while (!pq.empty()) {
-        Node current = pq.top();
-        pq.pop();
+        // Stall on demand: if a higher node already reached on this side
+        // leads down to this one more cheaply, its label is not a shortest
+        // distance and nothing above it needs relaxing from here
+        const ContractionHierarchy::Edge* down = side == 0 ? hierarchy.backwardBegin(current.index)
+                                                           : hierarchy.forwardBegin(current.index);
+        const ContractionHierarchy::Edge* downEnd = side == 0 ? hierarchy.backwardEnd(current.index)
+                                                              : hierarchy.forwardEnd(current.index);
+        bool stalled = false;
+        for (; down != downEnd && !stalled; ++down) {
+            stalled = workspace.isLabelled(down->node, side) &&
+                      workspace.distance(down->node, side) + down->weight < current.cost;
+        }
+        if (stalled) {
+            continue;
+        }
 
-        // If we've reached the goal
-        if (current.x == goalCell.x && current.y == goalCell.y) {
-            // Reconstruct path
-            sf::Vector2i pos = goalCell;
-            while (pos.x != startCell.x || pos.y != startCell.y) {
-                path.push_back(pos);
-                pos = parent[pos.y][pos.x];
+        const ContractionHierarchy::Edge* edge = side == 0 ? hierarchy.forwardBegin(current.index)
+                                                           : hierarchy.backwardBegin(current.index);
+        const ContractionHierarchy::Edge* end = side == 0 ? hierarchy.forwardEnd(current.index)
+                                                          : hierarchy.backwardEnd(current.index);
+        for (; edge != end; ++edge) {
+            int newCost = current.cost + edge->weight;
+            if (newCost < workspace.distance(edge->node, side)) {
+                workspace.countIfLabelled(edge->node, side);
+                workspace.label(edge->node, newCost, current.index, side);
+                workspace.pushHeap({edge->node, newCost, newCost}, side);
             }
-            path.push_back(startCell);
-            std::reverse(path.begin(), path.end());
-            return true;
         }
+    }
 
-        // If we've already found a better path
-        if (current.cost > distance[current.y][current.x]) {
+    if (stats) {
+        stats->nodesExpanded = expanded;
+        stats->forwardFrontier = workspace.heapSize(0);
+        stats->backwardFrontier = workspace.heapSize(1);
+    }
+    if (meeting == -1) {
+        return false;
+    }
+
+    // The hierarchy path: up from the start to the meeting node, then down
+    // to the goal along the backward search's parents
+    std::vector<int>& nodes = workspace.stack;
+    nodes.clear();
+    for (int node = meeting; node != -1; node = workspace.parent(node, 0)) {
+        nodes.push_back(node);
+    }
+    std::reverse(nodes.begin(), nodes.end());
+    for (int node = workspace.parent(meeting, 1); node != -1; node = workspace.parent(node, 1)) {
+        nodes.push_back(node);
+    }
+
+    // Each of its edges unpacks into the unit steps it stands for
+    std::vector<int>& steps = workspace.queue;
+    steps.assign(1, nodes.front());
+    for (std::size_t i = 1; i < nodes.size(); ++i) {
+        hierarchy.unpackEdge(nodes[i - 1], nodes[i], workspace.next, steps);
+    }
+    for (int node : steps) {
+        int cell = hierarchy.cellOf(node);
+        path.push_back({grid.indexX(cell), grid.indexY(cell)});
+    }
+    return true;
+}
+
+bool Algorithms::hierarchicalSearch(const Grid& grid,
+                                    const HierarchicalGraph& graph,
+                                    sf::Vector2i startCell,
+                                    sf::Vector2i goalCell,
+                                    std::vector<sf::Vector2i>& path,
+                                    SearchWorkspace& workspace,
+                                    SearchStats* stats) {
+    SearchStats::Scope scope(stats, &workspace, &grid, &path);
+    path.clear();
+    workspace.begin(grid);
+    if (!grid.isWalkable(startCell.x, startCell.y) || !grid.isWalkable(goalCell.x, goalCell.y)) {
+        if (stats) stats->nodesExpanded = 0;
+        return false;
+    }
+
+    int start = grid.index(startCell.x, startCell.y);
+    int goal = grid.index(goalCell.x, goalCell.y);
+    int startCluster = graph.clusterOf(startCell.x, startCell.y);
+    int goalCluster = graph.clusterOf(goalCell.x, goalCell.y);
+    const HierarchicalGraph::Cluster& startNodes = graph.cluster(startCluster);
+    const HierarchicalGraph::Cluster& goalNodes = graph.cluster(goalCluster);
+
+    // Insert start and goal: their distances to and from every entrance of
+    // their own cluster
+    std::vector<int>& fromStart = workspace.clusterDistance[0];
+    std::vector<int>& toGoal = workspace.clusterDistance[1];
+    int expanded = graph.clusterDijkstra(grid, startCluster, start, false, workspace, fromStart, nullptr);
+    expanded += graph.clusterDijkstra(grid, goalCluster, goal, true, workspace, toGoal, nullptr);
+
+    auto relax = [&](int index, int cost, int parent) {
+        if (cost < workspace.distance(index)) {
+            workspace.countIfLabelled(index);
+            workspace.label(index, cost, parent);
+            int estimate = cost + heuristicCost(Constants::MANHATTAN,
+                                                grid.indexX(index) - goalCell.x,
+                                                grid.indexY(index) - goalCell.y);
+            workspace.pushHeap({index, cost, estimate});
+        }
+    };
+
+    // A* over the abstract graph; its nodes are keyed by grid index, so the
+    // workspace labels serve it unchanged
+    workspace.label(start, 0, -1);
+    workspace.pushHeap({start, 0, 0});
+    bool found = false;
+    while (!workspace.heapEmpty()) {
+        SearchWorkspace::HeapNode current = workspace.popHeap();
+        if (current.cost > workspace.distance(current.index)) {
             continue;
         }
+        if (current.index == goal) {
+            found = true;
+            break;
+        }
+        ++expanded;
 
-        for (auto& dir : DIRECTIONS) {
-            int newX = current.x + dir.x;
-            int newY = current.y + dir.y;
+        int x = grid.indexX(current.index);
+        int y = grid.indexY(current.index);
+        int id = graph.clusterOf(x, y);
+        const HierarchicalGraph::Cluster& cluster = graph.cluster(id);
+        int node = graph.nodeIndex(current.index);
 
-            if (isValidCell(newX, newY) && grid[newY][newX] != Constants::WALL) {
-                int newCost = current.cost + 1;
+        if (current.index == start) {
+            for (int entrance : startNodes.nodes) {
+                int d = fromStart[graph.localIndex(startNodes, grid.indexX(entrance), grid.indexY(entrance))];
+                if (d != INT_MAX) relax(entrance, d, start);
+            }
+            if (startCluster == goalCluster) {
+                int d = fromStart[graph.localIndex(startNodes, goalCell.x, goalCell.y)];
+                if (d != INT_MAX) relax(goal, d, start);
+            }
+        } else {
+            std::size_t n = cluster.nodes.size();
+            for (std::size_t j = 0; j < n; ++j) {
+                int d = cluster.distances[node * n + j];
+                if (d != INT_MAX && static_cast<int>(j) != node) relax(cluster.nodes[j], current.cost + d, current.index);
+            }
+            if (id == goalCluster) {
+                int d = toGoal[graph.localIndex(goalNodes, x, y)];
+                if (d != INT_MAX) relax(goal, current.cost + d, current.index);
+            }
+        }
 
-                if (newCost < distance[newY][newX]) {
-                    distance[newY][newX] = newCost;
-                    parent[newY][newX] = {current.x, current.y};
-                    pq.push({newX, newY, newCost});
+        // Step across the borders this entrance sits on
+        if (node != -1) {
+            for (const HierarchicalGraph::Link& link : graph.links(id)) {
+                if (link.node == node) {
+                    relax(link.partner, current.cost + grid.cost(grid.indexX(link.partner), grid.indexY(link.partner)),
+                          current.index);
                 }
             }
         }
     }
 
-    return false;
-}
\ No newline at end of file
+    if (!found) {
+        if (stats) stats->nodesExpanded = expanded;
+        return false;
+    }
+
+    // Abstract path from goal back to start
+    std::vector<int>& abstractPath = workspace.stack;
+    for (int pos = goal; pos != -1; pos = workspace.parent(pos)) {
+        abstractPath.push_back(pos);
+    }
+
+    // Refine: an edge between clusters is a single step, an edge inside a
+    // cluster is replayed by the same confined Dijkstra that priced it
+    path.push_back(startCell);
+    for (std::size_t k = abstractPath.size() - 1; k > 0; --k) {
+        int from = abstractPath[k];
+        int to = abstractPath[k - 1];
+        int id = graph.clusterOf(grid.indexX(from), grid.indexY(from));
+        if (id != graph.clusterOf(grid.indexX(to), grid.indexY(to))) {
+            path.push_back({grid.indexX(to), grid.indexY(to)});
+            continue;
+        }
+
+        const HierarchicalGraph::Cluster& cluster = graph.cluster(id);
+        std::vector<int>& parents = workspace.clusterParent;
+        expanded += graph.clusterDijkstra(grid, id, from, false, workspace, workspace.clusterDistance[0], &parents);
+        std::size_t segmentStart = path.size();
+        for (int pos = to; pos != from; pos = parents[graph.localIndex(cluster, grid.indexX(pos), grid.indexY(pos))]) {
+            path.push_back({grid.indexX(pos), grid.indexY(pos)});
+        }
+        std::reverse(path.begin() + segmentStart, path.end());
+    }
+
+    if (stats) stats->nodesExpanded = expanded;
+    return true;
+}
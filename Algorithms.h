@@ -1,31 +1,228 @@
 #pragma once
 
-#include <SFML/Graphics.hpp>
+#include <SFML/System/Vector2.hpp>
 #include <vector>
-#include <queue>
-#include <stack>
+#include <chrono>
 #include <climits>
 #include <algorithm>
 #include <functional>
+#include <cmath>
+#include <cstdlib>
 #include "Constants.h"
+#include "Grid.h"
+#include "SearchStats.h"
+#include "JumpPointTable.h"
+#include "LandmarkTable.h"
+#include "SearchWorkspace.h"
+#include "WallBitmap.h"
+#include "HierarchicalGraph.h"
+#include "ContractionHierarchy.h"
+#include "Movement.h"
 
+// Every search takes a SearchWorkspace that the caller keeps between queries,
+// so repeated queries reuse its tables instead of allocating new ones.
+//
+// DFS, BFS, Dijkstra and A* are instantiations of one search loop, see
+// SearchKernel.h. They also take a Movement, 4-connected by default;
+// 8-connected, BFS counts steps and Dijkstra and A* report costs in
+// Movement's fixed-point units. The other searches are 4-connected only.
 class Algorithms {
 public:
-    static bool depthFirstSearch(int grid[Constants::ROWS][Constants::COLS], 
+    static const char* algorithmName(Constants::AlgorithmType algorithm);
+
+    static bool depthFirstSearch(const Grid& grid, 
                                 sf::Vector2i startCell, 
                                 sf::Vector2i goalCell, 
-                                std::vector<sf::Vector2i>& path);
+                                std::vector<sf::Vector2i>& path,
+                                SearchWorkspace& workspace,
+                                SearchStats* stats = nullptr,
+                                const Movement& movement = Movement());
     
-    static bool breadthFirstSearch(int grid[Constants::ROWS][Constants::COLS], 
+    static bool breadthFirstSearch(const Grid& grid, 
                                   sf::Vector2i startCell, 
                                   sf::Vector2i goalCell, 
-                                  std::vector<sf::Vector2i>& path);
+                                  std::vector<sf::Vector2i>& path,
+                                  SearchWorkspace& workspace,
+                                  SearchStats* stats = nullptr,
+                                  const Movement& movement = Movement());
     
-    static bool dijkstraAlgorithm(int grid[Constants::ROWS][Constants::COLS], 
+    // Level-synchronous BFS that switches to bottom-up steps while the
+    // frontier fills most of its bounding box: instead of pushing every
+    // neighbour of every frontier cell, each unvisited cell in the box looks
+    // for a neighbour on the current level. Finds the same distances as
+    // breadthFirstSearch.
+    static bool directionOptimizingBreadthFirstSearch(const Grid& grid,
+                                                      sf::Vector2i startCell,
+                                                      sf::Vector2i goalCell,
+                                                      std::vector<sf::Vector2i>& path,
+                                                      SearchWorkspace& workspace,
+                                                      SearchStats* stats = nullptr);
+
+    // Dijkstra over the grid's terrain costs, using a bucket queue when
+    // 4-connected
+    static bool dijkstraAlgorithm(const Grid& grid, 
                                  sf::Vector2i startCell, 
                                  sf::Vector2i goalCell, 
-                                 std::vector<sf::Vector2i>& path);
+                                 std::vector<sf::Vector2i>& path,
+                                 SearchWorkspace& workspace,
+                                 SearchStats* stats = nullptr,
+                                 const Movement& movement = Movement());
+
+    // A* with an admissible heuristic towards goalCell. Ties on f are broken
+    // towards the larger g so that open maps expand little beyond the path.
+    static bool aStarSearch(const Grid& grid,
+                            sf::Vector2i startCell,
+                            sf::Vector2i goalCell,
+                            std::vector<sf::Vector2i>& path,
+                            SearchWorkspace& workspace,
+                            Constants::HeuristicType heuristic = Constants::MANHATTAN,
+                            SearchStats* stats = nullptr,
+                            const Movement& movement = Movement());
+
+    // Lower bound on the cost from one cell to another, rounded down so that
+    // every heuristic stays admissible. Terrain costs are at least
+    // Constants::MIN_TERRAIN_COST, so they never make it overestimate.
+    // 8-connected, the bound is in Movement's fixed-point units.
+    static int heuristicCost(Constants::HeuristicType heuristic, int dx, int dy,
+                             Constants::Connectivity connectivity = Constants::FOUR_CONNECTED);
+
+    // Jump Point Search for 4-connected uniform-cost grids. Only jump points
+    // are pushed to the open list; the returned path still lists every cell.
+    static bool jumpPointSearch(const Grid& grid,
+                                sf::Vector2i startCell,
+                                sf::Vector2i goalCell,
+                                std::vector<sf::Vector2i>& path,
+                                SearchWorkspace& workspace,
+                                SearchStats* stats = nullptr);
+
+    // JPS+ reads the jump distances from a table built for the same grid
+    // instead of scanning for them, so each jump costs O(1).
+    static bool jumpPointSearchPlus(const Grid& grid,
+                                    const JumpPointTable& table,
+                                    sf::Vector2i startCell,
+                                    sf::Vector2i goalCell,
+                                    std::vector<sf::Vector2i>& path,
+                                    SearchWorkspace& workspace,
+                                    SearchStats* stats = nullptr);
+
+    // ALT: A* whose heuristic is the larger of Manhattan distance and the
+    // landmark bounds of a table built for the same grid. Honours terrain
+    // costs and finds the same path costs as Dijkstra.
+    static bool landmarkSearch(const Grid& grid,
+                               const LandmarkTable& table,
+                               sf::Vector2i startCell,
+                               sf::Vector2i goalCell,
+                               std::vector<sf::Vector2i>& path,
+                               SearchWorkspace& workspace,
+                               SearchStats* stats = nullptr);
+
+    // ARA*: weighted A* that finds a path quickly with an inflated
+    // Manhattan heuristic, then keeps lowering the weight and repairing the
+    // same search tree until it proves the path optimal, it has found
+    // pathLimit paths (if positive) or the deadline passes. The deadline
+    // holds for the first round too: if it passes before any path is
+    // found, no path is returned and stats report the timeout. Otherwise
+    // returns the best path found; stats report how many were found and the
+    // factor its cost may exceed the optimal one by. Honours terrain costs.
+    static bool anytimeSearch(const Grid& grid,
+                              sf::Vector2i startCell,
+                              sf::Vector2i goalCell,
+                              std::vector<sf::Vector2i>& path,
+                              SearchWorkspace& workspace,
+                              std::chrono::steady_clock::time_point deadline,
+                              SearchStats* stats = nullptr,
+                              int pathLimit = 0);
+
+    // Contraction hierarchy query: a Dijkstra from each end that only
+    // climbs to higher cells, then shortcut unpacking back to unit steps.
+    // The hierarchy must be built or loaded for the same map. Honours
+    // terrain costs and finds the same path costs as Dijkstra.
+    static bool contractionHierarchySearch(const Grid& grid,
+                                           const ContractionHierarchy& hierarchy,
+                                           sf::Vector2i startCell,
+                                           sf::Vector2i goalCell,
+                                           std::vector<sf::Vector2i>& path,
+                                           SearchWorkspace& workspace,
+                                           SearchStats* stats = nullptr);
+
+    // HPA*: connects start and goal to the entrances of their clusters,
+    // runs A* over the abstract graph, then refines each abstract edge with
+    // a search confined to one cluster. Honours terrain costs; paths are
+    // near-optimal, not optimal, since they must pass through entrances.
+    static bool hierarchicalSearch(const Grid& grid,
+                                   const HierarchicalGraph& graph,
+                                   sf::Vector2i startCell,
+                                   sf::Vector2i goalCell,
+                                   std::vector<sf::Vector2i>& path,
+                                   SearchWorkspace& workspace,
+                                   SearchStats* stats = nullptr);
+
+    // Level-synchronous BFS from both ends, always growing the smaller
+    // frontier. The level in which the searches first touch is finished
+    // before stopping so that the shortest meeting point is kept.
+    static bool bidirectionalBreadthFirstSearch(const Grid& grid,
+                                                sf::Vector2i startCell,
+                                                sf::Vector2i goalCell,
+                                                std::vector<sf::Vector2i>& path,
+                                                SearchWorkspace& workspace,
+                                                SearchStats* stats = nullptr);
+
+    // Dijkstra from both ends, stopping once the two smallest open keys add
+    // up to at least the best start-to-goal cost seen so far.
+    static bool bidirectionalDijkstra(const Grid& grid,
+                                      sf::Vector2i startCell,
+                                      sf::Vector2i goalCell,
+                                      std::vector<sf::Vector2i>& path,
+                                      SearchWorkspace& workspace,
+                                      SearchStats* stats = nullptr);
+
+    // BFS that advances the whole frontier one level at a time with word-wide
+    // shift/and/andnot operations on a WallBitmap built from the grid. Each
+    // level's frontier is kept sparsely so the path can be walked back from
+    // the goal afterwards.
+    static bool bitParallelBreadthFirstSearch(const WallBitmap& bitmap,
+                                              sf::Vector2i startCell,
+                                              sf::Vector2i goalCell,
+                                              std::vector<sf::Vector2i>& path,
+                                              SearchWorkspace& workspace,
+                                              SearchStats* stats = nullptr);
+
+    // Same wavefront without recording levels; returns the number of steps
+    // from start to goal, or -1 if the goal cannot be reached.
+    static int bitParallelDistance(const WallBitmap& bitmap,
+                                   sf::Vector2i startCell,
+                                   sf::Vector2i goalCell,
+                                   SearchWorkspace& workspace,
+                                   SearchStats* stats = nullptr);
 
 private:
-    static bool isValidCell(int x, int y);
+    static void reconstructPath(const Grid& grid,
+                                const SearchWorkspace& workspace,
+                                sf::Vector2i startCell,
+                                sf::Vector2i goalCell,
+                                std::vector<sf::Vector2i>& path);
+
+    static void reconstructBidirectionalPath(const Grid& grid,
+                                             const SearchWorkspace& workspace,
+                                             int meeting,
+                                             std::vector<sf::Vector2i>& path);
+
+    static bool jumpSearch(const Grid& grid,
+                           const JumpPointTable* table,
+                           sf::Vector2i startCell,
+                           sf::Vector2i goalCell,
+                           std::vector<sf::Vector2i>& path,
+                           SearchWorkspace& workspace,
+                           SearchStats* stats);
+    static int wavefrontSearch(const WallBitmap& bitmap,
+                               sf::Vector2i startCell,
+                               sf::Vector2i goalCell,
+                               SearchWorkspace& workspace,
+                               bool recordLevels,
+                               SearchStats* stats);
+
+    static int jumpHorizontal(const Grid& grid, int x, int y, int dx, sf::Vector2i goalCell);
+    static int jumpVertical(const Grid& grid, int x, int y, int dy, sf::Vector2i goalCell);
+    static int jumpFromTable(const Grid& grid, const JumpPointTable& table,
+                             int x, int y, int dx, int dy, sf::Vector2i goalCell);
 };
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include "AllocationCounter.h"
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// The size header is as large as the strictest fundamental alignment, or
+// the alignment asked for if stricter, so the memory handed out stays
+// suitably aligned
+static const std::size_t HEADER_SIZE = alignof(std::max_align_t);
+
+static std::size_t headerSize(std::size_t alignment) {
+    return alignment > HEADER_SIZE ? alignment : HEADER_SIZE;
+}
+
+// Marks the counters live once this file is linked in
+struct AllocationCounterActivation {
+    AllocationCounterActivation() { AllocationCounter::active.store(true, std::memory_order_relaxed); }
+};
+static AllocationCounterActivation activation;
+
+void* AllocationCounter::allocate(std::size_t size, std::size_t alignment) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(static_cast<long long>(size), std::memory_order_relaxed);
+    std::size_t header = headerSize(alignment);
+    char* block;
+    if (alignment <= HEADER_SIZE) {
+        block = static_cast<char*>(std::malloc(header + size));
+    } else {
+        // aligned_alloc wants a whole number of alignments
+        std::size_t rounded = (header + size + alignment - 1) / alignment * alignment;
+        block = static_cast<char*>(std::aligned_alloc(alignment, rounded));
+    }
+    if (!block) {
+        return nullptr;
+    }
+    *reinterpret_cast<std::size_t*>(block) = size;
+
+    long long live = currentBytes.fetch_add(static_cast<long long>(size), std::memory_order_relaxed) +
+                     static_cast<long long>(size);
+    long long peak = highWaterBytes.load(std::memory_order_relaxed);
+    while (live > peak && !highWaterBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+    return block + header;
+}
+
+void AllocationCounter::release(void* memory, std::size_t alignment) {
+    if (!memory) {
+        return;
+    }
+    char* block = static_cast<char*>(memory) - headerSize(alignment);
+    currentBytes.fetch_sub(static_cast<long long>(*reinterpret_cast<std::size_t*>(block)), std::memory_order_relaxed);
+    std::free(block);
+}
+
+void* operator new(std::size_t size) {
+    if (void* memory = AllocationCounter::allocate(size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return AllocationCounter::allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return AllocationCounter::allocate(size);
+}
+
+void operator delete(void* memory) noexcept {
+    AllocationCounter::release(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    AllocationCounter::release(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    AllocationCounter::release(memory);
+}
+
+void operator delete[](void* memory, std::size_t) noexcept {
+    AllocationCounter::release(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept {
+    AllocationCounter::release(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept {
+    AllocationCounter::release(memory);
+}
+
+// Over-aligned types, such as BatchPlanner's cache-line-aligned workers,
+// come through these
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (void* memory = AllocationCounter::allocate(size, static_cast<std::size_t>(alignment))) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return AllocationCounter::allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return AllocationCounter::allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* memory, std::align_val_t alignment) noexcept {
+    AllocationCounter::release(memory, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void* memory, std::align_val_t alignment) noexcept {
+    AllocationCounter::release(memory, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t alignment) noexcept {
+    AllocationCounter::release(memory, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void* memory, std::size_t, std::align_val_t alignment) noexcept {
+    AllocationCounter::release(memory, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* memory, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    AllocationCounter::release(memory, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void* memory, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    AllocationCounter::release(memory, static_cast<std::size_t>(alignment));
+}
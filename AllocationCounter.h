@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// Counts calls to the global operator new made anywhere in the process.
+// Linking AllocationCounter.cpp replaces the global allocation functions;
+// only the benchmark and verification executables do, so the planners and
+// the visualizer keep the standard allocator and every counter reads 0.
+// Reading a counter is a relaxed atomic load either way.
+//
+// Each block carries its size in a small header, so the bytes still
+// allocated, and their high-water mark since the last resetPeak(), are
+// known as well.
+class AllocationCounter {
+public:
+    // True if the counting allocator is linked into this executable
+    static bool isActive() { return active.load(std::memory_order_relaxed); }
+
+    static long long allocations() { return allocationCount.load(std::memory_order_relaxed); }
+    static long long bytes() { return allocatedBytes.load(std::memory_order_relaxed); }
+    static long long liveBytes() { return currentBytes.load(std::memory_order_relaxed); }
+    static long long peakBytes() { return highWaterBytes.load(std::memory_order_relaxed); }
+    static void resetPeak() {
+        highWaterBytes.store(currentBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    // The replacement allocation functions; defined in AllocationCounter.cpp.
+    // release must be given the alignment the block was allocated with.
+    static void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t));
+    static void release(void* memory, std::size_t alignment = alignof(std::max_align_t));
+
+private:
+    static inline std::atomic<bool> active{false};
+    static inline std::atomic<long long> allocationCount{0};
+    static inline std::atomic<long long> allocatedBytes{0};
+    static inline std::atomic<long long> currentBytes{0};
+    static inline std::atomic<long long> highWaterBytes{0};
+
+    friend struct AllocationCounterActivation;
+};
@@ -0,0 +1,225 @@
+#include "BatchPlanner.h"
+#include <algorithm>
+#include <chrono>
+#include "Algorithms.h"
+#include "Trace.h"
+
+// Queries claimed per trip to the shared counter: enough to keep the
+// counter off the hot path, few enough to balance uneven query costs
+static const std::size_t CHUNK_SIZE = 16;
+
+BatchPlanner::BatchPlanner(int threadCount)
+    : task(nullptr), taskCount(0), nextQuery(0), batch(0), busy(0), stopping(false) {
+    if (threadCount <= 0) {
+        threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    // Size the vector first: the threads hold references into it
+    workers.resize(threadCount);
+    for (Worker& worker : workers) {
+        worker.thread = std::thread(&BatchPlanner::workerLoop, this, std::ref(worker));
+    }
+}
+
+BatchPlanner::~BatchPlanner() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (Worker& worker : workers) {
+        worker.thread.join();
+    }
+}
+
+void BatchPlanner::findPaths(const Grid& grid,
+                             const Query* queries, std::size_t count,
+                             std::vector<std::vector<sf::Vector2i>>& paths,
+                             Constants::AlgorithmType algorithm,
+                             Constants::HeuristicType heuristic) {
+    prepare(grid, algorithm);
+    paths.resize(count);
+    run(count, [&](Worker& worker, std::size_t i) {
+        search(worker, grid, queries[i], paths[i], algorithm, heuristic);
+    });
+}
+
+void BatchPlanner::findLengths(const Grid& grid,
+                               const Query* queries, std::size_t count,
+                               std::vector<int>& lengths,
+                               Constants::AlgorithmType algorithm,
+                               Constants::HeuristicType heuristic) {
+    prepare(grid, algorithm);
+    lengths.resize(count);
+    for (Worker& worker : workers) {
+        worker.distanceOnly = 0;
+    }
+    run(count, [&](Worker& worker, std::size_t i) {
+        // The bit-parallel BFS can skip recording levels when only the length is wanted
+        if (algorithm == Constants::BIT_PARALLEL_BFS) {
+            lengths[i] = Algorithms::bitParallelDistance(wallBitmap, queries[i].start, queries[i].goal,
+                                                         worker.workspace);
+            ++worker.distanceOnly;
+            return;
+        }
+        bool found = search(worker, grid, queries[i], worker.path, algorithm, heuristic);
+        lengths[i] = found ? static_cast<int>(worker.path.size()) - 1 : -1;
+    });
+}
+
+std::size_t BatchPlanner::getDistanceOnlyQueries() const {
+    std::size_t total = 0;
+    for (const Worker& worker : workers) {
+        total += worker.distanceOnly;
+    }
+    return total;
+}
+
+void BatchPlanner::prepare(const Grid& grid, Constants::AlgorithmType algorithm) {
+    // Preprocessing is only redone if the map has changed since it was built
+    if (algorithm == Constants::JPS_PLUS && !jumpTable.isCurrent(grid)) {
+        jumpTable.build(grid);
+    }
+    if (algorithm == Constants::ALT && !landmarks.isCurrent(grid)) {
+        landmarks.build(grid, Constants::ALT_LANDMARKS);
+    }
+    if (algorithm == Constants::BIT_PARALLEL_BFS && !wallBitmap.isCurrent(grid)) {
+        wallBitmap.build(grid);
+    }
+    if (algorithm == Constants::HPA_STAR && !hierarchy.isCurrent(grid)) {
+        hierarchy.build(grid);
+    }
+    if (algorithm == Constants::CONTRACTION_HIERARCHY && !contraction.isCurrent(grid)) {
+        contraction.build(grid);
+    }
+    if (!components.isCurrent(grid)) {
+        components.build(grid);
+    }
+}
+
+bool BatchPlanner::search(Worker& worker, const Grid& grid, const Query& query,
+                          std::vector<sf::Vector2i>& path,
+                          Constants::AlgorithmType algorithm, Constants::HeuristicType heuristic) {
+    // A goal in another component is unreachable whatever the algorithm
+    if (grid.isValidCell(query.start.x, query.start.y) && grid.isValidCell(query.goal.x, query.goal.y) &&
+        !components.connected(grid.index(query.start.x, query.start.y), grid.index(query.goal.x, query.goal.y))) {
+        path.clear();
+        return false;
+    }
+
+    SearchWorkspace& workspace = worker.workspace;
+    switch (algorithm) {
+        case Constants::DFS:
+            return Algorithms::depthFirstSearch(grid, query.start, query.goal, path, workspace);
+        case Constants::BFS:
+            return Algorithms::breadthFirstSearch(grid, query.start, query.goal, path, workspace);
+        case Constants::DIJKSTRA:
+            return Algorithms::dijkstraAlgorithm(grid, query.start, query.goal, path, workspace);
+        case Constants::ASTAR:
+            return Algorithms::aStarSearch(grid, query.start, query.goal, path, workspace, heuristic);
+        case Constants::ALT:
+            return Algorithms::landmarkSearch(grid, landmarks, query.start, query.goal, path, workspace);
+        case Constants::ARA_STAR:
+            // The deadline is per query, as for the visualizer's searches; a
+            // query that finds no path before it is answered as unreachable
+            return Algorithms::anytimeSearch(grid, query.start, query.goal, path, workspace,
+                                             std::chrono::steady_clock::now() +
+                                                 std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                     std::chrono::duration<float, std::milli>(Constants::ARA_DEADLINE_MS)));
+        case Constants::JPS:
+            return Algorithms::jumpPointSearch(grid, query.start, query.goal, path, workspace);
+        case Constants::JPS_PLUS:
+            return Algorithms::jumpPointSearchPlus(grid, jumpTable, query.start, query.goal, path, workspace);
+        case Constants::BIDIRECTIONAL_BFS:
+            return Algorithms::bidirectionalBreadthFirstSearch(grid, query.start, query.goal, path, workspace);
+        case Constants::BIDIRECTIONAL_DIJKSTRA:
+            return Algorithms::bidirectionalDijkstra(grid, query.start, query.goal, path, workspace);
+        case Constants::BIT_PARALLEL_BFS:
+            return Algorithms::bitParallelBreadthFirstSearch(wallBitmap, query.start, query.goal, path, workspace);
+        case Constants::DIRECTION_OPTIMIZING_BFS:
+            return Algorithms::directionOptimizingBreadthFirstSearch(grid, query.start, query.goal, path, workspace);
+        case Constants::HPA_STAR:
+            return Algorithms::hierarchicalSearch(grid, hierarchy, query.start, query.goal, path, workspace);
+        case Constants::CONTRACTION_HIERARCHY:
+            return Algorithms::contractionHierarchySearch(grid, contraction, query.start, query.goal, path, workspace);
+        case Constants::D_STAR_LITE:
+            // Nothing to repair between unrelated queries, so each one plans from scratch
+            worker.planner.initialize(grid, query.start, query.goal);
+            return worker.planner.replan(grid, path);
+        case Constants::FLOW_FIELD:
+            // Agents sharing a goal share the worker's field; it is only
+            // rebuilt when the goal or the map changes
+            if (!worker.field.isCurrent(grid, query.goal)) {
+                worker.field.build(grid, query.goal);
+            }
+            return worker.field.followPath(grid, query.start, path);
+        case Constants::COOPERATIVE_ASTAR:
+        case Constants::CONFLICT_BASED_SEARCH: {
+            // Each query is a team of one; with nobody to avoid both reduce
+            // to a unit-cost shortest path
+            worker.team.assign(1, {query.start, query.goal});
+            bool found = algorithm == Constants::COOPERATIVE_ASTAR
+                             ? worker.agents.planCooperative(grid, worker.team, worker.teamPaths)
+                             : worker.agents.planConflictBased(grid, worker.team, worker.teamPaths);
+            path.swap(worker.teamPaths[0]);
+            if (!found) {
+                path.clear();
+            }
+            return found;
+        }
+    }
+    path.clear();
+    return false;
+}
+
+void BatchPlanner::run(std::size_t count, const Task& work) {
+    if (count == 0) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    task = &work;
+    taskCount = count;
+    nextQuery.store(0, std::memory_order_relaxed);
+    busy = static_cast<int>(workers.size());
+    ++batch;
+    wake.notify_all();
+    finished.wait(lock, [this] { return busy == 0; });
+    task = nullptr;
+}
+
+void BatchPlanner::workerLoop(Worker& worker) {
+    Trace::setThreadName("batch worker");
+    unsigned seen = 0;
+    for (;;) {
+        const Task* work;
+        std::size_t count;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || batch != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = batch;
+            work = task;
+            count = taskCount;
+        }
+
+        for (;;) {
+            std::size_t first = nextQuery.fetch_add(CHUNK_SIZE, std::memory_order_relaxed);
+            if (first >= count) {
+                break;
+            }
+            std::size_t last = std::min(first + CHUNK_SIZE, count);
+            for (std::size_t i = first; i < last; ++i) {
+                TRACE_SCOPE("query");
+                (*work)(worker, i);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busy == 0) {
+            finished.notify_one();
+        }
+    }
+}
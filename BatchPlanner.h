@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <SFML/System/Vector2.hpp>
+#include "ComponentIndex.h"
+#include "ContractionHierarchy.h"
+#include "Constants.h"
+#include "DStarLite.h"
+#include "FlowField.h"
+#include "Grid.h"
+#include "HierarchicalGraph.h"
+#include "JumpPointTable.h"
+#include "LandmarkTable.h"
+#include "MultiAgentPlanner.h"
+#include "SearchWorkspace.h"
+#include "WallBitmap.h"
+
+// Answers many start/goal queries against one map on a pool of worker
+// threads.
+//
+// The workers are started once and sleep between batches. Each owns a
+// SearchWorkspace, so after the first batch they search without touching
+// the heap; the grid and any preprocessing (the JPS+ table, the landmark
+// distances, the wall bitmap, the HPA* graph, the contraction hierarchy, the
+// component labels) are only read. The preprocessing is built on the
+// calling thread, and only rebuilt when the grid's revision has changed
+// since. Queries whose endpoints lie in different components are answered
+// without searching. Queries are handed out in small chunks from a shared
+// counter so a few long searches do not leave the other threads idle.
+//
+// One batch runs at a time; findPaths and findLengths must not be called
+// concurrently on the same planner.
+class BatchPlanner {
+public:
+    struct Query {
+        sf::Vector2i start;
+        sf::Vector2i goal;
+    };
+
+    // threadCount 0 uses one thread per hardware thread
+    explicit BatchPlanner(int threadCount = 0);
+    ~BatchPlanner();
+
+    BatchPlanner(const BatchPlanner&) = delete;
+    BatchPlanner& operator=(const BatchPlanner&) = delete;
+
+    int getThreadCount() const { return static_cast<int>(workers.size()); }
+
+    // paths[i] receives the path for queries[i], empty if there is none.
+    // Existing inner vectors are reused, so a caller that keeps `paths`
+    // between batches avoids reallocating them.
+    void findPaths(const Grid& grid,
+                   const Query* queries, std::size_t count,
+                   std::vector<std::vector<sf::Vector2i>>& paths,
+                   Constants::AlgorithmType algorithm = Constants::ASTAR,
+                   Constants::HeuristicType heuristic = Constants::MANHATTAN);
+
+    // lengths[i] receives the number of steps of the path found for
+    // queries[i], or -1 if the goal is unreachable
+    void findLengths(const Grid& grid,
+                     const Query* queries, std::size_t count,
+                     std::vector<int>& lengths,
+                     Constants::AlgorithmType algorithm = Constants::ASTAR,
+                     Constants::HeuristicType heuristic = Constants::MANHATTAN);
+
+    // Queries of the last findLengths batch answered by a distance-only
+    // search, which records no path
+    std::size_t getDistanceOnlyQueries() const;
+
+private:
+    // Per-worker state, padded so neighbouring workers' hot fields do not
+    // share a cache line
+    struct alignas(64) Worker {
+        std::thread thread;
+        SearchWorkspace workspace;
+        std::vector<sf::Vector2i> path;
+        DStarLite planner;
+        FlowField field;
+        MultiAgentPlanner agents;
+        std::vector<MultiAgentPlanner::Agent> team;
+        std::vector<std::vector<sf::Vector2i>> teamPaths;
+        std::size_t distanceOnly = 0;
+    };
+
+    typedef std::function<void(Worker&, std::size_t)> Task;
+
+    void prepare(const Grid& grid, Constants::AlgorithmType algorithm);
+    bool search(Worker& worker, const Grid& grid, const Query& query,
+                std::vector<sf::Vector2i>& path,
+                Constants::AlgorithmType algorithm, Constants::HeuristicType heuristic);
+    void run(std::size_t count, const Task& task);
+    void workerLoop(Worker& worker);
+
+    std::vector<Worker> workers;
+    JumpPointTable jumpTable;
+    LandmarkTable landmarks;
+    ContractionHierarchy contraction;
+    WallBitmap wallBitmap;
+    HierarchicalGraph hierarchy;
+    ComponentIndex components;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    const Task* task;
+    std::size_t taskCount;
+    std::atomic<std::size_t> nextQuery;
+    unsigned batch;
+    int busy;
+    bool stopping;
+};
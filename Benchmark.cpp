@@ -0,0 +1,932 @@
+#include "Benchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+#include "AllocationCounter.h"
+#include "Algorithms.h"
+#include "ComponentIndex.h"
+#include "DStarLite.h"
+#include "FlowField.h"
+#include "MapGenerator.h"
+#include "MapLoader.h"
+#include "Verification.h"
+
+// The 4-connected DFS, BFS, Dijkstra and A* as they were written before the
+// search kernel, kept as the baseline it has to match. They work on Grid
+// directly, bounds-checking every neighbour.
+namespace {
+    const sf::Vector2i DIRECTIONS[] = {
+        {0, -1}, {1, 0}, {0, 1}, {-1, 0}
+    };
+
+    void reconstructPath(const Grid& grid, const SearchWorkspace& workspace,
+                         sf::Vector2i startCell, sf::Vector2i goalCell,
+                         std::vector<sf::Vector2i>& path) {
+        int start = grid.index(startCell.x, startCell.y);
+        int pos = grid.index(goalCell.x, goalCell.y);
+        while (pos != start) {
+            path.push_back({grid.indexX(pos), grid.indexY(pos)});
+            pos = workspace.parent(pos);
+        }
+        path.push_back(startCell);
+        std::reverse(path.begin(), path.end());
+    }
+
+    bool handWrittenDepthFirst(const Grid& grid, sf::Vector2i startCell, sf::Vector2i goalCell,
+                               std::vector<sf::Vector2i>& path, SearchWorkspace& workspace) {
+        path.clear();
+        workspace.begin(grid);
+        std::vector<int>& stack = workspace.stack;
+
+        int goal = grid.index(goalCell.x, goalCell.y);
+        stack.push_back(grid.index(startCell.x, startCell.y));
+        workspace.label(grid.index(startCell.x, startCell.y), 0, -1);
+
+        while (!stack.empty()) {
+            int current = stack.back();
+            stack.pop_back();
+
+            if (current == goal) {
+                reconstructPath(grid, workspace, startCell, goalCell, path);
+                return true;
+            }
+
+            int x = grid.indexX(current);
+            int y = grid.indexY(current);
+            for (auto& dir : DIRECTIONS) {
+                int newX = x + dir.x;
+                int newY = y + dir.y;
+
+                if (grid.isValidCell(newX, newY) && !workspace.isLabelled(grid.index(newX, newY)) && !grid.isWall(newX, newY)) {
+                    stack.push_back(grid.index(newX, newY));
+                    workspace.label(grid.index(newX, newY), 0, current);
+                }
+            }
+        }
+        return false;
+    }
+
+    bool handWrittenBreadthFirst(const Grid& grid, sf::Vector2i startCell, sf::Vector2i goalCell,
+                                 std::vector<sf::Vector2i>& path, SearchWorkspace& workspace) {
+        path.clear();
+        workspace.begin(grid);
+        std::vector<int>& queue = workspace.queue;
+        size_t head = 0;
+
+        int goal = grid.index(goalCell.x, goalCell.y);
+        queue.push_back(grid.index(startCell.x, startCell.y));
+        workspace.label(grid.index(startCell.x, startCell.y), 0, -1);
+
+        while (head < queue.size()) {
+            int current = queue[head++];
+
+            if (current == goal) {
+                reconstructPath(grid, workspace, startCell, goalCell, path);
+                return true;
+            }
+
+            int x = grid.indexX(current);
+            int y = grid.indexY(current);
+            for (auto& dir : DIRECTIONS) {
+                int newX = x + dir.x;
+                int newY = y + dir.y;
+
+                if (grid.isValidCell(newX, newY) && !workspace.isLabelled(grid.index(newX, newY)) && !grid.isWall(newX, newY)) {
+                    queue.push_back(grid.index(newX, newY));
+                    workspace.label(grid.index(newX, newY), workspace.distance(current) + 1, current);
+                }
+            }
+        }
+        return false;
+    }
+
+    bool handWrittenDijkstra(const Grid& grid, sf::Vector2i startCell, sf::Vector2i goalCell,
+                             std::vector<sf::Vector2i>& path, SearchWorkspace& workspace) {
+        path.clear();
+        workspace.begin(grid);
+        BucketQueue& queue = workspace.buckets;
+
+        int goal = grid.index(goalCell.x, goalCell.y);
+        queue.push(grid.index(startCell.x, startCell.y), 0);
+        workspace.label(grid.index(startCell.x, startCell.y), 0, -1);
+
+        while (!queue.empty()) {
+            int cost;
+            int current = queue.pop(cost);
+
+            if (current == goal) {
+                reconstructPath(grid, workspace, startCell, goalCell, path);
+                return true;
+            }
+            if (cost > workspace.distance(current)) {
+                continue;
+            }
+
+            int x = grid.indexX(current);
+            int y = grid.indexY(current);
+            for (auto& dir : DIRECTIONS) {
+                int newX = x + dir.x;
+                int newY = y + dir.y;
+
+                if (grid.isValidCell(newX, newY) && !grid.isWall(newX, newY)) {
+                    int newCost = cost + grid.cost(newX, newY);
+
+                    if (newCost < workspace.distance(grid.index(newX, newY))) {
+                        workspace.label(grid.index(newX, newY), newCost, current);
+                        queue.push(grid.index(newX, newY), newCost);
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    // Manhattan written out, rather than the runtime switch on the heuristic
+    // the old A* went through, so if anything the baseline is flattered
+    int handWrittenHeuristic(int dx, int dy) {
+        return std::abs(dx) + std::abs(dy);
+    }
+
+    bool handWrittenAStar(const Grid& grid, sf::Vector2i startCell, sf::Vector2i goalCell,
+                          std::vector<sf::Vector2i>& path, SearchWorkspace& workspace) {
+        path.clear();
+        workspace.begin(grid);
+
+        int start = grid.index(startCell.x, startCell.y);
+        int goal = grid.index(goalCell.x, goalCell.y);
+        workspace.pushHeap({start, 0, handWrittenHeuristic(goalCell.x - startCell.x, goalCell.y - startCell.y)});
+        workspace.label(start, 0, -1);
+
+        while (!workspace.heapEmpty()) {
+            SearchWorkspace::HeapNode current = workspace.popHeap();
+
+            if (current.index == goal) {
+                reconstructPath(grid, workspace, startCell, goalCell, path);
+                return true;
+            }
+            if (current.cost > workspace.distance(current.index)) {
+                continue;
+            }
+
+            int x = grid.indexX(current.index);
+            int y = grid.indexY(current.index);
+            for (auto& dir : DIRECTIONS) {
+                int newX = x + dir.x;
+                int newY = y + dir.y;
+
+                if (grid.isValidCell(newX, newY) && !grid.isWall(newX, newY)) {
+                    int next = grid.index(newX, newY);
+                    int newCost = current.cost + grid.cost(newX, newY);
+
+                    if (newCost < workspace.distance(next)) {
+                        workspace.label(next, newCost, current.index);
+                        workspace.pushHeap({next, newCost, newCost + handWrittenHeuristic(goalCell.x - newX, goalCell.y - newY)});
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    struct Query {
+        sf::Vector2i start;
+        sf::Vector2i goal;
+    };
+
+    // Seconds for one pass over every query
+    template <typename Search>
+    double timeQueries(const std::vector<Query>& queries, const Search& search) {
+        auto startTime = std::chrono::steady_clock::now();
+        for (const Query& query : queries) {
+            search(query);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+        return elapsed.count();
+    }
+}
+
+bool Benchmark::compareSearchKernel(int rows, int cols, int queryCount,
+                                    unsigned seed, std::ostream& out) {
+    // Interleaved rounds, keeping each side's fastest, so a burst of noise
+    // on the machine does not land on one side only
+    const int rounds = 7;
+
+    std::mt19937 rng(seed);
+    Grid grid = MapGenerator::randomObstacles(rows, cols, 0.25, rng());
+    MapGenerator::randomTerrain(grid, 9, rng());
+
+    std::vector<Query> queries;
+    for (int i = 0; i < queryCount; ++i) {
+        queries.push_back({MapGenerator::randomFreeCell(grid, rng), MapGenerator::randomFreeCell(grid, rng)});
+    }
+
+    typedef bool (*HandWritten)(const Grid&, sf::Vector2i, sf::Vector2i,
+                                std::vector<sf::Vector2i>&, SearchWorkspace&);
+    const Constants::AlgorithmType algorithms[] = {
+        Constants::DFS, Constants::BFS, Constants::DIJKSTRA, Constants::ASTAR
+    };
+    const HandWritten handWritten[] = {
+        handWrittenDepthFirst, handWrittenBreadthFirst, handWrittenDijkstra, handWrittenAStar
+    };
+
+    bool passed = true;
+    SearchWorkspace workspace;
+    std::vector<sf::Vector2i> path;
+    std::vector<sf::Vector2i> kernelPath;
+    for (int a = 0; a < 4; ++a) {
+        Constants::AlgorithmType algorithm = algorithms[a];
+        auto kernel = [&](const Query& query) {
+            switch (algorithm) {
+                case Constants::DFS:
+                    return Algorithms::depthFirstSearch(grid, query.start, query.goal, kernelPath, workspace);
+                case Constants::BFS:
+                    return Algorithms::breadthFirstSearch(grid, query.start, query.goal, kernelPath, workspace);
+                case Constants::DIJKSTRA:
+                    return Algorithms::dijkstraAlgorithm(grid, query.start, query.goal, kernelPath, workspace);
+                default:
+                    return Algorithms::aStarSearch(grid, query.start, query.goal, kernelPath, workspace,
+                                                   Constants::MANHATTAN);
+            }
+        };
+        auto baseline = [&](const Query& query) {
+            return handWritten[a](grid, query.start, query.goal, path, workspace);
+        };
+
+        // Check the answers first, which also warms the workspace and caches
+        int mismatches = 0;
+        for (const Query& query : queries) {
+            bool expected = baseline(query);
+            bool found = kernel(query);
+            if (found != expected) {
+                ++mismatches;
+            } else if (found && algorithm == Constants::BFS && path.size() != kernelPath.size()) {
+                ++mismatches;
+            } else if (found && algorithm != Constants::DFS && algorithm != Constants::BFS &&
+                       Verification::pathCost(grid, path) != Verification::pathCost(grid, kernelPath)) {
+                ++mismatches;
+            }
+        }
+
+        double baselineTime = 1e30;
+        double kernelTime = 1e30;
+        for (int round = 0; round < rounds; ++round) {
+            baselineTime = std::min(baselineTime, timeQueries(queries, baseline));
+            kernelTime = std::min(kernelTime, timeQueries(queries, kernel));
+        }
+
+        double toNanoseconds = 1e9 / queries.size();
+        out << Algorithms::algorithmName(algorithm) << ": hand-written " << static_cast<long long>(baselineTime * toNanoseconds)
+            << " ns/query, kernel " << static_cast<long long>(kernelTime * toNanoseconds) << " ns/query ("
+            << kernelTime / baselineTime << "x) on " << rows << "x" << cols;
+        if (mismatches > 0) {
+            out << ", " << mismatches << " mismatches";
+        }
+        out << "\n";
+        passed &= mismatches == 0;
+    }
+    return passed;
+}
+
+bool Benchmark::compareLandmarks(int rows, int cols, int queryCount,
+                                 unsigned seed, std::ostream& out) {
+    const int landmarkCounts[] = {4, 8, 16};
+    const Constants::LandmarkSelection selections[] = {
+        Constants::FARTHEST_LANDMARKS, Constants::AVOID_LANDMARKS
+    };
+
+    std::mt19937 rng(seed);
+    Grid maps[2] = {MapGenerator::randomObstacles(rows, cols, 0.25, rng()), MapGenerator::maze(rows, cols, rng())};
+    const char* mapNames[2] = {"random walls", "maze"};
+    MapGenerator::randomTerrain(maps[0], 9, rng());
+
+    bool passed = true;
+    SearchWorkspace workspace;
+    SearchStats stats;
+    std::vector<sf::Vector2i> path;
+    LandmarkTable table;
+    for (int m = 0; m < 2; ++m) {
+        const Grid& grid = maps[m];
+        std::vector<Query> queries;
+        for (int i = 0; i < queryCount; ++i) {
+            queries.push_back({MapGenerator::randomFreeCell(grid, rng), MapGenerator::randomFreeCell(grid, rng)});
+        }
+
+        // The reference costs and expansions, -1 where there is no path
+        std::vector<long long> costs;
+        long long baselineExpanded = 0;
+        for (const Query& query : queries) {
+            bool found = Algorithms::aStarSearch(grid, query.start, query.goal, path, workspace,
+                                                 Constants::MANHATTAN, &stats);
+            costs.push_back(found ? Verification::pathCost(grid, path) : -1);
+            baselineExpanded += stats.nodesExpanded;
+        }
+        double baselineTime = timeQueries(queries, [&](const Query& query) {
+            return Algorithms::aStarSearch(grid, query.start, query.goal, path, workspace);
+        });
+
+        double toNanoseconds = 1e9 / queries.size();
+        out << "A* Manhattan on " << rows << "x" << cols << " " << mapNames[m] << ": "
+            << baselineExpanded / static_cast<long long>(queries.size()) << " nodes expanded/query, "
+            << static_cast<long long>(baselineTime * toNanoseconds) << " ns/query\n";
+
+        for (Constants::LandmarkSelection selection : selections) {
+            for (int count : landmarkCounts) {
+                auto buildStart = std::chrono::steady_clock::now();
+                table.build(grid, count, selection);
+                std::chrono::duration<double> buildTime = std::chrono::steady_clock::now() - buildStart;
+
+                long long expanded = 0;
+                int mismatches = 0;
+                for (std::size_t i = 0; i < queries.size(); ++i) {
+                    bool found = Algorithms::landmarkSearch(grid, table, queries[i].start, queries[i].goal,
+                                                            path, workspace, &stats);
+                    expanded += stats.nodesExpanded;
+                    mismatches += (found ? Verification::pathCost(grid, path) : -1) != costs[i];
+                }
+                double time = timeQueries(queries, [&](const Query& query) {
+                    return Algorithms::landmarkSearch(grid, table, query.start, query.goal, path, workspace);
+                });
+
+                out << "  ALT, " << count << (selection == Constants::AVOID_LANDMARKS ? " avoid" : " farthest")
+                    << " landmarks: " << expanded / static_cast<long long>(queries.size()) << " nodes expanded/query ("
+                    << 100.0 * expanded / std::max(baselineExpanded, 1LL) << "% of A*), "
+                    << static_cast<long long>(time * toNanoseconds) << " ns/query, built in "
+                    << buildTime.count() * 1000.0 << " ms, " << table.getTableBytes() / 1024 << " KiB";
+                if (mismatches > 0) {
+                    out << ", " << mismatches << " mismatches";
+                }
+                out << "\n";
+                passed &= mismatches == 0;
+            }
+        }
+    }
+    return passed;
+}
+
+bool Benchmark::compareContractionHierarchy(int rows, int cols, int queryCount,
+                                            unsigned seed, std::ostream& out) {
+    std::mt19937 rng(seed);
+    Grid grid = MapGenerator::randomObstacles(rows, cols, 0.25, rng());
+    MapGenerator::randomTerrain(grid, 9, rng());
+    std::vector<Query> queries;
+    for (int i = 0; i < queryCount; ++i) {
+        queries.push_back({MapGenerator::randomFreeCell(grid, rng), MapGenerator::randomFreeCell(grid, rng)});
+    }
+
+    int threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    ContractionHierarchy hierarchy;
+    auto buildStart = std::chrono::steady_clock::now();
+    hierarchy.build(grid, 1);
+    std::chrono::duration<double> singleTime = std::chrono::steady_clock::now() - buildStart;
+    buildStart = std::chrono::steady_clock::now();
+    hierarchy.build(grid, threads);
+    std::chrono::duration<double> parallelTime = std::chrono::steady_clock::now() - buildStart;
+
+    SearchWorkspace workspace;
+    SearchStats stats;
+    std::vector<sf::Vector2i> path;
+    std::vector<sf::Vector2i> expected;
+    long long dijkstraExpanded = 0;
+    long long hierarchyExpanded = 0;
+    int mismatches = 0;
+    for (const Query& query : queries) {
+        bool expectedFound = Algorithms::dijkstraAlgorithm(grid, query.start, query.goal, expected, workspace, &stats);
+        dijkstraExpanded += stats.nodesExpanded;
+        bool found = Algorithms::contractionHierarchySearch(grid, hierarchy, query.start, query.goal, path,
+                                                            workspace, &stats);
+        hierarchyExpanded += stats.nodesExpanded;
+        if (found != expectedFound ||
+            (found && Verification::pathCost(grid, path) != Verification::pathCost(grid, expected))) {
+            ++mismatches;
+        }
+    }
+
+    double dijkstraTime = timeQueries(queries, [&](const Query& query) {
+        return Algorithms::dijkstraAlgorithm(grid, query.start, query.goal, path, workspace);
+    });
+    double aStarTime = timeQueries(queries, [&](const Query& query) {
+        return Algorithms::aStarSearch(grid, query.start, query.goal, path, workspace);
+    });
+    double hierarchyTime = timeQueries(queries, [&](const Query& query) {
+        return Algorithms::contractionHierarchySearch(grid, hierarchy, query.start, query.goal, path, workspace);
+    });
+
+    double toNanoseconds = 1e9 / queries.size();
+    long long count = static_cast<long long>(queries.size());
+    out << "CH on " << rows << "x" << cols << ": built in " << singleTime.count() * 1000.0 << " ms on 1 thread, "
+        << parallelTime.count() * 1000.0 << " ms on " << threads << ", " << hierarchy.getShortcutCount()
+        << " shortcuts over " << hierarchy.getNodeCount() << " cells\n"
+        << "  Dijkstra: " << dijkstraExpanded / count << " nodes expanded/query, "
+        << static_cast<long long>(dijkstraTime * toNanoseconds) << " ns/query; A*: "
+        << static_cast<long long>(aStarTime * toNanoseconds) << " ns/query; CH: " << hierarchyExpanded / count
+        << " nodes expanded/query, " << static_cast<long long>(hierarchyTime * toNanoseconds) << " ns/query ("
+        << dijkstraTime / hierarchyTime << "x faster than Dijkstra)";
+    if (mismatches > 0) {
+        out << ", " << mismatches << " mismatches";
+    }
+    out << "\n";
+    return mismatches == 0;
+}
+
+namespace {
+    // One planner's preprocessing and search state
+    struct Planner {
+        JumpPointTable jumpTable;
+        LandmarkTable landmarks;
+        WallBitmap wallBitmap;
+        HierarchicalGraph hierarchy;
+        ContractionHierarchy contraction;
+        DStarLite incremental;
+        FlowField field;
+        SearchWorkspace workspace;
+    };
+
+    void prepare(Planner& planner, Constants::AlgorithmType algorithm, const Grid& grid) {
+        switch (algorithm) {
+            case Constants::ALT: planner.landmarks.build(grid, Constants::ALT_LANDMARKS); break;
+            case Constants::JPS_PLUS: planner.jumpTable.build(grid); break;
+            case Constants::BIT_PARALLEL_BFS: planner.wallBitmap.build(grid); break;
+            case Constants::HPA_STAR: planner.hierarchy.build(grid); break;
+            case Constants::CONTRACTION_HIERARCHY: planner.contraction.build(grid); break;
+            default: break;
+        }
+    }
+
+    // DFS, BFS, Dijkstra and A* move as `movement` says, the rest 4-way
+    bool plan(Planner& planner, Constants::AlgorithmType algorithm, const Grid& grid, const Query& query,
+              std::vector<sf::Vector2i>& path, SearchStats& stats, const Movement& movement = Movement()) {
+        SearchWorkspace& workspace = planner.workspace;
+        switch (algorithm) {
+            case Constants::DFS:
+                return Algorithms::depthFirstSearch(grid, query.start, query.goal, path, workspace, &stats, movement);
+            case Constants::BFS:
+                return Algorithms::breadthFirstSearch(grid, query.start, query.goal, path, workspace, &stats, movement);
+            case Constants::DIJKSTRA:
+                return Algorithms::dijkstraAlgorithm(grid, query.start, query.goal, path, workspace, &stats, movement);
+            case Constants::ASTAR:
+                return Algorithms::aStarSearch(grid, query.start, query.goal, path, workspace,
+                                               movement.connectivity == Constants::EIGHT_CONNECTED
+                                                   ? Constants::OCTILE : Constants::MANHATTAN,
+                                               &stats, movement);
+            case Constants::ALT:
+                return Algorithms::landmarkSearch(grid, planner.landmarks, query.start, query.goal, path, workspace,
+                                                  &stats);
+            case Constants::ARA_STAR:
+                // Under the visualizer's deadline, so its latency is capped
+                return Algorithms::anytimeSearch(grid, query.start, query.goal, path, workspace,
+                                                 std::chrono::steady_clock::now() +
+                                                     std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                         std::chrono::duration<float, std::milli>(
+                                                             Constants::ARA_DEADLINE_MS)),
+                                                 &stats);
+            case Constants::JPS:
+                return Algorithms::jumpPointSearch(grid, query.start, query.goal, path, workspace, &stats);
+            case Constants::JPS_PLUS:
+                return Algorithms::jumpPointSearchPlus(grid, planner.jumpTable, query.start, query.goal, path,
+                                                       workspace, &stats);
+            case Constants::BIDIRECTIONAL_BFS:
+                return Algorithms::bidirectionalBreadthFirstSearch(grid, query.start, query.goal, path, workspace,
+                                                                   &stats);
+            case Constants::BIDIRECTIONAL_DIJKSTRA:
+                return Algorithms::bidirectionalDijkstra(grid, query.start, query.goal, path, workspace, &stats);
+            case Constants::BIT_PARALLEL_BFS:
+                return Algorithms::bitParallelBreadthFirstSearch(planner.wallBitmap, query.start, query.goal, path,
+                                                                 workspace, &stats);
+            case Constants::DIRECTION_OPTIMIZING_BFS:
+                return Algorithms::directionOptimizingBreadthFirstSearch(grid, query.start, query.goal, path,
+                                                                         workspace, &stats);
+            case Constants::HPA_STAR:
+                return Algorithms::hierarchicalSearch(grid, planner.hierarchy, query.start, query.goal, path,
+                                                      workspace, &stats);
+            case Constants::CONTRACTION_HIERARCHY:
+                return Algorithms::contractionHierarchySearch(grid, planner.contraction, query.start, query.goal,
+                                                              path, workspace, &stats);
+            case Constants::D_STAR_LITE:
+                // Unrelated queries leave nothing to repair
+                planner.incremental.initialize(grid, query.start, query.goal);
+                return planner.incremental.replan(grid, path, &stats);
+            case Constants::FLOW_FIELD: {
+                // A field per goal, so every query pays for a full build
+                planner.field.build(grid, query.goal, &stats);
+                bool found = planner.field.followPath(grid, query.start, path);
+                stats.recordPath(&grid, path);
+                return found;
+            }
+            case Constants::COOPERATIVE_ASTAR:
+            case Constants::CONFLICT_BASED_SEARCH:
+                break;
+        }
+        return false;
+    }
+
+    struct SuiteResult {
+        const char* algorithm;
+        int found;
+        double nanosecondsPerQuery;
+        double nodesPerSecond;
+        long long p50;
+        long long p95;
+        long long p99;
+        double preprocessingMilliseconds;
+        long long peakHeapBytes;
+
+        // Per query means of the SearchStats counters, and the most entries
+        // any query had open
+        double generated;
+        double duplicates;
+        long long peakOpen;
+        double pathLength;
+        double pathCost;
+        double bytesAllocated;
+    };
+
+    // Sums of the SearchStats counters over a run of queries
+    struct StatsTotals {
+        long long generated = 0;
+        long long duplicates = 0;
+        long long peakOpen = 0;
+        long long pathLength = 0;
+        long long pathCost = 0;
+        long long bytesAllocated = 0;
+
+        void add(const SearchStats& stats) {
+            generated += stats.nodesGenerated;
+            duplicates += stats.duplicatePushes;
+            peakOpen = std::max(peakOpen, stats.peakOpen);
+            pathLength += stats.pathLength;
+            pathCost += stats.pathCost;
+            bytesAllocated += stats.bytesAllocated;
+        }
+    };
+
+    // Nearest-rank percentile of sorted samples
+    long long percentile(const std::vector<long long>& sorted, double fraction) {
+        std::size_t rank = static_cast<std::size_t>(std::ceil(fraction * sorted.size()));
+        return sorted[std::min(sorted.size(), std::max<std::size_t>(rank, 1)) - 1];
+    }
+
+    // Kibibytes, or -1 where the platform does not say
+    long peakResidentKibibytes() {
+#if defined(__unix__) || defined(__APPLE__)
+        rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#if defined(__APPLE__)
+            return usage.ru_maxrss / 1024; // bytes on macOS
+#else
+            return usage.ru_maxrss;
+#endif
+        }
+#endif
+        return -1;
+    }
+
+    std::string jsonString(const std::string& text) {
+        std::string quoted = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                quoted += '\\';
+            }
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+}
+
+std::vector<Constants::AlgorithmType> Benchmark::singleAgentAlgorithms() {
+    // In the visualizer's order
+    return {
+        Constants::DFS, Constants::BFS, Constants::DIJKSTRA, Constants::ASTAR, Constants::ALT,
+        Constants::ARA_STAR, Constants::JPS, Constants::JPS_PLUS, Constants::BIDIRECTIONAL_BFS,
+        Constants::BIDIRECTIONAL_DIJKSTRA, Constants::BIT_PARALLEL_BFS, Constants::DIRECTION_OPTIMIZING_BFS,
+        Constants::HPA_STAR, Constants::CONTRACTION_HIERARCHY, Constants::D_STAR_LITE, Constants::FLOW_FIELD
+    };
+}
+
+bool Benchmark::runSuite(const SuiteSettings& settings, std::ostream& out) {
+    std::mt19937 rng(settings.seed);
+    Grid grid;
+    std::string mapName;
+    if (!settings.mapFile.empty()) {
+        if (!MapLoader::loadTerrain(settings.mapFile, grid)) {
+            return false;
+        }
+        mapName = settings.mapFile;
+    } else if (settings.maze) {
+        grid = MapGenerator::maze(settings.rows, settings.cols, rng());
+        mapName = "maze";
+    } else {
+        grid = MapGenerator::randomObstacles(settings.rows, settings.cols, settings.wallDensity, rng());
+        mapName = "random walls";
+    }
+    if (settings.mapFile.empty() && settings.maxTerrainCost > 1) {
+        MapGenerator::randomTerrain(grid, settings.maxTerrainCost, rng());
+    }
+
+    // Every query has a path, so all planners do comparable work; each try
+    // has a fair chance of landing in the largest region
+    ComponentIndex components;
+    components.build(grid);
+    std::vector<Query> queries;
+    for (int tries = 0; static_cast<int>(queries.size()) < settings.queries && tries < settings.queries * 100; ++tries) {
+        Query query = {MapGenerator::randomFreeCell(grid, rng), MapGenerator::randomFreeCell(grid, rng)};
+        if (query.start.x != -1 &&
+            components.connected(grid.index(query.start.x, query.start.y), grid.index(query.goal.x, query.goal.y))) {
+            queries.push_back(query);
+        }
+    }
+    if (queries.empty()) {
+        std::cerr << "No connected start and goal cells on " << mapName << std::endl;
+        return false;
+    }
+
+    int repetitions = std::max(settings.repetitions, 1);
+    std::vector<SuiteResult> results;
+    std::vector<long long> samples;
+    samples.reserve(queries.size() * repetitions);
+    std::vector<sf::Vector2i> path;
+    path.reserve(grid.getSize());
+    for (Constants::AlgorithmType algorithm : settings.algorithms) {
+        // Only what the planner allocates counts towards its peak
+        long long baseline = AllocationCounter::liveBytes();
+        AllocationCounter::resetPeak();
+        Planner planner;
+        SearchStats stats;
+
+        auto prepareStart = std::chrono::steady_clock::now();
+        prepare(planner, algorithm, grid);
+        std::chrono::duration<double, std::milli> preprocessing = std::chrono::steady_clock::now() - prepareStart;
+
+        for (int pass = 0; pass < settings.warmup; ++pass) {
+            for (const Query& query : queries) {
+                plan(planner, algorithm, grid, query, path, stats);
+            }
+        }
+
+        samples.clear();
+        long long expanded = 0;
+        StatsTotals totals;
+        int found = 0;
+        for (int pass = 0; pass < repetitions; ++pass) {
+            for (const Query& query : queries) {
+                auto startTime = std::chrono::steady_clock::now();
+                bool pathFound = plan(planner, algorithm, grid, query, path, stats);
+                auto endTime = std::chrono::steady_clock::now();
+                samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count());
+                expanded += stats.nodesExpanded;
+                totals.add(stats);
+                found += pass == 0 && pathFound;
+            }
+        }
+
+        long long total = 0;
+        for (long long sample : samples) {
+            total += sample;
+        }
+        std::sort(samples.begin(), samples.end());
+        double count = static_cast<double>(samples.size());
+        results.push_back({Algorithms::algorithmName(algorithm), found,
+                           static_cast<double>(total) / count,
+                           total > 0 ? expanded * 1e9 / total : 0.0,
+                           percentile(samples, 0.50), percentile(samples, 0.95), percentile(samples, 0.99),
+                           preprocessing.count(), AllocationCounter::peakBytes() - baseline,
+                           totals.generated / count, totals.duplicates / count, totals.peakOpen,
+                           totals.pathLength / count, totals.pathCost / count, totals.bytesAllocated / count});
+    }
+    long peakResident = peakResidentKibibytes();
+
+    out << mapName << ", " << grid.getCols() << "x" << grid.getRows() << ": " << queries.size() << " queries, "
+        << settings.warmup << " warm-up and " << repetitions << " timed passes\n";
+    out << std::left << std::setw(12) << "Algorithm" << std::right << std::setw(7) << "Found" << std::setw(12)
+        << "ns/query" << std::setw(14) << "nodes/s" << std::setw(11) << "p50 ns" << std::setw(11) << "p95 ns"
+        << std::setw(11) << "p99 ns" << std::setw(10) << "prep ms" << std::setw(11) << "peak KiB";
+    if (SearchStats::ENABLED) {
+        out << std::setw(11) << "gen/query" << std::setw(11) << "dup/query" << std::setw(10) << "open max"
+            << std::setw(10) << "B/query";
+    }
+    out << "\n";
+    for (const SuiteResult& result : results) {
+        out << std::left << std::setw(12) << result.algorithm << std::right << std::setw(7) << result.found
+            << std::setw(12) << static_cast<long long>(result.nanosecondsPerQuery) << std::setw(14)
+            << static_cast<long long>(result.nodesPerSecond) << std::setw(11) << result.p50 << std::setw(11)
+            << result.p95 << std::setw(11) << result.p99 << std::setw(10) << std::fixed << std::setprecision(2)
+            << result.preprocessingMilliseconds << std::setw(11) << result.peakHeapBytes / 1024;
+        if (SearchStats::ENABLED) {
+            out << std::setprecision(0) << std::setw(11) << result.generated << std::setw(11) << result.duplicates
+                << std::setw(10) << result.peakOpen << std::setw(10) << result.bytesAllocated;
+        }
+        out << "\n";
+        out.unsetf(std::ios::fixed);
+        out << std::setprecision(6);
+    }
+    out << "Peak resident set: " << peakResident << " KiB\n";
+
+    if (settings.jsonFile.empty()) {
+        return true;
+    }
+    std::ofstream json(settings.jsonFile);
+    if (!json) {
+        std::cerr << "Failed to write benchmark results " << settings.jsonFile << std::endl;
+        return false;
+    }
+    json << std::fixed << std::setprecision(3);
+    json << "{\n  \"map\": " << jsonString(mapName) << ",\n  \"rows\": " << grid.getRows()
+         << ",\n  \"cols\": " << grid.getCols() << ",\n  \"queries\": " << queries.size()
+         << ",\n  \"warmup\": " << settings.warmup << ",\n  \"repetitions\": " << repetitions
+         << ",\n  \"seed\": " << settings.seed << ",\n  \"peakResidentKiB\": " << peakResident
+         << ",\n  \"results\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const SuiteResult& result = results[i];
+        json << "    {\"algorithm\": " << jsonString(result.algorithm) << ", \"found\": " << result.found
+             << ", \"nsPerQuery\": " << result.nanosecondsPerQuery << ", \"nodesPerSecond\": " << result.nodesPerSecond
+             << ", \"p50Ns\": " << result.p50 << ", \"p95Ns\": " << result.p95 << ", \"p99Ns\": " << result.p99
+             << ", \"preprocessingMs\": " << result.preprocessingMilliseconds
+             << ", \"peakHeapBytes\": " << result.peakHeapBytes;
+        if (SearchStats::ENABLED) {
+            json << ", \"generatedPerQuery\": " << result.generated << ", \"duplicatePushesPerQuery\": "
+                 << result.duplicates << ", \"peakOpen\": " << result.peakOpen << ", \"meanPathLength\": "
+                 << result.pathLength << ", \"meanPathCost\": " << result.pathCost
+                 << ", \"bytesAllocatedPerQuery\": " << result.bytesAllocated;
+        }
+        json << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    json << "  ]\n}\n";
+    out << "Wrote " << settings.jsonFile << "\n";
+    return static_cast<bool>(json);
+}
+
+namespace {
+    // Length with straight steps of 1 and diagonal ones of sqrt(2), as the
+    // Moving AI scenarios measure it
+    double octileLength(const std::vector<sf::Vector2i>& path) {
+        double length = 0.0;
+        for (std::size_t i = 1; i < path.size(); ++i) {
+            bool diagonal = path[i].x != path[i - 1].x && path[i].y != path[i - 1].y;
+            length += diagonal ? std::sqrt(2.0) : 1.0;
+        }
+        return length;
+    }
+
+    // The map a scenario line names is relative to the scenario file, but
+    // the benchmark archives unpack maps and scenarios into separate
+    // folders, so the bare file name next to the scenario is tried as well
+    std::string scenarioMapPath(const std::string& scenarioFile, const std::string& map) {
+        std::filesystem::path directory = std::filesystem::path(scenarioFile).parent_path();
+        const std::filesystem::path candidates[] = {
+            directory / map, directory / std::filesystem::path(map).filename(), map
+        };
+        for (const std::filesystem::path& candidate : candidates) {
+            if (std::filesystem::exists(candidate)) {
+                return candidate.string();
+            }
+        }
+        return (directory / map).string();
+    }
+}
+
+bool Benchmark::runScenarios(const std::string& scenarioFile, const std::string& mapFile,
+                             const std::vector<Constants::AlgorithmType>& algorithms, std::ostream& out) {
+    std::vector<MapLoader::ScenarioQuery> scenario;
+    if (!MapLoader::loadScenario(scenarioFile, scenario)) {
+        return false;
+    }
+    if (scenario.empty()) {
+        std::cerr << "Scenario " << scenarioFile << " has no queries" << std::endl;
+        return false;
+    }
+
+    // A scenario file normally covers one map; otherwise its queries are
+    // run map by map, in the order the maps first appear. A map given on
+    // the command line serves every query.
+    std::vector<std::string> maps;
+    for (const MapLoader::ScenarioQuery& query : scenario) {
+        if (mapFile.empty() ? std::find(maps.begin(), maps.end(), query.map) == maps.end() : maps.empty()) {
+            maps.push_back(query.map);
+        }
+    }
+
+    const Movement movingAI(Constants::EIGHT_CONNECTED, Constants::NO_CUT_CORNERS);
+    bool passed = true;
+    Grid grid;
+    std::vector<MapLoader::ScenarioQuery> entries;
+    std::vector<sf::Vector2i> path;
+    for (const std::string& map : maps) {
+        std::string filename = mapFile.empty() ? scenarioMapPath(scenarioFile, map) : mapFile;
+        if (!MapLoader::loadMovingAIMap(filename, grid)) {
+            return false;
+        }
+        entries.clear();
+        for (const MapLoader::ScenarioQuery& query : scenario) {
+            if (!mapFile.empty() || query.map == map) {
+                entries.push_back(query);
+            }
+        }
+        if (entries.front().width != grid.getCols() || entries.front().height != grid.getRows()) {
+            std::cerr << "Scenario " << scenarioFile << " expects a " << entries.front().width << "x"
+                      << entries.front().height << " map, " << filename << " is " << grid.getCols() << "x"
+                      << grid.getRows() << std::endl;
+            return false;
+        }
+
+        // Buckets group queries of similar length, 10 to a bucket
+        std::stable_sort(entries.begin(), entries.end(),
+                         [](const MapLoader::ScenarioQuery& first, const MapLoader::ScenarioQuery& second) {
+                             return first.bucket < second.bucket;
+                         });
+        std::vector<std::size_t> bucketStarts;
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            if (i == 0 || entries[i].bucket != entries[i - 1].bucket) {
+                bucketStarts.push_back(i);
+            }
+        }
+        bucketStarts.push_back(entries.size());
+        out << filename << ", " << grid.getCols() << "x" << grid.getRows() << ": " << entries.size()
+            << " queries in " << bucketStarts.size() - 1 << " buckets\n";
+
+        for (Constants::AlgorithmType algorithm : algorithms) {
+            bool diagonal = algorithm == Constants::DFS || algorithm == Constants::BFS ||
+                            algorithm == Constants::DIJKSTRA || algorithm == Constants::ASTAR;
+            bool optimal = algorithm == Constants::DIJKSTRA || algorithm == Constants::ASTAR;
+            Movement movement = diagonal ? movingAI : Movement();
+            Planner planner;
+            SearchStats stats;
+
+            auto prepareStart = std::chrono::steady_clock::now();
+            prepare(planner, algorithm, grid);
+            std::chrono::duration<double, std::milli> preprocessing = std::chrono::steady_clock::now() - prepareStart;
+
+            // The check doubles as the warm-up. Fixed-point diagonals of
+            // 99/70 may pick a path longer than optimal by 0.005% at most.
+            int failures = 0;
+            int timeouts = 0;
+            for (const MapLoader::ScenarioQuery& entry : entries) {
+                bool found = plan(planner, algorithm, grid, {entry.start, entry.goal}, path, stats, movement);
+                // ARA* may run out of time before its first path; that is
+                // counted apart, not as a wrong answer
+                if (!found && stats.timedOut) {
+                    ++timeouts;
+                    continue;
+                }
+                double length = found ? octileLength(path) : -1.0;
+                double tolerance = 1e-4 * entry.optimalLength + 1e-6;
+                if (found && Verification::isValidPath(grid, entry.start, entry.goal, path, movement) &&
+                    length >= entry.optimalLength - tolerance &&
+                    (!optimal || length <= entry.optimalLength + tolerance)) {
+                    continue;
+                }
+                if (++failures <= 5) {
+                    out << "  " << Algorithms::algorithmName(algorithm) << " bucket " << entry.bucket << ": ("
+                        << entry.start.x << ", " << entry.start.y << ") -> (" << entry.goal.x << ", "
+                        << entry.goal.y << ") expected length " << entry.optimalLength << ", got " << length << "\n";
+                }
+            }
+            passed &= failures == 0;
+
+            out << Algorithms::algorithmName(algorithm) << " (" << (diagonal ? "8-way" : "4-way") << "): "
+                << entries.size() - failures - timeouts << "/" << entries.size()
+                << (optimal ? " paths optimal" : " paths valid and no shorter than optimal");
+            if (timeouts > 0) {
+                out << ", " << timeouts << " past the deadline";
+            }
+            out << ", preprocessing " << preprocessing.count() << " ms\n";
+            out << "  " << std::setw(6) << "bucket" << std::setw(12) << "queries/s" << std::setw(14) << "nodes/s"
+                << std::setw(12) << "mean us";
+            if (SearchStats::ENABLED) {
+                out << std::setw(11) << "gen/query" << std::setw(10) << "open max" << std::setw(10) << "B/query";
+            }
+            out << "\n";
+            for (std::size_t b = 0; b + 1 < bucketStarts.size(); ++b) {
+                long long expanded = 0;
+                StatsTotals totals;
+                auto startTime = std::chrono::steady_clock::now();
+                for (std::size_t i = bucketStarts[b]; i < bucketStarts[b + 1]; ++i) {
+                    plan(planner, algorithm, grid, {entries[i].start, entries[i].goal}, path, stats, movement);
+                    expanded += stats.nodesExpanded;
+                    totals.add(stats);
+                }
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+                double count = static_cast<double>(bucketStarts[b + 1] - bucketStarts[b]);
+                out << "  " << std::setw(6) << entries[bucketStarts[b]].bucket << std::setw(12)
+                    << static_cast<long long>(count / elapsed.count()) << std::setw(14)
+                    << static_cast<long long>(expanded / elapsed.count()) << std::setw(12)
+                    << elapsed.count() * 1e6 / count;
+                if (SearchStats::ENABLED) {
+                    out << std::setw(11) << static_cast<long long>(totals.generated / count) << std::setw(10)
+                        << totals.peakOpen << std::setw(10) << static_cast<long long>(totals.bytesAllocated / count);
+                }
+                out << "\n";
+            }
+        }
+    }
+    return passed;
+}
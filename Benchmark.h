@@ -0,0 +1,79 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Constants.h"
+
+// Headless timing runs, separate from Verification's correctness checks.
+// They are built into the benchmark executable, which links no SFML
+// library and needs no display.
+class Benchmark {
+public:
+    // The map the suite runs on: a terrain file as read by MapLoader, or
+    // else a generated map with random walls and terrain, or a maze
+    struct SuiteSettings {
+        std::string mapFile;
+        int rows = 256;
+        int cols = 256;
+        double wallDensity = 0.25;
+        int maxTerrainCost = 1;
+        bool maze = false;
+        int queries = 1000;
+        int warmup = 1;
+        int repetitions = 5;
+        unsigned seed = 1;
+        std::string jsonFile = "benchmark.json"; // empty for no JSON
+        std::vector<Constants::AlgorithmType> algorithms = singleAgentAlgorithms();
+    };
+
+    // Every planner the suite and the scenario runner can time; the
+    // multi-agent ones have their own throughput run
+    static std::vector<Constants::AlgorithmType> singleAgentAlgorithms();
+
+    // Runs every single-agent planner over the same random queries between
+    // connected cells: `warmup` untimed passes, then `repetitions` passes
+    // timing each query on its own. Prints a table of ns/query, nodes
+    // expanded per second, p50/p95/p99 latency, preprocessing time, peak
+    // heap use and the SearchStats counters per planner, then the process's
+    // peak resident set, and writes the same to the JSON file. Returns false
+    // if the map cannot be loaded or the JSON cannot be written.
+    static bool runSuite(const SuiteSettings& settings, std::ostream& out);
+
+    // Runs a Moving AI scenario file through each of `algorithms`, on the
+    // map each line names, looked up next to the scenario file, or on
+    // `mapFile` if given. DFS, BFS, Dijkstra and A* move 8-way without
+    // cutting corners, as the benchmark's optimal lengths assume, and the
+    // other planners 4-way. Every path must be valid and no shorter than
+    // the optimal length, and Dijkstra's and A*'s must match it. An untimed
+    // pass checks the paths, then each bucket is timed on its own; reports
+    // queries/s, nodes expanded per second, mean latency, nodes generated,
+    // the largest open list and bytes allocated per bucket.
+    // Returns false if a file cannot be loaded or any path fails its check.
+    static bool runScenarios(const std::string& scenarioFile, const std::string& mapFile,
+                             const std::vector<Constants::AlgorithmType>& algorithms, std::ostream& out);
+
+    // Times DFS, BFS, Dijkstra and A* through the search kernel against the
+    // hand-written 4-connected loops they replaced, on the same random
+    // queries over one map with random walls and terrain. Reports ns/query
+    // for both and their ratio; returns false if the two ever disagree on
+    // reachability, or BFS, Dijkstra and A* on path length or cost.
+    static bool compareSearchKernel(int rows, int cols, int queries,
+                                    unsigned seed, std::ostream& out);
+
+    // Runs the same random queries through A* with Manhattan distance and
+    // through ALT with 4, 8 and 16 landmarks of each selection, on a map
+    // with random walls and terrain and on a maze. Reports the nodes each
+    // expands per query, ns/query, and the build time and size of the
+    // tables; returns false if any path cost differs from A*'s.
+    static bool compareLandmarks(int rows, int cols, int queries,
+                                 unsigned seed, std::ostream& out);
+
+    // Builds a contraction hierarchy on one thread and on every hardware
+    // thread, then times random queries through it against Dijkstra and A*
+    // on a map with random walls and terrain. Reports build times,
+    // shortcuts, nodes settled and ns/query; returns false if any path cost
+    // differs from Dijkstra's.
+    static bool compareContractionHierarchy(int rows, int cols, int queries,
+                                            unsigned seed, std::ostream& out);
+};
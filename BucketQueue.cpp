@@ -0,0 +1,32 @@
+#include "BucketQueue.h"
+
+BucketQueue::BucketQueue(int maxStepCost) :
+    buckets(maxStepCost + 1),
+    cursor(0),
+    count(0) {}
+
+void BucketQueue::clear() {
+    // Keep each bucket's capacity so that a reused queue does not reallocate
+    for (auto& bucket : buckets) {
+        bucket.clear();
+    }
+    cursor = 0;
+    count = 0;
+}
+
+void BucketQueue::push(int index, int key) {
+    buckets[key % buckets.size()].push_back(index);
+    ++count;
+}
+
+int BucketQueue::pop(int& key) {
+    while (buckets[cursor % buckets.size()].empty()) {
+        ++cursor;
+    }
+    std::vector<int>& bucket = buckets[cursor % buckets.size()];
+    int index = bucket.back();
+    bucket.pop_back();
+    --count;
+    key = cursor;
+    return index;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+#include "Constants.h"
+
+// Dial's bucket queue for Dijkstra with small integer step costs.
+//
+// Keys popped from Dijkstra never decrease and a pushed key is at most
+// maxStepCost above the last popped one, so maxStepCost + 1 buckets used as
+// a ring are enough. Push is O(1) and pop is O(1) amortized: the cursor only
+// moves forward, at most maxStepCost empty buckets per popped key.
+class BucketQueue {
+public:
+    explicit BucketQueue(int maxStepCost = Constants::MAX_TERRAIN_COST);
+
+    void clear();
+    bool empty() const { return count == 0; }
+    int size() const { return count; }
+
+    // key must lie in [current key, current key + maxStepCost]
+    void push(int index, int key);
+
+    // Removes an entry with the smallest key and returns its index
+    int pop(int& key);
+
+private:
+    std::vector<std::vector<int>> buckets;
+    int cursor;
+    int count;
+};
@@ -0,0 +1,217 @@
+#include "ComponentIndex.h"
+#include <algorithm>
+
+static const int STEPS[4][2] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}};
+
+ComponentIndex::ComponentIndex() : componentCount(0), generation(0), revision(0), built(false) {}
+
+void ComponentIndex::clear() {
+    labels.clear();
+    parent.clear();
+    rank.clear();
+    visitStamp.clear();
+    visitOwner.clear();
+    componentCount = 0;
+    built = false;
+}
+
+void ComponentIndex::build(const Grid& grid) {
+    labels.assign(grid.getSize(), -1);
+    parent.clear();
+    rank.clear();
+    visitStamp.assign(grid.getSize(), 0);
+    visitOwner.assign(grid.getSize(), 0);
+    generation = 0;
+    componentCount = 0;
+
+    std::vector<int>& queue = visited[0];
+    for (int y = 0; y < grid.getRows(); ++y) {
+        for (int x = 0; x < grid.getCols(); ++x) {
+            int seed = grid.index(x, y);
+            if (grid.isWall(x, y) || labels[seed] != -1) {
+                continue;
+            }
+
+            int id = newComponent();
+            labels[seed] = id;
+            queue.clear();
+            queue.push_back(seed);
+            for (std::size_t head = 0; head < queue.size(); ++head) {
+                int cellX = grid.indexX(queue[head]);
+                int cellY = grid.indexY(queue[head]);
+                for (auto& step : STEPS) {
+                    int newX = cellX + step[0];
+                    int newY = cellY + step[1];
+                    if (grid.isWalkable(newX, newY) && labels[grid.index(newX, newY)] == -1) {
+                        labels[grid.index(newX, newY)] = id;
+                        queue.push_back(grid.index(newX, newY));
+                    }
+                }
+            }
+        }
+    }
+    revision = grid.getRevision();
+    built = true;
+}
+
+int ComponentIndex::newComponent() {
+    int id = static_cast<int>(parent.size());
+    parent.push_back(id);
+    rank.push_back(0);
+    ++componentCount;
+    return id;
+}
+
+void ComponentIndex::unite(int first, int second) {
+    while (parent[first] != first) first = parent[first];
+    while (parent[second] != second) second = parent[second];
+    if (first == second) {
+        return;
+    }
+    if (rank[first] < rank[second]) {
+        std::swap(first, second);
+    }
+    parent[second] = first;
+    if (rank[first] == rank[second]) {
+        ++rank[first];
+    }
+    --componentCount;
+}
+
+void ComponentIndex::updateCell(const Grid& grid, int x, int y) {
+    if (!built || !grid.isValidCell(x, y)) {
+        return;
+    }
+    revision = grid.getRevision();
+
+    int index = grid.index(x, y);
+    bool wall = grid.isWall(x, y);
+    if (!wall && labels[index] == -1) {
+        // A freed cell joins every component it now touches
+        int id = -1;
+        for (auto& step : STEPS) {
+            int newX = x + step[0];
+            int newY = y + step[1];
+            if (!grid.isWalkable(newX, newY)) {
+                continue;
+            }
+            int neighbor = labels[grid.index(newX, newY)];
+            if (id == -1) {
+                id = neighbor;
+            } else {
+                unite(id, neighbor);
+            }
+        }
+        labels[index] = id == -1 ? newComponent() : id;
+    } else if (wall && labels[index] != -1) {
+        labels[index] = -1;
+        splitAround(grid, index);
+    }
+
+    // Every split mints a new id; start over once the forest has grown
+    // past the size of the map
+    if (parent.size() > static_cast<std::size_t>(grid.getSize())) {
+        build(grid);
+    }
+}
+
+void ComponentIndex::splitAround(const Grid& grid, int index) {
+    int neighbors[4];
+    int count = 0;
+    for (auto& step : STEPS) {
+        int newX = grid.indexX(index) + step[0];
+        int newY = grid.indexY(index) + step[1];
+        if (grid.isWalkable(newX, newY)) {
+            neighbors[count++] = grid.index(newX, newY);
+        }
+    }
+    if (count == 0) {
+        --componentCount; // The cell was a component on its own
+        return;
+    }
+    if (count == 1) {
+        return; // A dead end cannot disconnect anything
+    }
+
+    if (++generation == 0) {
+        std::fill(visitStamp.begin(), visitStamp.end(), 0u);
+        generation = 1;
+    }
+
+    // group[] is a tiny union-find over the searches; a group is closed once
+    // all of its searches have run out of cells
+    int group[4];
+    std::size_t head[4];
+    bool closed[4];
+    for (int i = 0; i < count; ++i) {
+        visited[i].clear();
+        visited[i].push_back(neighbors[i]);
+        visitStamp[neighbors[i]] = generation;
+        visitOwner[neighbors[i]] = static_cast<std::uint8_t>(i);
+        group[i] = i;
+        head[i] = 0;
+        closed[i] = false;
+    }
+    auto groupOf = [&](int i) {
+        while (group[i] != i) i = group[i];
+        return i;
+    };
+
+    int openGroups = count;
+    while (openGroups > 1) {
+        for (int i = 0; i < count && openGroups > 1; ++i) {
+            if (closed[i]) {
+                continue;
+            }
+
+            if (head[i] == visited[i].size()) {
+                int root = groupOf(i);
+                bool exhausted = true;
+                for (int j = 0; j < count; ++j) {
+                    if (groupOf(j) == root && head[j] < visited[j].size()) {
+                        exhausted = false;
+                    }
+                }
+                if (!exhausted) {
+                    continue;
+                }
+                // Cut off from the searches still running: a new component
+                int id = newComponent();
+                for (int j = 0; j < count; ++j) {
+                    if (groupOf(j) == root) {
+                        for (int cell : visited[j]) {
+                            labels[cell] = id;
+                        }
+                        closed[j] = true;
+                    }
+                }
+                --openGroups;
+                continue;
+            }
+
+            int current = visited[i][head[i]++];
+            int x = grid.indexX(current);
+            int y = grid.indexY(current);
+            for (auto& step : STEPS) {
+                int newX = x + step[0];
+                int newY = y + step[1];
+                if (!grid.isWalkable(newX, newY)) {
+                    continue;
+                }
+                int neighbor = grid.index(newX, newY);
+                if (visitStamp[neighbor] != generation) {
+                    visitStamp[neighbor] = generation;
+                    visitOwner[neighbor] = static_cast<std::uint8_t>(i);
+                    visited[i].push_back(neighbor);
+                } else {
+                    int mine = groupOf(i);
+                    int theirs = groupOf(visitOwner[neighbor]);
+                    if (mine != theirs) {
+                        group[theirs] = mine;
+                        --openGroups;
+                    }
+                }
+            }
+        }
+    }
+}
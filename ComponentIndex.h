@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "Grid.h"
+
+// Connected-component labels of the free cells, so a query whose start and
+// goal lie in different components can be rejected without searching.
+//
+// Every free cell stores a component id, and ids are merged in a union-find
+// forest (union by rank, no path compression, so lookups stay read-only and
+// safe to share between threads). Edits are patched locally:
+//  - freeing a cell unions the components of its free neighbours;
+//  - walling a cell runs one BFS from each of its free neighbours in
+//    lockstep. Searches that meet are still connected; a group of searches
+//    that runs out of cells before the others has been cut off and gets a
+//    fresh id. Only the smaller side of a split is ever relabelled, and
+//    nothing at all once every search has met.
+class ComponentIndex {
+public:
+    ComponentIndex();
+
+    void build(const Grid& grid);
+    void clear();
+    bool isBuilt() const { return built; }
+
+    // True if built, or patched by updateCell, for exactly this grid revision
+    bool isCurrent(const Grid& grid) const { return built && revision == grid.getRevision(); }
+
+    // Call after changing the wall state of (x, y). Terrain edits leave the
+    // labels as they are, but reporting them keeps isCurrent true.
+    void updateCell(const Grid& grid, int x, int y);
+
+    // Root id of the component holding a grid index, or -1 for a wall
+    int component(int index) const {
+        int id = labels[index];
+        if (id < 0) {
+            return -1;
+        }
+        while (parent[id] != id) {
+            id = parent[id];
+        }
+        return id;
+    }
+
+    bool connected(int first, int second) const {
+        int component1 = component(first);
+        return component1 != -1 && component1 == component(second);
+    }
+
+    int getComponentCount() const { return componentCount; }
+
+private:
+    int newComponent();
+    void unite(int first, int second);
+    void splitAround(const Grid& grid, int index);
+
+    std::vector<int> labels;
+    std::vector<int> parent;
+    std::vector<std::uint8_t> rank;
+    int componentCount;
+
+    // Scratch for the lockstep searches of splitAround
+    std::vector<unsigned> visitStamp;
+    std::vector<std::uint8_t> visitOwner;
+    std::vector<int> visited[4];
+    unsigned generation;
+    std::uint64_t revision;
+    bool built;
+};
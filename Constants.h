@@ -5,10 +5,46 @@ namespace Constants {
     const int COLS = 16;
     const int TILE_SIZE = 32;
     const int TOP_BAR_HEIGHT = 60;
-    const int BOTTOM_BAR_HEIGHT = 40;
+    const int BOTTOM_BAR_HEIGHT = 80;
     const int WINDOW_WIDTH = COLS * TILE_SIZE;
     const int WINDOW_HEIGHT = ROWS * TILE_SIZE + TOP_BAR_HEIGHT + BOTTOM_BAR_HEIGHT;
 
+    // Cost of stepping into a cell; walls are stored separately as CellType
+    const int MIN_TERRAIN_COST = 1;
+    const int MAX_TERRAIN_COST = 255;
+
+    // Terrain costs cycled through by right-clicking a cell
+    const int TERRAIN_PRESETS[] = {1, 4, 16, 64};
+    const int TERRAIN_PRESET_COUNT = 4;
+
+    // Cluster side of the visualizer's HPA* graph, small enough that the
+    // board is split into several clusters
+    const int HPA_CLUSTER_SIZE = 4;
+
+    // Landmarks the visualizer's ALT mode places
+    const int ALT_LANDMARKS = 4;
+
+    // Time the visualizer's ARA* may spend improving its path
+    const float ARA_DEADLINE_MS = 2.0f;
+
+    // Timing mode: untimed warm-up runs, then timed ones until there are
+    // at least TIMING_MIN_RUNS, enough for ten to lie above the p99, and
+    // the 95% confidence interval of the mean is within TIMING_TOLERANCE of
+    // it, or until the budget is spent. The budget can be changed with
+    // --timing-budget.
+    const int TIMING_WARMUP_RUNS = 5;
+    const int TIMING_MIN_RUNS = 1000;
+    const int TIMING_MAX_RUNS = 1000000;
+    const double TIMING_TOLERANCE = 0.01;
+    const double TIMING_BUDGET_MS = 250.0;
+
+    // Agents the multi-agent planners route alongside the user's own, from
+    // and to random free cells
+    const int EXTRA_AGENTS = 5;
+
+    // Playback speed of the multi-agent plans
+    const float AGENT_STEPS_PER_SECOND = 3.0f;
+
     enum CellType {
         EMPTY = 0,
         WALL = 1,
@@ -20,6 +56,47 @@ namespace Constants {
     enum AlgorithmType {
         DFS,
         BFS,
-        DIJKSTRA
+        DIJKSTRA,
+        ASTAR,
+        ALT,
+        ARA_STAR,
+        JPS,
+        JPS_PLUS,
+        BIDIRECTIONAL_BFS,
+        BIDIRECTIONAL_DIJKSTRA,
+        BIT_PARALLEL_BFS,
+        DIRECTION_OPTIMIZING_BFS,
+        HPA_STAR,
+        CONTRACTION_HIERARCHY,
+        D_STAR_LITE,
+        FLOW_FIELD,
+        COOPERATIVE_ASTAR,
+        CONFLICT_BASED_SEARCH
+    };
+
+    // Neighbours a search may step to: the orthogonal ones, or the
+    // diagonals as well. See Movement.h.
+    enum Connectivity {
+        FOUR_CONNECTED,
+        EIGHT_CONNECTED
+    };
+
+    // Which diagonal steps past the corner of a wall are allowed
+    enum CornerPolicy {
+        CUT_CORNERS,
+        NO_SQUEEZE,
+        NO_CUT_CORNERS
+    };
+
+    // How ALT places its landmarks; see LandmarkTable
+    enum LandmarkSelection {
+        FARTHEST_LANDMARKS,
+        AVOID_LANDMARKS
+    };
+
+    enum HeuristicType {
+        MANHATTAN,
+        OCTILE,
+        EUCLIDEAN
     };
 }
\ No newline at end of file
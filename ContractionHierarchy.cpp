@@ -0,0 +1,565 @@
+#include "ContractionHierarchy.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+namespace {
+    // Witness searches give up after settling this many cells and keep the
+    // shortcut. That only costs an edge the query may never need, and keeps
+    // contraction fast once the remaining graph gets dense.
+    const int WITNESS_SETTLE_LIMIT = 256;
+
+    // File header: magic, then version
+    const char FILE_MAGIC[8] = {'G', 'R', 'I', 'D', 'C', 'H', '\0', '\0'};
+    const std::uint32_t FILE_VERSION = 1;
+
+    struct Arc {
+        int node;
+        int weight;
+        int middle;
+    };
+
+    struct Shortcut {
+        int from;
+        int to;
+        int weight;
+        int middle;
+    };
+
+    // Calls body(thread, i) for every i below count, on up to `threads`
+    // threads that take indices from a shared counter. Late rounds contract
+    // only a few cells, not worth starting a thread for.
+    void parallelFor(int threads, std::size_t count, const std::function<void(int, std::size_t)>& body) {
+        threads = static_cast<int>(std::min<std::size_t>(threads, (count + 63) / 64));
+        std::atomic<std::size_t> next(0);
+        auto work = [&](int thread) {
+            for (std::size_t i = next++; i < count; i = next++) {
+                body(thread, i);
+            }
+        };
+        std::vector<std::thread> pool;
+        for (int thread = 1; thread < threads; ++thread) {
+            pool.emplace_back(work, thread);
+        }
+        work(0);
+        for (std::thread& thread : pool) {
+            thread.join();
+        }
+    }
+
+    // The graph while it is being contracted. arcsOut[v] and arcsIn[v] hold
+    // v's edges to and from the cells that are still in the graph, at most
+    // one per pair of cells.
+    class Contraction {
+    public:
+        std::vector<std::vector<Arc>> arcsOut;
+        std::vector<std::vector<Arc>> arcsIn;
+        std::vector<char> contracted;
+
+        explicit Contraction(int nodes) : arcsOut(nodes), arcsIn(nodes), contracted(nodes, 0) {}
+
+        // Adds from -> to, or lowers the existing edge if this one is cheaper
+        void addArc(int from, int to, int weight, int middle) {
+            for (Arc& arc : arcsOut[from]) {
+                if (arc.node == to) {
+                    if (weight < arc.weight) {
+                        arc.weight = weight;
+                        arc.middle = middle;
+                        for (Arc& back : arcsIn[to]) {
+                            if (back.node == from) {
+                                back.weight = weight;
+                                back.middle = middle;
+                            }
+                        }
+                    }
+                    return;
+                }
+            }
+            arcsOut[from].push_back({to, weight, middle});
+            arcsIn[to].push_back({from, weight, middle});
+        }
+    };
+
+    // Bounded Dijkstra on the remaining graph, one per thread
+    class WitnessSearch {
+    public:
+        explicit WitnessSearch(int nodes) : distances(nodes), stamps(nodes, 0), generation(0) {}
+
+        int distance(int node) const { return stamps[node] == generation ? distances[node] : INT_MAX; }
+
+        // Costs from source to every cell within maxCost, not passing
+        // through `avoid`, as far as the settle limit allows
+        void run(const Contraction& graph, int source, int avoid, int maxCost) {
+            ++generation;
+            heap.clear();
+            set(source, 0);
+            int settled = 0;
+            while (!heap.empty() && settled < WITNESS_SETTLE_LIMIT) {
+                std::pop_heap(heap.begin(), heap.end(), std::greater<std::pair<int, int>>());
+                std::pair<int, int> top = heap.back();
+                heap.pop_back();
+                if (top.first > distance(top.second)) {
+                    continue;
+                }
+                if (top.first > maxCost) {
+                    break;
+                }
+                ++settled;
+                for (const Arc& arc : graph.arcsOut[top.second]) {
+                    if (arc.node != avoid && !graph.contracted[arc.node] &&
+                        top.first + arc.weight < distance(arc.node)) {
+                        set(arc.node, top.first + arc.weight);
+                    }
+                }
+            }
+        }
+
+    private:
+        void set(int node, int cost) {
+            stamps[node] = generation;
+            distances[node] = cost;
+            heap.push_back({cost, node});
+            std::push_heap(heap.begin(), heap.end(), std::greater<std::pair<int, int>>());
+        }
+
+        std::vector<int> distances;
+        std::vector<unsigned> stamps;
+        std::vector<std::pair<int, int>> heap;
+        unsigned generation;
+    };
+
+    // The shortcuts contracting v would need, appended to `shortcuts` if
+    // given; returns how many
+    int contract(const Contraction& graph, int v, WitnessSearch& witness, std::vector<Shortcut>* shortcuts) {
+        int count = 0;
+        for (const Arc& in : graph.arcsIn[v]) {
+            int maxCost = 0;
+            for (const Arc& out : graph.arcsOut[v]) {
+                if (out.node != in.node) {
+                    maxCost = std::max(maxCost, in.weight + out.weight);
+                }
+            }
+            if (maxCost == 0) {
+                continue;
+            }
+            witness.run(graph, in.node, v, maxCost);
+            for (const Arc& out : graph.arcsOut[v]) {
+                if (out.node != in.node && witness.distance(out.node) > in.weight + out.weight) {
+                    ++count;
+                    if (shortcuts) {
+                        shortcuts->push_back({in.node, out.node, in.weight + out.weight, v});
+                    }
+                }
+            }
+        }
+        return count;
+    }
+}
+
+ContractionHierarchy::ContractionHierarchy()
+    : shortcutCount(0), rows(0), cols(0), mapFingerprint(0), revision(0), built(false) {}
+
+void ContractionHierarchy::clear() {
+    cellNodes.clear();
+    nodeCells.clear();
+    forwardOffsets.clear();
+    forwardEdges.clear();
+    backwardOffsets.clear();
+    backwardEdges.clear();
+    shortcutCount = 0;
+    built = false;
+}
+
+void ContractionHierarchy::build(const Grid& grid, int threadCount) {
+    clear();
+    if (threadCount <= 0) {
+        threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    rows = grid.getRows();
+    cols = grid.getCols();
+    mapFingerprint = fingerprint(grid);
+    revision = grid.getRevision();
+
+    // Free cells, numbered in row-major order until they get their ranks
+    std::vector<int> cells;
+    std::vector<int> ids(grid.getSize(), -1);
+    for (int index = 0; index < grid.getSize(); ++index) {
+        if (!grid.isWall(grid.indexX(index), grid.indexY(index))) {
+            ids[index] = static_cast<int>(cells.size());
+            cells.push_back(index);
+        }
+    }
+    const int nodes = static_cast<int>(cells.size());
+
+    Contraction graph(nodes);
+    const int dx[] = {0, 1, 0, -1};
+    const int dy[] = {-1, 0, 1, 0};
+    for (int v = 0; v < nodes; ++v) {
+        int x = grid.indexX(cells[v]);
+        int y = grid.indexY(cells[v]);
+        for (int d = 0; d < 4; ++d) {
+            if (grid.isWalkable(x + dx[d], y + dy[d])) {
+                graph.addArc(v, ids[grid.index(x + dx[d], y + dy[d])], grid.cost(x + dx[d], y + dy[d]), -1);
+            }
+        }
+    }
+
+    // A cell's priority is twice its edge difference, the shortcuts
+    // contracting it would add minus the edges it would remove, plus the
+    // neighbours already contracted and its depth in the hierarchy so far.
+    // The last two spread the contraction evenly over the map, which keeps
+    // queries shallow.
+    std::vector<int> priority(nodes, 0);
+    std::vector<int> contractedNeighbours(nodes, 0);
+    std::vector<int> level(nodes, 0);
+    std::vector<WitnessSearch> witnesses(threadCount, WitnessSearch(nodes));
+    auto updatePriority = [&](int thread, int v) {
+        int shortcuts = contract(graph, v, witnesses[thread], nullptr);
+        int removed = static_cast<int>(graph.arcsIn[v].size() + graph.arcsOut[v].size());
+        priority[v] = 2 * (shortcuts - removed) + contractedNeighbours[v] + level[v];
+    };
+
+    std::vector<int> remaining(nodes);
+    for (int v = 0; v < nodes; ++v) {
+        remaining[v] = v;
+    }
+    parallelFor(threadCount, remaining.size(), [&](int thread, std::size_t i) {
+        updatePriority(thread, remaining[i]);
+    });
+
+    std::vector<int> rank(nodes, -1);
+    std::vector<std::vector<Arc>> forward(nodes);
+    std::vector<std::vector<Arc>> backward(nodes);
+    std::vector<char> selected(nodes, 0);
+    std::vector<char> dirty(nodes, 0);
+    std::vector<std::vector<Shortcut>> found(threadCount);
+    std::vector<Shortcut> merged;
+    int nextRank = 0;
+
+    while (!remaining.empty()) {
+        // Cells that come before every remaining cell within two steps, by
+        // priority and then by number
+        auto before = [&](int first, int second) {
+            return priority[first] < priority[second] || (priority[first] == priority[second] && first < second);
+        };
+        parallelFor(threadCount, remaining.size(), [&](int, std::size_t i) {
+            int v = remaining[i];
+            bool least = true;
+            auto check = [&](const std::vector<Arc>& arcs) {
+                for (const Arc& arc : arcs) {
+                    if (!before(v, arc.node)) {
+                        least = false;
+                        return;
+                    }
+                    for (const Arc& second : graph.arcsOut[arc.node]) {
+                        if (second.node != v && !before(v, second.node)) {
+                            least = false;
+                            return;
+                        }
+                    }
+                    for (const Arc& second : graph.arcsIn[arc.node]) {
+                        if (second.node != v && !before(v, second.node)) {
+                            least = false;
+                            return;
+                        }
+                    }
+                }
+            };
+            check(graph.arcsOut[v]);
+            if (least) {
+                check(graph.arcsIn[v]);
+            }
+            selected[v] = least;
+        });
+
+        std::vector<int> round;
+        for (int v : remaining) {
+            if (selected[v]) {
+                round.push_back(v);
+            }
+        }
+
+        // Witness searches only read the graph, so the round's cells can
+        // work out their shortcuts side by side
+        for (std::vector<Shortcut>& shortcuts : found) {
+            shortcuts.clear();
+        }
+        parallelFor(threadCount, round.size(), [&](int thread, std::size_t i) {
+            contract(graph, round[i], witnesses[thread], &found[thread]);
+        });
+
+        // Everything a contracted cell is still joined to outranks it
+        for (int v : round) {
+            rank[v] = nextRank++;
+            graph.contracted[v] = 1;
+            forward[v] = graph.arcsOut[v];
+            backward[v] = graph.arcsIn[v];
+        }
+        for (int v : round) {
+            for (const Arc& arc : graph.arcsOut[v]) {
+                std::vector<Arc>& arcs = graph.arcsIn[arc.node];
+                arcs.erase(std::remove_if(arcs.begin(), arcs.end(), [&](const Arc& other) { return other.node == v; }),
+                           arcs.end());
+                ++contractedNeighbours[arc.node];
+                level[arc.node] = std::max(level[arc.node], level[v] + 1);
+                dirty[arc.node] = 1;
+            }
+            for (const Arc& arc : graph.arcsIn[v]) {
+                std::vector<Arc>& arcs = graph.arcsOut[arc.node];
+                arcs.erase(std::remove_if(arcs.begin(), arcs.end(), [&](const Arc& other) { return other.node == v; }),
+                           arcs.end());
+                ++contractedNeighbours[arc.node];
+                level[arc.node] = std::max(level[arc.node], level[v] + 1);
+                dirty[arc.node] = 1;
+            }
+            std::vector<Arc>().swap(graph.arcsOut[v]);
+            std::vector<Arc>().swap(graph.arcsIn[v]);
+        }
+        // In a fixed order, whichever thread found them, so that the edge
+        // lists and with them the next round's witness searches do not
+        // depend on the thread count
+        merged.clear();
+        for (const std::vector<Shortcut>& shortcuts : found) {
+            merged.insert(merged.end(), shortcuts.begin(), shortcuts.end());
+        }
+        std::sort(merged.begin(), merged.end(), [](const Shortcut& first, const Shortcut& second) {
+            return std::tie(first.from, first.to, first.weight, first.middle) <
+                   std::tie(second.from, second.to, second.weight, second.middle);
+        });
+        for (const Shortcut& shortcut : merged) {
+            graph.addArc(shortcut.from, shortcut.to, shortcut.weight, shortcut.middle);
+            dirty[shortcut.from] = 1;
+            dirty[shortcut.to] = 1;
+        }
+
+        // Only the neighbours of contracted cells changed priority
+        remaining.erase(std::remove_if(remaining.begin(), remaining.end(), [&](int v) { return graph.contracted[v] != 0; }),
+                        remaining.end());
+        std::vector<int> stale;
+        for (int v : remaining) {
+            if (dirty[v]) {
+                stale.push_back(v);
+                dirty[v] = 0;
+            }
+        }
+        parallelFor(threadCount, stale.size(), [&](int thread, std::size_t i) {
+            updatePriority(thread, stale[i]);
+        });
+    }
+
+    // Renumber by rank and lay the edges out flat
+    cellNodes.assign(grid.getSize(), -1);
+    nodeCells.assign(nodes, 0);
+    for (int v = 0; v < nodes; ++v) {
+        cellNodes[cells[v]] = rank[v];
+        nodeCells[rank[v]] = cells[v];
+    }
+    std::vector<int> byRank(nodes);
+    for (int v = 0; v < nodes; ++v) {
+        byRank[rank[v]] = v;
+    }
+    auto flatten = [&](const std::vector<std::vector<Arc>>& arcs, std::vector<int>& offsets, std::vector<Edge>& edges) {
+        offsets.assign(1, 0);
+        for (int node = 0; node < nodes; ++node) {
+            for (const Arc& arc : arcs[byRank[node]]) {
+                edges.push_back({rank[arc.node], arc.weight, arc.middle < 0 ? -1 : rank[arc.middle]});
+                shortcutCount += arc.middle >= 0;
+            }
+            offsets.push_back(static_cast<int>(edges.size()));
+        }
+    };
+    flatten(forward, forwardOffsets, forwardEdges);
+    flatten(backward, backwardOffsets, backwardEdges);
+    built = true;
+}
+
+int ContractionHierarchy::middleOf(int from, int to) const {
+    // An edge is kept by its lower end: forward from `from` if that is the
+    // lower, otherwise backward into `to`
+    if (from < to) {
+        for (const Edge* edge = forwardBegin(from); edge != forwardEnd(from); ++edge) {
+            if (edge->node == to) {
+                return edge->middle;
+            }
+        }
+    } else {
+        for (const Edge* edge = backwardBegin(to); edge != backwardEnd(to); ++edge) {
+            if (edge->node == from) {
+                return edge->middle;
+            }
+        }
+    }
+    return -1;
+}
+
+void ContractionHierarchy::unpackEdge(int from, int to, std::vector<int>& pending, std::vector<int>& nodes) const {
+    // Pairs still to unpack, the next one on top
+    pending.clear();
+    pending.push_back(from);
+    pending.push_back(to);
+    while (!pending.empty()) {
+        int last = pending.back();
+        pending.pop_back();
+        int first = pending.back();
+        pending.pop_back();
+        int middle = middleOf(first, last);
+        if (middle < 0) {
+            nodes.push_back(last);
+        } else {
+            pending.push_back(middle);
+            pending.push_back(last);
+            pending.push_back(first);
+            pending.push_back(middle);
+        }
+    }
+}
+
+std::uint64_t ContractionHierarchy::fingerprint(const Grid& grid) {
+    // FNV-1a over the size, the walls and the terrain
+    std::uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&](std::uint64_t value) {
+        hash ^= value;
+        hash *= 1099511628211ULL;
+    };
+    mix(static_cast<std::uint64_t>(grid.getRows()));
+    mix(static_cast<std::uint64_t>(grid.getCols()));
+    for (int y = 0; y < grid.getRows(); ++y) {
+        for (int x = 0; x < grid.getCols(); ++x) {
+            mix(grid.isWall(x, y) ? 0 : static_cast<std::uint64_t>(grid.cost(x, y)));
+        }
+    }
+    return hash;
+}
+
+namespace {
+    template <typename T>
+    void writeValue(std::ostream& out, const T& value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    void writeArray(std::ostream& out, const std::vector<T>& values) {
+        writeValue(out, static_cast<std::uint64_t>(values.size()));
+        out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+    }
+
+    template <typename T>
+    bool readValue(std::istream& in, T& value) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+
+    template <typename T>
+    bool readArray(std::istream& in, std::vector<T>& values, std::uint64_t limit) {
+        std::uint64_t size = 0;
+        if (!readValue(in, size) || size > limit) {
+            return false;
+        }
+        values.resize(static_cast<std::size_t>(size));
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(values.data()),
+                                         static_cast<std::streamsize>(size * sizeof(T))));
+    }
+}
+
+bool ContractionHierarchy::save(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::binary);
+    if (!built || !file) {
+        std::cerr << "Failed to write contraction hierarchy " << filename << std::endl;
+        return false;
+    }
+
+    // Raw arrays in the host's byte order, behind a header naming the map
+    file.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+    writeValue(file, FILE_VERSION);
+    writeValue(file, static_cast<std::int32_t>(rows));
+    writeValue(file, static_cast<std::int32_t>(cols));
+    writeValue(file, mapFingerprint);
+    writeValue(file, static_cast<std::int32_t>(shortcutCount));
+    writeArray(file, nodeCells);
+    writeArray(file, forwardOffsets);
+    writeArray(file, forwardEdges);
+    writeArray(file, backwardOffsets);
+    writeArray(file, backwardEdges);
+    return static_cast<bool>(file);
+}
+
+bool ContractionHierarchy::load(const std::string& filename, const Grid& grid) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to open contraction hierarchy " << filename << std::endl;
+        return false;
+    }
+
+    char magic[sizeof(FILE_MAGIC)];
+    std::uint32_t version = 0;
+    std::int32_t fileRows = 0;
+    std::int32_t fileCols = 0;
+    std::uint64_t fileFingerprint = 0;
+    std::int32_t fileShortcuts = 0;
+    if (!file.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), FILE_MAGIC) ||
+        !readValue(file, version) || version != FILE_VERSION) {
+        std::cerr << "Not a contraction hierarchy: " << filename << std::endl;
+        return false;
+    }
+    if (!readValue(file, fileRows) || !readValue(file, fileCols) || !readValue(file, fileFingerprint) ||
+        !readValue(file, fileShortcuts)) {
+        std::cerr << "Truncated contraction hierarchy " << filename << std::endl;
+        return false;
+    }
+    if (fileRows != grid.getRows() || fileCols != grid.getCols() || fileFingerprint != fingerprint(grid)) {
+        std::cerr << "Contraction hierarchy " << filename << " was built for a different map" << std::endl;
+        return false;
+    }
+
+    ContractionHierarchy loaded;
+    std::uint64_t cellLimit = static_cast<std::uint64_t>(grid.getSize()) + 1;
+    std::uint64_t edgeLimit = 1ULL << 34;
+    if (!readArray(file, loaded.nodeCells, cellLimit) ||
+        !readArray(file, loaded.forwardOffsets, cellLimit) || !readArray(file, loaded.forwardEdges, edgeLimit) ||
+        !readArray(file, loaded.backwardOffsets, cellLimit) || !readArray(file, loaded.backwardEdges, edgeLimit)) {
+        std::cerr << "Truncated contraction hierarchy " << filename << std::endl;
+        return false;
+    }
+
+    // Check the layout before trusting any index in it
+    std::size_t nodes = loaded.nodeCells.size();
+    bool valid = loaded.forwardOffsets.size() == nodes + 1 && loaded.backwardOffsets.size() == nodes + 1 &&
+                 loaded.forwardOffsets.back() == static_cast<int>(loaded.forwardEdges.size()) &&
+                 loaded.backwardOffsets.back() == static_cast<int>(loaded.backwardEdges.size());
+    loaded.cellNodes.assign(grid.getSize(), -1);
+    for (std::size_t node = 0; valid && node < nodes; ++node) {
+        int cell = loaded.nodeCells[node];
+        valid = cell >= 0 && cell < grid.getSize() && loaded.cellNodes[cell] == -1 &&
+                loaded.forwardOffsets[node] <= loaded.forwardOffsets[node + 1] &&
+                loaded.backwardOffsets[node] <= loaded.backwardOffsets[node + 1];
+        if (valid) {
+            loaded.cellNodes[cell] = static_cast<int>(node);
+        }
+    }
+    auto validEdges = [&](const std::vector<Edge>& edges) {
+        for (const Edge& edge : edges) {
+            if (edge.node < 0 || edge.node >= static_cast<int>(nodes) || edge.middle >= static_cast<int>(nodes)) {
+                return false;
+            }
+        }
+        return true;
+    };
+    if (!valid || !validEdges(loaded.forwardEdges) || !validEdges(loaded.backwardEdges)) {
+        std::cerr << "Corrupt contraction hierarchy " << filename << std::endl;
+        return false;
+    }
+
+    loaded.shortcutCount = fileShortcuts;
+    loaded.rows = fileRows;
+    loaded.cols = fileCols;
+    loaded.mapFingerprint = fileFingerprint;
+    loaded.revision = grid.getRevision();
+    loaded.built = true;
+    *this = std::move(loaded);
+    return true;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Grid.h"
+
+// Contraction hierarchy over the free cells of a 4-connected grid, for maps
+// that stay fixed over very many queries.
+//
+// Cells are contracted one by one, least important first: a contracted
+// cell leaves the graph, and wherever the only shortest route between two
+// of its neighbours ran through it, a shortcut edge of the same cost joins
+// them. Every cell ends up with a rank, and a query searches upwards only,
+// forward from the start and backward from the goal, meeting at the
+// highest cell of the shortest path; it settles a few hundred cells where
+// Dijkstra would settle the whole map. Each shortcut remembers the cell it
+// bypasses, so paths unpack back into unit steps.
+//
+// Steps pay the cost of the cell entered, so the graph is directed: a cell
+// keeps its edges to higher cells (forward) and from higher cells
+// (backward) separately.
+//
+// Construction contracts whole independent sets of cells at a time, cells
+// that are the least important within two steps of themselves, so their
+// witness searches and shortcuts can be worked out on several threads.
+// Which cells share a round depends only on the map, never on the thread
+// count, so the hierarchy is the same whichever count built it.
+//
+// The hierarchy can be saved and loaded. Files record a fingerprint of the
+// walls and terrain, and load() refuses a file built for another map.
+// Errors are reported on std::cerr, as with MapLoader.
+class ContractionHierarchy {
+public:
+    // An edge to or from a higher cell. middle is the cell a shortcut
+    // bypasses, or -1 for a step between neighbouring cells.
+    struct Edge {
+        int node;
+        int weight;
+        int middle;
+    };
+
+    ContractionHierarchy();
+
+    // threadCount 0 uses one thread per hardware thread
+    void build(const Grid& grid, int threadCount = 0);
+    void clear();
+    bool isBuilt() const { return built; }
+    bool isCurrent(const Grid& grid) const { return built && revision == grid.getRevision(); }
+
+    bool save(const std::string& filename) const;
+    bool load(const std::string& filename, const Grid& grid);
+
+    // Nodes are numbered by rank, so a higher number is a higher cell
+    int getNodeCount() const { return static_cast<int>(nodeCells.size()); }
+    int getShortcutCount() const { return shortcutCount; }
+    int nodeOf(int index) const { return cellNodes[index]; }
+    int cellOf(int node) const { return nodeCells[node]; }
+
+    const Edge* forwardBegin(int node) const { return &forwardEdges[forwardOffsets[node]]; }
+    const Edge* forwardEnd(int node) const { return &forwardEdges[forwardOffsets[node + 1]]; }
+    const Edge* backwardBegin(int node) const { return &backwardEdges[backwardOffsets[node]]; }
+    const Edge* backwardEnd(int node) const { return &backwardEdges[backwardOffsets[node + 1]]; }
+
+    // Appends the nodes the edge from -> to stands for, after `from` and up
+    // to and including `to`. `pending` is scratch space.
+    void unpackEdge(int from, int to, std::vector<int>& pending, std::vector<int>& nodes) const;
+
+private:
+    int middleOf(int from, int to) const;
+    static std::uint64_t fingerprint(const Grid& grid);
+
+    std::vector<int> cellNodes;
+    std::vector<int> nodeCells;
+    std::vector<int> forwardOffsets;
+    std::vector<Edge> forwardEdges;
+    std::vector<int> backwardOffsets;
+    std::vector<Edge> backwardEdges;
+    int shortcutCount;
+    int rows;
+    int cols;
+    std::uint64_t mapFingerprint;
+    std::uint64_t revision;
+    bool built;
+};
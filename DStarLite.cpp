@@ -0,0 +1,298 @@
+#include "DStarLite.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include "Constants.h"
+
+// Unreachable; small enough that adding a step cost cannot overflow
+static const int INFINITE_COST = INT_MAX / 2;
+
+static const int STEPS[4][2] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}};
+
+DStarLite::DStarLite()
+    : startCell(-1, -1), goalCell(-1, -1), lastStart(-1, -1), km(0), initialized(false),
+      pushes(0), updates(0), peakQueue(0) {}
+
+void DStarLite::clear() {
+    g.clear();
+    rhs.clear();
+    queue.clear();
+    position.clear();
+    initialized = false;
+}
+
+void DStarLite::initialize(const Grid& grid, sf::Vector2i start, sf::Vector2i goal) {
+    std::size_t cells = static_cast<std::size_t>(grid.getSize());
+    g.assign(cells, INFINITE_COST);
+    rhs.assign(cells, INFINITE_COST);
+    position.assign(cells, -1);
+    queue.clear();
+
+    startCell = start;
+    goalCell = goal;
+    lastStart = start;
+    km = 0;
+    pushes = 0;
+    updates = 0;
+    peakQueue = 0;
+
+    int goalIndex = grid.index(goal.x, goal.y);
+    rhs[goalIndex] = 0;
+    queuePush(goalIndex, calculateKey(grid, goalIndex));
+    initialized = true;
+}
+
+DStarLite::Key DStarLite::calculateKey(const Grid& grid, int index) const {
+    // Manhattan distance is a lower bound because every step costs at least
+    // MIN_TERRAIN_COST
+    int best = std::min(g[index], rhs[index]);
+    int h = (std::abs(grid.indexX(index) - startCell.x) + std::abs(grid.indexY(index) - startCell.y)) *
+            Constants::MIN_TERRAIN_COST;
+    return {best + h + km, best};
+}
+
+int DStarLite::stepCost(const Grid& grid, int from, int to) const {
+    if (grid.isWall(grid.indexX(from), grid.indexY(from)) || grid.isWall(grid.indexX(to), grid.indexY(to))) {
+        return INFINITE_COST;
+    }
+    return grid.cost(grid.indexX(to), grid.indexY(to));
+}
+
+int DStarLite::lookahead(const Grid& grid, int index) const {
+    int x = grid.indexX(index);
+    int y = grid.indexY(index);
+    if (grid.isWall(x, y)) {
+        return INFINITE_COST;
+    }
+
+    int best = INFINITE_COST;
+    for (auto& step : STEPS) {
+        int newX = x + step[0];
+        int newY = y + step[1];
+        if (!grid.isValidCell(newX, newY)) {
+            continue;
+        }
+        int next = grid.index(newX, newY);
+        int cost = stepCost(grid, index, next);
+        if (cost != INFINITE_COST && g[next] != INFINITE_COST) {
+            best = std::min(best, cost + g[next]);
+        }
+    }
+    return best;
+}
+
+void DStarLite::updateVertex(const Grid& grid, int index) {
+    if (g[index] != rhs[index]) {
+        if (position[index] == -1) {
+            queuePush(index, calculateKey(grid, index));
+        } else {
+            queueUpdate(index, calculateKey(grid, index));
+        }
+    } else if (position[index] != -1) {
+        queueRemove(index);
+    }
+}
+
+void DStarLite::updateCell(const Grid& grid, int x, int y) {
+    if (!initialized || !grid.isValidCell(x, y)) {
+        return;
+    }
+
+    // The cell's own outgoing edges and the edges into it from each
+    // neighbour are the only ones that changed
+    int goal = grid.index(goalCell.x, goalCell.y);
+    int cell = grid.index(x, y);
+    if (cell != goal) {
+        rhs[cell] = lookahead(grid, cell);
+        updateVertex(grid, cell);
+    }
+    for (auto& step : STEPS) {
+        int newX = x + step[0];
+        int newY = y + step[1];
+        int neighbor = grid.index(newX, newY);
+        if (grid.isValidCell(newX, newY) && neighbor != goal) {
+            rhs[neighbor] = lookahead(grid, neighbor);
+            updateVertex(grid, neighbor);
+        }
+    }
+}
+
+void DStarLite::moveStart(sf::Vector2i cell) {
+    // Keys already queued were computed against the old start; raising km
+    // by how far the start moved keeps them comparable to new ones
+    km += (std::abs(cell.x - lastStart.x) + std::abs(cell.y - lastStart.y)) * Constants::MIN_TERRAIN_COST;
+    lastStart = cell;
+    startCell = cell;
+}
+
+int DStarLite::computeShortestPath(const Grid& grid) {
+    int start = grid.index(startCell.x, startCell.y);
+    int goal = grid.index(goalCell.x, goalCell.y);
+    int expanded = 0;
+
+    while (!queue.empty() && (queue[0].key < calculateKey(grid, start) || rhs[start] > g[start])) {
+        int current = queue[0].index;
+        Key oldKey = queue[0].key;
+        Key newKey = calculateKey(grid, current);
+        ++expanded;
+
+        if (oldKey < newKey) {
+            // Queued before the start moved; its key is stale
+            queueUpdate(current, newKey);
+            continue;
+        }
+
+        if (g[current] > rhs[current]) {
+            // Overconsistent: the cost went down, so settle it
+            g[current] = rhs[current];
+            queueRemove(current);
+        } else {
+            // Underconsistent: the cost went up, so forget it and let the
+            // lookahead find the next best way out
+            g[current] = INFINITE_COST;
+            if (current != goal) {
+                rhs[current] = lookahead(grid, current);
+            }
+            updateVertex(grid, current);
+        }
+
+        int x = grid.indexX(current);
+        int y = grid.indexY(current);
+        for (auto& step : STEPS) {
+            int newX = x + step[0];
+            int newY = y + step[1];
+            int neighbor = grid.index(newX, newY);
+            if (grid.isValidCell(newX, newY) && neighbor != goal) {
+                rhs[neighbor] = lookahead(grid, neighbor);
+                updateVertex(grid, neighbor);
+            }
+        }
+    }
+    return expanded;
+}
+
+bool DStarLite::replan(const Grid& grid, std::vector<sf::Vector2i>& path, SearchStats* stats) {
+    SearchStats::Scope scope(stats, nullptr, &grid, &path);
+    path.clear();
+    if (!initialized) {
+        return false;
+    }
+
+    int expanded = computeShortestPath(grid);
+    if (stats) stats->nodesExpanded = expanded;
+    if (SearchStats::ENABLED && stats) {
+        stats->nodesGenerated = pushes;
+        stats->duplicatePushes = updates;
+        stats->peakOpen = peakQueue;
+    }
+    pushes = 0;
+    updates = 0;
+    peakQueue = static_cast<long long>(queue.size());
+
+    int current = grid.index(startCell.x, startCell.y);
+    int goal = grid.index(goalCell.x, goalCell.y);
+    if (g[current] == INFINITE_COST && rhs[current] == INFINITE_COST) {
+        return false;
+    }
+
+    // With the start consistent, the cheapest step plus g leads down an
+    // optimal path; the step limit only guards against a corrupted state
+    path.push_back(startCell);
+    for (int steps = 0; current != goal && steps < grid.getSize(); ++steps) {
+        int best = -1;
+        int bestCost = INFINITE_COST;
+        for (auto& step : STEPS) {
+            int newX = grid.indexX(current) + step[0];
+            int newY = grid.indexY(current) + step[1];
+            if (!grid.isValidCell(newX, newY)) {
+                continue;
+            }
+            int next = grid.index(newX, newY);
+            int cost = stepCost(grid, current, next);
+            if (cost != INFINITE_COST && g[next] != INFINITE_COST && cost + g[next] < bestCost) {
+                best = next;
+                bestCost = cost + g[next];
+            }
+        }
+        if (best == -1) {
+            path.clear();
+            return false;
+        }
+        current = best;
+        path.push_back({grid.indexX(current), grid.indexY(current)});
+    }
+    if (current != goal) {
+        path.clear();
+        return false;
+    }
+    return true;
+}
+
+void DStarLite::place(int slot, const QueueEntry& entry) {
+    queue[slot] = entry;
+    position[entry.index] = slot;
+}
+
+void DStarLite::siftUp(int slot) {
+    QueueEntry entry = queue[slot];
+    while (slot > 0) {
+        int parent = (slot - 1) / 2;
+        if (!(entry.key < queue[parent].key)) {
+            break;
+        }
+        place(slot, queue[parent]);
+        slot = parent;
+    }
+    place(slot, entry);
+}
+
+void DStarLite::siftDown(int slot) {
+    QueueEntry entry = queue[slot];
+    int size = static_cast<int>(queue.size());
+    for (;;) {
+        int child = 2 * slot + 1;
+        if (child >= size) {
+            break;
+        }
+        if (child + 1 < size && queue[child + 1].key < queue[child].key) {
+            ++child;
+        }
+        if (!(queue[child].key < entry.key)) {
+            break;
+        }
+        place(slot, queue[child]);
+        slot = child;
+    }
+    place(slot, entry);
+}
+
+void DStarLite::queuePush(int index, Key key) {
+    queue.push_back({index, key});
+    siftUp(static_cast<int>(queue.size()) - 1);
+    if (SearchStats::ENABLED) {
+        ++pushes;
+        peakQueue = std::max(peakQueue, static_cast<long long>(queue.size()));
+    }
+}
+
+void DStarLite::queueUpdate(int index, Key key) {
+    if (SearchStats::ENABLED) {
+        ++updates;
+    }
+    int slot = position[index];
+    queue[slot].key = key;
+    siftUp(slot);
+    siftDown(position[index]);
+}
+
+void DStarLite::queueRemove(int index) {
+    int slot = position[index];
+    position[index] = -1;
+    QueueEntry last = queue.back();
+    queue.pop_back();
+    if (slot < static_cast<int>(queue.size())) {
+        place(slot, last);
+        siftUp(slot);
+        siftDown(position[last.index]);
+    }
+}
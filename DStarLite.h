@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+#include <SFML/System/Vector2.hpp>
+#include "Grid.h"
+#include "SearchStats.h"
+
+// Incremental planner that keeps its search state between map edits.
+//
+// D* Lite searches backwards from the goal: g(s) is the best known cost
+// from s to the goal and rhs(s) a one-step lookahead of it. An edit only
+// re-evaluates the rhs of the cells whose edges changed, and replanning
+// repairs just the cells left inconsistent (g != rhs) instead of searching
+// the whole map again. With a fixed start this is LPA* run from the goal;
+// moveStart lets the start follow a moving agent, shifting the queue keys
+// by km instead of reordering the queue.
+//
+// The planner reads the grid passed to each call and must be told about
+// every wall or terrain change through updateCell.
+class DStarLite {
+public:
+    DStarLite();
+
+    // Starts planning from scratch for a new start/goal pair
+    void initialize(const Grid& grid, sf::Vector2i startCell, sf::Vector2i goalCell);
+    void clear();
+    bool isInitialized() const { return initialized; }
+
+    // Call after changing the wall or terrain cost of (x, y)
+    void updateCell(const Grid& grid, int x, int y);
+
+    // The agent moved to `cell`; the next replan continues from there
+    void moveStart(sf::Vector2i cell);
+
+    // Repairs the inconsistent cells until the start's cost is exact, then
+    // follows the cheapest successors to the goal. stats->nodesExpanded
+    // counts only the cells this replan touched; the queue counters also
+    // take in what the edits since the last replan queued.
+    bool replan(const Grid& grid, std::vector<sf::Vector2i>& path, SearchStats* stats = nullptr);
+
+    sf::Vector2i getStart() const { return startCell; }
+    sf::Vector2i getGoal() const { return goalCell; }
+
+private:
+    struct Key {
+        int primary;
+        int secondary;
+        bool operator<(const Key& other) const {
+            return primary != other.primary ? primary < other.primary : secondary < other.secondary;
+        }
+    };
+
+    struct QueueEntry {
+        int index;
+        Key key;
+    };
+
+    Key calculateKey(const Grid& grid, int index) const;
+    int stepCost(const Grid& grid, int from, int to) const;
+    int lookahead(const Grid& grid, int index) const;
+    void updateVertex(const Grid& grid, int index);
+    int computeShortestPath(const Grid& grid);
+
+    // Binary heap with a position table, so entries can be re-keyed or
+    // removed in O(log n)
+    void queuePush(int index, Key key);
+    void queueUpdate(int index, Key key);
+    void queueRemove(int index);
+    void siftUp(int slot);
+    void siftDown(int slot);
+    void place(int slot, const QueueEntry& entry);
+
+    std::vector<int> g;
+    std::vector<int> rhs;
+    std::vector<QueueEntry> queue;
+    std::vector<int> position;
+    sf::Vector2i startCell;
+    sf::Vector2i goalCell;
+    sf::Vector2i lastStart;
+    int km;
+    bool initialized;
+
+    // Queue traffic since initialize() or the last replan, for SearchStats
+    long long pushes;
+    long long updates;
+    long long peakQueue;
+};
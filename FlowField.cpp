@@ -0,0 +1,169 @@
+#include "FlowField.h"
+
+const int FlowField::UNREACHABLE;
+const std::uint8_t FlowField::NO_DIRECTION;
+
+static const int STEPS[4][2] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}};
+
+// Direction from a neighbour back to the cell it was reached from
+static const std::uint8_t OPPOSITE[4] = {2, 3, 0, 1};
+
+FlowField::FlowField() : goalCell(-1, -1), revision(0), built(false) {}
+
+void FlowField::clear() {
+    distances.clear();
+    directions.clear();
+    invalidated.clear();
+    built = false;
+}
+
+sf::Vector2i FlowField::offset(int direction) {
+    return {STEPS[direction][0], STEPS[direction][1]};
+}
+
+void FlowField::build(const Grid& grid, sf::Vector2i goal, SearchStats* stats) {
+    SearchStats::Scope scope(stats, &workspace, &grid, nullptr);
+    distances.assign(grid.getSize(), UNREACHABLE);
+    directions.assign(grid.getSize(), NO_DIRECTION);
+    goalCell = goal;
+    revision = grid.getRevision();
+    built = true;
+
+    int expanded = 0;
+    if (grid.isWalkable(goal.x, goal.y)) {
+        int index = grid.index(goal.x, goal.y);
+        distances[index] = 0;
+        workspace.pushHeap({index, 0, 0});
+        expanded = propagate(grid);
+    }
+    if (stats) stats->nodesExpanded = expanded;
+}
+
+int FlowField::propagate(const Grid& grid) {
+    int expanded = 0;
+    while (!workspace.heapEmpty()) {
+        SearchWorkspace::HeapNode current = workspace.popHeap();
+        if (current.cost > distances[current.index]) {
+            continue;
+        }
+        ++expanded;
+
+        // Any neighbour can step into this cell by paying its cost
+        int x = grid.indexX(current.index);
+        int y = grid.indexY(current.index);
+        int cost = current.cost + grid.cost(x, y);
+        for (int d = 0; d < 4; ++d) {
+            int newX = x + STEPS[d][0];
+            int newY = y + STEPS[d][1];
+            if (!grid.isWalkable(newX, newY)) {
+                continue;
+            }
+            int neighbor = grid.index(newX, newY);
+            if (cost < distances[neighbor]) {
+                if (distances[neighbor] != UNREACHABLE) {
+                    workspace.countDuplicate();
+                }
+                distances[neighbor] = cost;
+                directions[neighbor] = OPPOSITE[d];
+                workspace.pushHeap({neighbor, cost, cost});
+            }
+        }
+    }
+    return expanded;
+}
+
+void FlowField::settleFromNeighbours(const Grid& grid, int index) {
+    int x = grid.indexX(index);
+    int y = grid.indexY(index);
+    for (int d = 0; d < 4; ++d) {
+        int newX = x + STEPS[d][0];
+        int newY = y + STEPS[d][1];
+        if (!grid.isWalkable(newX, newY)) {
+            continue;
+        }
+        int neighbor = grid.index(newX, newY);
+        if (distances[neighbor] != UNREACHABLE && distances[neighbor] + grid.cost(newX, newY) < distances[index]) {
+            distances[index] = distances[neighbor] + grid.cost(newX, newY);
+            directions[index] = static_cast<std::uint8_t>(d);
+        }
+    }
+    if (distances[index] != UNREACHABLE) {
+        workspace.pushHeap({index, distances[index], distances[index]});
+    }
+}
+
+void FlowField::updateCell(const Grid& grid, int x, int y, SearchStats* stats) {
+    if (!built || !grid.isValidCell(x, y)) {
+        return;
+    }
+    revision = grid.getRevision();
+    int cell = grid.index(x, y);
+    SearchStats::Scope scope(stats, &workspace, &grid, nullptr);
+
+    // Every cell whose branch of the tree runs through the edited cell may
+    // have got more expensive; collect them by walking the tree downwards
+    invalidated.clear();
+    invalidated.push_back(cell);
+    for (std::size_t head = 0; head < invalidated.size(); ++head) {
+        int parentX = grid.indexX(invalidated[head]);
+        int parentY = grid.indexY(invalidated[head]);
+        for (int d = 0; d < 4; ++d) {
+            int newX = parentX + STEPS[d][0];
+            int newY = parentY + STEPS[d][1];
+            if (!grid.isValidCell(newX, newY)) {
+                continue;
+            }
+            int child = grid.index(newX, newY);
+            if (directions[child] == OPPOSITE[d]) {
+                distances[child] = UNREACHABLE;
+                directions[child] = NO_DIRECTION;
+                invalidated.push_back(child);
+            }
+        }
+    }
+
+    // The edited cell itself, then the reset cells from whatever neighbours
+    // kept their distances; relaxing from there also carries any decrease
+    // outwards to the rest of the field
+    distances[cell] = UNREACHABLE;
+    directions[cell] = NO_DIRECTION;
+    if (cell == grid.index(goalCell.x, goalCell.y)) {
+        if (!grid.isWall(x, y)) {
+            distances[cell] = 0;
+            workspace.pushHeap({cell, 0, 0});
+        }
+    } else if (!grid.isWall(x, y)) {
+        settleFromNeighbours(grid, cell);
+    }
+    for (std::size_t i = 1; i < invalidated.size(); ++i) {
+        settleFromNeighbours(grid, invalidated[i]);
+    }
+
+    int expanded = propagate(grid);
+    if (stats) stats->nodesExpanded = expanded;
+}
+
+bool FlowField::followPath(const Grid& grid, sf::Vector2i start, std::vector<sf::Vector2i>& path) const {
+    path.clear();
+    if (!built || !grid.isValidCell(start.x, start.y) || distances[grid.index(start.x, start.y)] == UNREACHABLE) {
+        return false;
+    }
+
+    // The step limit only guards against a field that is out of date
+    sf::Vector2i current = start;
+    path.push_back(current);
+    for (int steps = 0; current != goalCell && steps < grid.getSize(); ++steps) {
+        int direction = directions[grid.index(current.x, current.y)];
+        if (direction == NO_DIRECTION) {
+            break;
+        }
+        current.x += STEPS[direction][0];
+        current.y += STEPS[direction][1];
+        path.push_back(current);
+    }
+    if (current != goalCell) {
+        path.clear();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <climits>
+#include <cstdint>
+#include <vector>
+#include <SFML/System/Vector2.hpp>
+#include "Grid.h"
+#include "SearchStats.h"
+#include "SearchWorkspace.h"
+
+// Distances to one goal from every cell, plus the step each cell should
+// take, so any number of agents heading for the same goal can walk there in
+// O(path length) without searching.
+//
+// The integration field is a single Dijkstra run backwards from the goal;
+// distance(i) is the terrain cost of the cheapest path from cell i. Each
+// cell's direction points at the neighbour that path goes through, so the
+// directions form a tree rooted at the goal.
+//
+// updateCell patches the field after an edit: the cells whose tree branch
+// ran through the edited cell are reset and re-seeded from their neighbours
+// outside it, and cells that got cheaper are relaxed outwards. Everything
+// else keeps its distance and direction.
+class FlowField {
+public:
+    static const int UNREACHABLE = INT_MAX;
+    static const std::uint8_t NO_DIRECTION = 255;
+
+    FlowField();
+
+    void build(const Grid& grid, sf::Vector2i goalCell, SearchStats* stats = nullptr);
+    void clear();
+    bool isBuilt() const { return built; }
+
+    // True if the field was built or patched for exactly this grid revision
+    // and goal
+    bool isCurrent(const Grid& grid, sf::Vector2i goal) const {
+        return built && goal == goalCell && revision == grid.getRevision();
+    }
+
+    // Call after changing the wall or terrain cost of (x, y).
+    // stats->nodesExpanded counts the cells the patch settled.
+    void updateCell(const Grid& grid, int x, int y, SearchStats* stats = nullptr);
+
+    int distance(int index) const { return distances[index]; }
+
+    // Index into offset() of the step to take from a cell, or NO_DIRECTION
+    // at the goal and wherever the goal cannot be reached
+    int direction(int index) const { return directions[index]; }
+    static sf::Vector2i offset(int direction);
+
+    sf::Vector2i getGoal() const { return goalCell; }
+
+    // Follows the directions from start; false if the goal is unreachable
+    bool followPath(const Grid& grid, sf::Vector2i start, std::vector<sf::Vector2i>& path) const;
+
+private:
+    void settleFromNeighbours(const Grid& grid, int index);
+    int propagate(const Grid& grid);
+
+    std::vector<int> distances;
+    std::vector<std::uint8_t> directions;
+    std::vector<int> invalidated;
+    SearchWorkspace workspace;
+    sf::Vector2i goalCell;
+    std::uint64_t revision;
+    bool built;
+};
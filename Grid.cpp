@@ -0,0 +1,35 @@
+#include "Grid.h"
+#include <algorithm>
+
+std::atomic<std::uint64_t> Grid::nextRevision(0);
+
+Grid::Grid() : rows(0), cols(0), stride(0), revision(0) {}
+
+Grid::Grid(int rows, int cols, Cell fill) : rows(0), cols(0), stride(0), revision(0) {
+    resize(rows, cols, fill);
+}
+
+void Grid::resize(int newRows, int newCols, Cell value) {
+    rows = std::max(newRows, 0);
+    cols = std::max(newCols, 0);
+    stride = cols;
+    cells.assign(static_cast<std::size_t>(rows) * stride, value);
+    costs.assign(static_cast<std::size_t>(rows) * stride, Constants::MIN_TERRAIN_COST);
+    touch();
+}
+
+void Grid::fill(Cell value) {
+    std::fill(cells.begin(), cells.end(), value);
+    touch();
+}
+
+void Grid::fillCosts(int cost) {
+    std::fill(costs.begin(), costs.end(), static_cast<std::uint8_t>(cost));
+    touch();
+}
+
+bool Grid::hasUniformCost() const {
+    return std::all_of(costs.begin(), costs.end(), [](std::uint8_t cost) {
+        return cost == Constants::MIN_TERRAIN_COST;
+    });
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Constants.h"
+
+// Runtime-sized map stored as one flat row-major buffer. Cell (x, y) lives at
+// y * stride + x, so a whole row is contiguous in memory and the algorithms
+// can walk it with plain index arithmetic instead of nested vectors.
+//
+// A second plane of the same layout holds the terrain cost of stepping into
+// each cell, from Constants::MIN_TERRAIN_COST to MAX_TERRAIN_COST. The
+// uniform-cost algorithms (DFS, BFS, JPS) ignore it.
+//
+// Every mutation stamps the grid with a new revision. Revisions come from
+// one process-wide counter, so two grids with the same revision hold the
+// same contents (one is a copy of the other) and a result computed for a
+// revision stays valid until the revision changes.
+class Grid {
+public:
+    typedef std::uint8_t Cell;
+
+    Grid();
+    Grid(int rows, int cols, Cell fill = Constants::EMPTY);
+
+    void resize(int rows, int cols, Cell fill = Constants::EMPTY);
+    void fill(Cell value);
+    void fillCosts(int cost);
+
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+    int getStride() const { return stride; }
+    int getSize() const { return rows * stride; }
+    std::uint64_t getRevision() const { return revision; }
+
+    int index(int x, int y) const { return y * stride + x; }
+    int indexX(int index) const { return index % stride; }
+    int indexY(int index) const { return index / stride; }
+
+    bool isValidCell(int x, int y) const {
+        return x >= 0 && x < cols && y >= 0 && y < rows;
+    }
+
+    Cell at(int x, int y) const { return cells[index(x, y)]; }
+    void set(int x, int y, Cell value) {
+        cells[index(x, y)] = value;
+        touch();
+    }
+
+    int cost(int x, int y) const { return costs[index(x, y)]; }
+    void setCost(int x, int y, int value) {
+        costs[index(x, y)] = static_cast<std::uint8_t>(value);
+        touch();
+    }
+    bool hasUniformCost() const;
+
+    bool isWall(int x, int y) const { return cells[index(x, y)] == Constants::WALL; }
+    bool isWalkable(int x, int y) const { return isValidCell(x, y) && !isWall(x, y); }
+
+    const Cell* data() const { return cells.data(); }
+    const Cell* row(int y) const { return cells.data() + y * stride; }
+
+private:
+    void touch() { revision = nextRevision.fetch_add(1, std::memory_order_relaxed) + 1; }
+
+    static std::atomic<std::uint64_t> nextRevision;
+
+    int rows;
+    int cols;
+    int stride;
+    std::vector<Cell> cells;
+    std::vector<std::uint8_t> costs;
+    std::uint64_t revision;
+};
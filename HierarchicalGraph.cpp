@@ -0,0 +1,244 @@
+#include "HierarchicalGraph.h"
+#include <algorithm>
+#include <climits>
+
+// Open stretches along a border shorter than this get one entrance in the
+// middle; longer ones get one at each end, so paths hugging either end of
+// a wide opening are not forced through its centre
+static const int MAX_SINGLE_ENTRANCE = 6;
+
+static const int STEPS[4][2] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}};
+
+HierarchicalGraph::HierarchicalGraph() : clusterSize(0), clustersX(0), clustersY(0), revision(0), built(false) {}
+
+void HierarchicalGraph::clear() {
+    clusters.clear();
+    clusterLinks.clear();
+    rightBorders.clear();
+    bottomBorders.clear();
+    nodeOf.clear();
+    built = false;
+}
+
+void HierarchicalGraph::build(const Grid& grid, int size) {
+    clusterSize = std::max(size, 1);
+    clustersX = (grid.getCols() + clusterSize - 1) / clusterSize;
+    clustersY = (grid.getRows() + clusterSize - 1) / clusterSize;
+    int count = clustersX * clustersY;
+
+    clusters.assign(count, Cluster());
+    clusterLinks.assign(count, std::vector<Link>());
+    rightBorders.assign(count, std::vector<Transition>());
+    bottomBorders.assign(count, std::vector<Transition>());
+    nodeOf.assign(grid.getSize(), -1);
+
+    for (int cy = 0; cy < clustersY; ++cy) {
+        for (int cx = 0; cx < clustersX; ++cx) {
+            Cluster& cluster = clusters[cy * clustersX + cx];
+            cluster.left = cx * clusterSize;
+            cluster.top = cy * clusterSize;
+            cluster.width = std::min(clusterSize, grid.getCols() - cluster.left);
+            cluster.height = std::min(clusterSize, grid.getRows() - cluster.top);
+            buildBorder(grid, cx, cy, true);
+            buildBorder(grid, cx, cy, false);
+        }
+    }
+    for (int id = 0; id < count; ++id) {
+        buildCluster(grid, id);
+    }
+    revision = grid.getRevision();
+    built = true;
+}
+
+void HierarchicalGraph::updateCell(const Grid& grid, int x, int y) {
+    if (!built || !grid.isValidCell(x, y)) {
+        return;
+    }
+    revision = grid.getRevision();
+
+    int cx = x / clusterSize;
+    int cy = y / clusterSize;
+    int touched[3];
+    int count = 0;
+    touched[count++] = cy * clustersX + cx;
+
+    // A cell on a cluster edge can open or close an entrance, which changes
+    // the nodes on both sides of that border. Clusters are at least one
+    // cell wide, so a cell can be on at most one vertical and one
+    // horizontal border.
+    if (x == clusters[touched[0]].left && cx > 0) {
+        buildBorder(grid, cx - 1, cy, true);
+        touched[count++] = touched[0] - 1;
+    } else if (x == clusters[touched[0]].left + clusterSize - 1 && cx + 1 < clustersX) {
+        buildBorder(grid, cx, cy, true);
+        touched[count++] = touched[0] + 1;
+    }
+    if (y == clusters[touched[0]].top && cy > 0) {
+        buildBorder(grid, cx, cy - 1, false);
+        touched[count++] = touched[0] - clustersX;
+    } else if (y == clusters[touched[0]].top + clusterSize - 1 && cy + 1 < clustersY) {
+        buildBorder(grid, cx, cy, false);
+        touched[count++] = touched[0] + clustersX;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        buildCluster(grid, touched[i]);
+    }
+}
+
+void HierarchicalGraph::buildBorder(const Grid& grid, int cx, int cy, bool right) {
+    std::vector<Transition>& transitions = border(cx, cy, right);
+    transitions.clear();
+    if ((right && cx + 1 >= clustersX) || (!right && cy + 1 >= clustersY)) {
+        return;
+    }
+
+    // Walk along the border; (x, y) is in this cluster and (x + dx, y + dy)
+    // in the neighbour
+    const Cluster& cluster = clusters[cy * clustersX + cx];
+    int dx = right ? 1 : 0;
+    int dy = right ? 0 : 1;
+    int length = right ? cluster.height : cluster.width;
+    auto cellAt = [&](int t, int& x, int& y) {
+        x = right ? cluster.left + cluster.width - 1 : cluster.left + t;
+        y = right ? cluster.top + t : cluster.top + cluster.height - 1;
+    };
+    auto isOpen = [&](int t) {
+        int x, y;
+        cellAt(t, x, y);
+        return grid.isWalkable(x, y) && grid.isWalkable(x + dx, y + dy);
+    };
+    auto addTransition = [&](int t) {
+        int x, y;
+        cellAt(t, x, y);
+        transitions.push_back({grid.index(x, y), grid.index(x + dx, y + dy)});
+    };
+
+    int t = 0;
+    while (t < length) {
+        if (!isOpen(t)) {
+            ++t;
+            continue;
+        }
+        int begin = t;
+        while (t < length && isOpen(t)) {
+            ++t;
+        }
+        if (t - begin < MAX_SINGLE_ENTRANCE) {
+            addTransition((begin + t - 1) / 2);
+        } else {
+            addTransition(begin);
+            addTransition(t - 1);
+        }
+    }
+}
+
+void HierarchicalGraph::buildCluster(const Grid& grid, int id) {
+    Cluster& cluster = clusters[id];
+    std::vector<Link>& links = clusterLinks[id];
+    for (int node : cluster.nodes) {
+        nodeOf[node] = -1;
+    }
+    cluster.nodes.clear();
+    links.clear();
+
+    auto addLink = [&](int cell, int partner) {
+        if (nodeOf[cell] == -1) {
+            nodeOf[cell] = static_cast<int>(cluster.nodes.size());
+            cluster.nodes.push_back(cell);
+        }
+        links.push_back({nodeOf[cell], partner});
+    };
+
+    int cx = id % clustersX;
+    int cy = id / clustersX;
+    for (const Transition& transition : border(cx, cy, true)) {
+        addLink(transition.first, transition.second);
+    }
+    for (const Transition& transition : border(cx, cy, false)) {
+        addLink(transition.first, transition.second);
+    }
+    if (cx > 0) {
+        for (const Transition& transition : border(cx - 1, cy, true)) {
+            addLink(transition.second, transition.first);
+        }
+    }
+    if (cy > 0) {
+        for (const Transition& transition : border(cx, cy - 1, false)) {
+            addLink(transition.second, transition.first);
+        }
+    }
+
+    // Reversing a path swaps which endpoint's cost it pays, so
+    // d(j, i) = d(i, j) - cost(j) + cost(i) and one search per node fills
+    // its row and column
+    std::size_t n = cluster.nodes.size();
+    cluster.distances.assign(n * n, INT_MAX);
+    for (std::size_t i = 0; i < n; ++i) {
+        int from = cluster.nodes[i];
+        cluster.distances[i * n + i] = 0;
+        if (i + 1 == n) {
+            break;
+        }
+        clusterDijkstra(grid, id, from, false, buildWorkspace, buildDistance, nullptr);
+        for (std::size_t j = i + 1; j < n; ++j) {
+            int to = cluster.nodes[j];
+            int d = buildDistance[localIndex(cluster, grid.indexX(to), grid.indexY(to))];
+            if (d != INT_MAX) {
+                cluster.distances[i * n + j] = d;
+                cluster.distances[j * n + i] = d - grid.cost(grid.indexX(to), grid.indexY(to)) +
+                                               grid.cost(grid.indexX(from), grid.indexY(from));
+            }
+        }
+    }
+}
+
+int HierarchicalGraph::clusterDijkstra(const Grid& grid, int id, int source, bool reverse,
+                                       SearchWorkspace& workspace,
+                                       std::vector<int>& distance, std::vector<int>* parent) const {
+    const Cluster& cluster = clusters[id];
+    distance.assign(static_cast<std::size_t>(cluster.width) * cluster.height, INT_MAX);
+    if (parent) {
+        parent->assign(distance.size(), -1);
+    }
+
+    // Heap side 1 is free here: the abstract search only uses side 0
+    int sourceX = grid.indexX(source);
+    int sourceY = grid.indexY(source);
+    distance[localIndex(cluster, sourceX, sourceY)] = 0;
+    workspace.pushHeap({source, 0, 0}, 1);
+    int expanded = 0;
+
+    while (!workspace.heapEmpty(1)) {
+        SearchWorkspace::HeapNode current = workspace.popHeap(1);
+        int x = grid.indexX(current.index);
+        int y = grid.indexY(current.index);
+        if (current.cost > distance[localIndex(cluster, x, y)]) {
+            continue;
+        }
+        ++expanded;
+
+        for (auto& step : STEPS) {
+            int newX = x + step[0];
+            int newY = y + step[1];
+            if (newX < cluster.left || newX >= cluster.left + cluster.width ||
+                newY < cluster.top || newY >= cluster.top + cluster.height || grid.isWall(newX, newY)) {
+                continue;
+            }
+            // Going backwards, the step from the neighbour enters this cell
+            int cost = current.cost + (reverse ? grid.cost(x, y) : grid.cost(newX, newY));
+            int local = localIndex(cluster, newX, newY);
+            if (cost < distance[local]) {
+                if (distance[local] != INT_MAX) {
+                    workspace.countDuplicate();
+                }
+                distance[local] = cost;
+                if (parent) {
+                    (*parent)[local] = current.index;
+                }
+                workspace.pushHeap({grid.index(newX, newY), cost, cost}, 1);
+            }
+        }
+    }
+    return expanded;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Grid.h"
+#include "SearchWorkspace.h"
+
+// Abstract graph for HPA*: the grid is cut into square clusters, and every
+// stretch of open cells along the border between two clusters becomes one
+// entrance (two for long stretches). The cells on either side of an
+// entrance are the graph's nodes. Nodes of the same cluster are joined by
+// the cost of the cheapest path between them that stays inside the
+// cluster, and the two sides of an entrance by the cost of the step across.
+//
+// Edits only invalidate the clusters they touch: updateCell recomputes the
+// cluster holding the cell, and for a cell on a cluster edge the border it
+// lies on and the cluster across it.
+class HierarchicalGraph {
+public:
+    struct Cluster {
+        int left;
+        int top;
+        int width;
+        int height;
+        std::vector<int> nodes;      // grid indices of the cluster's entrance cells
+        std::vector<int> distances;  // nodes.size() squared, INT_MAX if unreachable
+    };
+
+    // An entrance cell and the cell across the border from it
+    struct Link {
+        int node;
+        int partner;
+    };
+
+    static const int DEFAULT_CLUSTER_SIZE = 16;
+
+    HierarchicalGraph();
+
+    void build(const Grid& grid, int clusterSize = DEFAULT_CLUSTER_SIZE);
+    void clear();
+    bool isBuilt() const { return built; }
+
+    // True if built, or patched by updateCell, for exactly this grid revision
+    bool isCurrent(const Grid& grid) const { return built && revision == grid.getRevision(); }
+
+    // Call after changing the wall or terrain cost of (x, y)
+    void updateCell(const Grid& grid, int x, int y);
+
+    int getClusterSize() const { return clusterSize; }
+    int clusterOf(int x, int y) const { return (y / clusterSize) * clustersX + x / clusterSize; }
+    const Cluster& cluster(int id) const { return clusters[id]; }
+    const std::vector<Link>& links(int id) const { return clusterLinks[id]; }
+
+    // Index of a cell among its cluster's nodes, or -1 if it is not a node
+    int nodeIndex(int index) const { return nodeOf[index]; }
+
+    int localIndex(const Cluster& cluster, int x, int y) const {
+        return (y - cluster.top) * cluster.width + (x - cluster.left);
+    }
+
+    // Dijkstra from `source` that never leaves the cluster. distance and
+    // parent are indexed by localIndex; with reverse set, distance holds the
+    // cost of reaching source instead. Returns the number of cells expanded.
+    int clusterDijkstra(const Grid& grid, int id, int source, bool reverse,
+                        SearchWorkspace& workspace,
+                        std::vector<int>& distance, std::vector<int>* parent) const;
+
+private:
+    struct Transition {
+        int first;
+        int second;
+    };
+
+    void buildBorder(const Grid& grid, int cx, int cy, bool right);
+    void buildCluster(const Grid& grid, int id);
+
+    std::vector<Transition>& border(int cx, int cy, bool right) {
+        return (right ? rightBorders : bottomBorders)[cy * clustersX + cx];
+    }
+
+    int clusterSize;
+    int clustersX;
+    int clustersY;
+    std::vector<Cluster> clusters;
+    std::vector<std::vector<Link>> clusterLinks;
+
+    // Entrances between cluster (cx, cy) and the one to its right, and
+    // between it and the one below; `first` lies in cluster (cx, cy)
+    std::vector<std::vector<Transition>> rightBorders;
+    std::vector<std::vector<Transition>> bottomBorders;
+
+    std::vector<int> nodeOf;
+    SearchWorkspace buildWorkspace;
+    std::vector<int> buildDistance;
+    std::uint64_t revision;
+    bool built;
+};
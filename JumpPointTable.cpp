@@ -0,0 +1,75 @@
+#include "JumpPointTable.h"
+
+JumpPointTable::JumpPointTable() : revision(0), built(false) {}
+
+void JumpPointTable::clear() {
+    distances.clear();
+    built = false;
+}
+
+void JumpPointTable::build(const Grid& grid) {
+    const int rows = grid.getRows();
+    const int cols = grid.getCols();
+    distances.assign(static_cast<std::size_t>(grid.getSize()) * 4, 0);
+
+    auto slot = [&](int x, int y, Direction direction) -> std::int16_t& {
+        return distances[static_cast<std::size_t>(grid.index(x, y)) * 4 + direction];
+    };
+
+    // Extends the distance of the neighbouring cell by one step, keeping the
+    // sign that says whether it ends at a jump point or at a wall.
+    auto extend = [](int next) -> std::int16_t {
+        return static_cast<std::int16_t>(next > 0 ? next + 1 : next - 1);
+    };
+
+    // Horizontal jumps stop at forced cells, so each row is one sweep per direction
+    for (int y = 0; y < rows; ++y) {
+        for (int x = cols - 1; x >= 0; --x) {
+            if (!grid.isWalkable(x + 1, y)) {
+                slot(x, y, RIGHT) = 0;
+            } else if (isHorizontalJumpPoint(grid, x + 1, y, 1)) {
+                slot(x, y, RIGHT) = 1;
+            } else {
+                slot(x, y, RIGHT) = extend(slot(x + 1, y, RIGHT));
+            }
+        }
+        for (int x = 0; x < cols; ++x) {
+            if (!grid.isWalkable(x - 1, y)) {
+                slot(x, y, LEFT) = 0;
+            } else if (isHorizontalJumpPoint(grid, x - 1, y, -1)) {
+                slot(x, y, LEFT) = 1;
+            } else {
+                slot(x, y, LEFT) = extend(slot(x - 1, y, LEFT));
+            }
+        }
+    }
+
+    // Vertical jumps stop wherever a horizontal jump would find something
+    auto isVerticalJumpPoint = [&](int x, int y) {
+        return slot(x, y, RIGHT) > 0 || slot(x, y, LEFT) > 0;
+    };
+
+    for (int x = 0; x < cols; ++x) {
+        for (int y = rows - 1; y >= 0; --y) {
+            if (!grid.isWalkable(x, y + 1)) {
+                slot(x, y, DOWN) = 0;
+            } else if (isVerticalJumpPoint(x, y + 1)) {
+                slot(x, y, DOWN) = 1;
+            } else {
+                slot(x, y, DOWN) = extend(slot(x, y + 1, DOWN));
+            }
+        }
+        for (int y = 0; y < rows; ++y) {
+            if (!grid.isWalkable(x, y - 1)) {
+                slot(x, y, UP) = 0;
+            } else if (isVerticalJumpPoint(x, y - 1)) {
+                slot(x, y, UP) = 1;
+            } else {
+                slot(x, y, UP) = extend(slot(x, y - 1, UP));
+            }
+        }
+    }
+
+    revision = grid.getRevision();
+    built = true;
+}
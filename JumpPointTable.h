@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Grid.h"
+
+// Precomputed jump distances for JPS+ on a 4-connected grid.
+//
+// For every cell and direction the table stores how many steps it takes to
+// reach the next jump point in that direction (positive), or minus the number
+// of free steps before a wall or the edge of the map (zero or negative) when
+// there is no jump point. Distances are stored as int16, so maps are limited
+// to 32767 cells per side.
+class JumpPointTable {
+public:
+    enum Direction {
+        UP = 0,
+        RIGHT = 1,
+        DOWN = 2,
+        LEFT = 3
+    };
+
+    JumpPointTable();
+
+    void build(const Grid& grid);
+    void clear();
+    bool isBuilt() const { return built; }
+
+    // True if built for exactly this grid revision
+    bool isCurrent(const Grid& grid) const { return built && revision == grid.getRevision(); }
+
+    int distance(int index, Direction direction) const {
+        return distances[static_cast<std::size_t>(index) * 4 + direction];
+    }
+
+    // A cell reached by moving horizontally is a jump point when the row
+    // above or below opens up right after being blocked behind it.
+    static bool isHorizontalJumpPoint(const Grid& grid, int x, int y, int dx) {
+        return (grid.isWalkable(x, y - 1) && !grid.isWalkable(x - dx, y - 1)) ||
+               (grid.isWalkable(x, y + 1) && !grid.isWalkable(x - dx, y + 1));
+    }
+
+private:
+    std::vector<std::int16_t> distances;
+    std::uint64_t revision;
+    bool built;
+};
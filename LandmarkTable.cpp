@@ -0,0 +1,179 @@
+#include "LandmarkTable.h"
+#include <climits>
+#include <random>
+#include "ComponentIndex.h"
+#include "SearchKernel.h"
+
+const std::uint16_t LandmarkTable::UNKNOWN;
+
+LandmarkTable::LandmarkTable() : stride(0), landmarkCount(0), revision(0), built(false) {}
+
+void LandmarkTable::clear() {
+    distances.clear();
+    landmarks.clear();
+    stride = 0;
+    landmarkCount = 0;
+    built = false;
+}
+
+void LandmarkTable::build(const Grid& grid, int count, Constants::LandmarkSelection selection) {
+    clear();
+    stride = std::max(count, 0);
+    distances.assign(static_cast<std::size_t>(grid.getSize()) * stride, UNKNOWN);
+    revision = grid.getRevision();
+    built = true;
+
+    // Landmarks in small pockets would only help queries inside them, so
+    // they all go in the largest component
+    int seed = largestComponentCell(grid);
+    if (seed < 0) {
+        return;
+    }
+    settleFrom(grid, seed);
+    cells.clear();
+    nearest.assign(grid.getSize(), INT_MAX);
+    for (int index = 0; index < grid.getSize(); ++index) {
+        int distance = settledDistance(grid, index);
+        if (distance != INT_MAX) {
+            cells.push_back(index);
+            nearest[index] = distance;
+        }
+    }
+
+    // Farthest: each landmark is the cell farthest from the ones placed so
+    // far, the first one farthest from the seed.
+    // Avoid: each landmark is a leaf of the shortest-path tree of a random
+    // root, down the subtree whose cells the current landmarks bound worst
+    // (Goldberg and Harrelson). Farthest stands in if no subtree is left.
+    std::mt19937 rng(static_cast<unsigned>(grid.getRows() * 7919 + grid.getCols()));
+    std::uniform_int_distribution<std::size_t> pick(0, cells.size() - 1);
+    for (int i = 0; i < count; ++i) {
+        int next = -1;
+        if (selection == Constants::AVOID_LANDMARKS) {
+            next = avoidCell(grid, cells[pick(rng)]);
+        }
+        if (next < 0) {
+            next = farthestCell();
+        }
+        if (next < 0) {
+            break;
+        }
+        addLandmark(grid, next);
+    }
+}
+
+int LandmarkTable::largestComponentCell(const Grid& grid) const {
+    ComponentIndex components;
+    components.build(grid);
+    std::vector<int> sizes;
+    int best = -1;
+    int bestSize = 0;
+    for (int index = 0; index < grid.getSize(); ++index) {
+        int component = components.component(index);
+        if (component < 0) {
+            continue;
+        }
+        if (component >= static_cast<int>(sizes.size())) {
+            sizes.resize(component + 1, 0);
+        }
+        if (++sizes[component] > bestSize) {
+            bestSize = sizes[component];
+            best = index;
+        }
+    }
+    return best;
+}
+
+void LandmarkTable::settleFrom(const Grid& grid, int index) {
+    // A Dijkstra with no goal, through the same kernel the searches use
+    PaddedGrid& padded = workspace.padded;
+    if (!padded.isCurrent(grid)) {
+        padded.build(grid);
+    }
+    workspace.begin(static_cast<std::size_t>(padded.getSize()));
+    int expanded = 0;
+    SearchKernel::search<SearchKernel::Buckets, Constants::FOUR_CONNECTED, Constants::CUT_CORNERS,
+                         SearchKernel::TerrainCost>(padded, padded.index(grid.indexX(index), grid.indexY(index)), -1,
+                                                    workspace, SearchKernel::NoHeuristic(), expanded);
+}
+
+int LandmarkTable::settledDistance(const Grid& grid, int index) const {
+    return workspace.distance(workspace.padded.index(grid.indexX(index), grid.indexY(index)));
+}
+
+int LandmarkTable::farthestCell() const {
+    int best = -1;
+    int bestDistance = 0;
+    for (int index : cells) {
+        if (nearest[index] > bestDistance) {
+            bestDistance = nearest[index];
+            best = index;
+        }
+    }
+    return best;
+}
+
+int LandmarkTable::avoidCell(const Grid& grid, int root) {
+    settleFrom(grid, root);
+
+    // Children lie strictly farther from the root than their parents, as
+    // every step costs at least 1, so in order of decreasing distance each
+    // subtree is complete before its root is reached
+    order.assign(cells.begin(), cells.end());
+    std::sort(order.begin(), order.end(), [&](int first, int second) {
+        return settledDistance(grid, first) > settledDistance(grid, second);
+    });
+
+    // A cell weighs as much as the current bound underestimates its cost
+    // from the root; subtrees holding a landmark are already covered (-1)
+    subtree.assign(grid.getSize(), 0);
+    heaviestChild.assign(grid.getSize(), -1);
+    const PaddedGrid& padded = workspace.padded;
+    int rootCost = grid.cost(grid.indexX(root), grid.indexY(root));
+    for (int index : order) {
+        int x = grid.indexX(index);
+        int y = grid.indexY(index);
+        if (nearest[index] == 0 && landmarkCount > 0) {
+            subtree[index] = -1;
+        } else if (subtree[index] >= 0) {
+            subtree[index] += settledDistance(grid, index) - lowerBound(root, rootCost, index, grid.cost(x, y));
+        }
+
+        int parentCell = workspace.parent(padded.index(x, y));
+        if (parentCell < 0) {
+            continue;
+        }
+        int parent = grid.index(padded.indexX(parentCell), padded.indexY(parentCell));
+        if (subtree[index] < 0) {
+            subtree[parent] = -1;
+        } else if (subtree[parent] >= 0) {
+            subtree[parent] += subtree[index];
+            if (heaviestChild[parent] < 0 || subtree[index] > subtree[heaviestChild[parent]]) {
+                heaviestChild[parent] = index;
+            }
+        }
+    }
+
+    if (subtree[root] <= 0) {
+        return -1;
+    }
+    int leaf = root;
+    while (heaviestChild[leaf] >= 0 && subtree[heaviestChild[leaf]] > 0) {
+        leaf = heaviestChild[leaf];
+    }
+    return leaf == root ? -1 : leaf;
+}
+
+void LandmarkTable::addLandmark(const Grid& grid, int index) {
+    settleFrom(grid, index);
+    int landmark = landmarkCount;
+    for (int cell : cells) {
+        int distance = settledDistance(grid, cell);
+        distances[static_cast<std::size_t>(cell) * stride + landmark] =
+            static_cast<std::uint16_t>(std::min(distance, static_cast<int>(UNKNOWN)));
+        // The seed's distances only stood in until there was a landmark
+        nearest[cell] = landmark == 0 ? distance : std::min(nearest[cell], distance);
+    }
+    landmarks.push_back({grid.indexX(index), grid.indexY(index)});
+    ++landmarkCount;
+}
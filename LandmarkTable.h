@@ -0,0 +1,95 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <SFML/System/Vector2.hpp>
+#include "Constants.h"
+#include "Grid.h"
+#include "SearchWorkspace.h"
+
+// Landmark distances for ALT (A*, landmarks, triangle inequality) on a
+// 4-connected grid with terrain costs.
+//
+// A handful of landmark cells each get a full Dijkstra run, and every cell
+// stores its cost from each landmark. For any landmark L the triangle
+// inequality bounds the cost from v to t from below both by
+// d(L, t) - d(L, v) and by d(v, L) - d(t, L). Steps pay the cost of the cell
+// entered, so going against a path costs the same minus the cost of the
+// cell it starts from plus that of the cell it ends on, and one table per
+// landmark gives both bounds. The heuristic is the largest bound over all
+// landmarks; unlike Manhattan distance it sees walls and expensive terrain.
+//
+// Distances are uint16, cell-major so that a lookup reads one short run of
+// landmarks per cell. Costs of UNKNOWN or more, and cells the landmark
+// cannot reach, are stored as UNKNOWN and give no bound, which on huge
+// weighted maps leaves far cells to the other landmarks.
+//
+// The table is for maps that stay fixed over many queries: it remembers the
+// grid revision it was built for, and any edit calls for a rebuild.
+class LandmarkTable {
+public:
+    static const std::uint16_t UNKNOWN = 65535;
+
+    LandmarkTable();
+
+    // Places `count` landmarks in the largest component of free cells and
+    // runs a Dijkstra from each. The placement is deterministic.
+    void build(const Grid& grid, int count,
+               Constants::LandmarkSelection selection = Constants::AVOID_LANDMARKS);
+    void clear();
+    bool isBuilt() const { return built; }
+    bool isCurrent(const Grid& grid) const { return built && revision == grid.getRevision(); }
+
+    int getLandmarkCount() const { return landmarkCount; }
+    sf::Vector2i getLandmark(int landmark) const { return landmarks[landmark]; }
+    std::size_t getTableBytes() const { return distances.size() * sizeof(std::uint16_t); }
+
+    // Lower bound on the cost from grid index `from` to grid index `to`,
+    // given the terrain costs of both cells
+    int lowerBound(int from, int fromCost, int to, int toCost) const {
+        if (landmarkCount == 0) {
+            return 0;
+        }
+        const std::uint16_t* fromRow = &distances[static_cast<std::size_t>(from) * stride];
+        const std::uint16_t* toRow = &distances[static_cast<std::size_t>(to) * stride];
+        int bound = 0;
+        for (int landmark = 0; landmark < landmarkCount; ++landmark) {
+            if (fromRow[landmark] == UNKNOWN || toRow[landmark] == UNKNOWN) {
+                continue;
+            }
+            int forward = toRow[landmark] - fromRow[landmark];
+            int backward = fromRow[landmark] - fromCost - toRow[landmark] + toCost;
+            bound = std::max(bound, std::max(forward, backward));
+        }
+        return bound;
+    }
+
+private:
+    int largestComponentCell(const Grid& grid) const;
+    void settleFrom(const Grid& grid, int index);
+    int settledDistance(const Grid& grid, int index) const;
+    int farthestCell() const;
+    int avoidCell(const Grid& grid, int root);
+    void addLandmark(const Grid& grid, int index);
+
+    std::vector<std::uint16_t> distances;
+    std::vector<sf::Vector2i> landmarks;
+    int stride;
+    int landmarkCount;
+
+    // Build scratch: Dijkstra labels on the workspace's padded copy of the
+    // grid, the cells of the component the landmarks go in, each cell's
+    // cost from the nearest landmark so far, and the avoid heuristic's
+    // shortest-path tree weights
+    SearchWorkspace workspace;
+    std::vector<int> cells;
+    std::vector<int> nearest;
+    std::vector<int> order;
+    std::vector<long long> subtree;
+    std::vector<int> heaviestChild;
+
+    std::uint64_t revision;
+    bool built;
+};
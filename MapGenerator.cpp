@@ -0,0 +1,124 @@
+#include "MapGenerator.h"
+#include <algorithm>
+#include <vector>
+#include "ComponentIndex.h"
+
+Grid MapGenerator::randomObstacles(int rows, int cols, double density, unsigned seed) {
+    Grid grid(rows, cols, Constants::EMPTY);
+    std::mt19937 rng(seed);
+    std::bernoulli_distribution isWall(density);
+
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < cols; ++x) {
+            if (isWall(rng)) {
+                grid.set(x, y, Constants::WALL);
+            }
+        }
+    }
+    return grid;
+}
+
+Grid MapGenerator::maze(int rows, int cols, unsigned seed) {
+    Grid grid(rows, cols, Constants::WALL);
+    if (rows == 0 || cols == 0) {
+        return grid;
+    }
+    std::mt19937 rng(seed);
+    static const sf::Vector2i steps[] = {{0, -2}, {2, 0}, {0, 2}, {-2, 0}};
+
+    // Explicit stack so that large mazes cannot overflow the call stack
+    std::vector<sf::Vector2i> stack;
+    stack.push_back({0, 0});
+    grid.set(0, 0, Constants::EMPTY);
+    while (!stack.empty()) {
+        sf::Vector2i cell = stack.back();
+        sf::Vector2i options[4];
+        int count = 0;
+        for (auto& step : steps) {
+            sf::Vector2i next(cell.x + step.x, cell.y + step.y);
+            if (grid.isValidCell(next.x, next.y) && grid.isWall(next.x, next.y)) {
+                options[count++] = next;
+            }
+        }
+        if (count == 0) {
+            stack.pop_back();
+            continue;
+        }
+
+        sf::Vector2i next = options[std::uniform_int_distribution<int>(0, count - 1)(rng)];
+        grid.set((cell.x + next.x) / 2, (cell.y + next.y) / 2, Constants::EMPTY);
+        grid.set(next.x, next.y, Constants::EMPTY);
+        stack.push_back(next);
+    }
+    return grid;
+}
+
+void MapGenerator::randomTerrain(Grid& grid, int maxCost, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> cost(Constants::MIN_TERRAIN_COST, maxCost);
+
+    for (int y = 0; y < grid.getRows(); ++y) {
+        for (int x = 0; x < grid.getCols(); ++x) {
+            grid.setCost(x, y, cost(rng));
+        }
+    }
+}
+
+sf::Vector2i MapGenerator::randomFreeCell(const Grid& grid, std::mt19937& rng) {
+    if (grid.getSize() == 0) {
+        return {-1, -1};
+    }
+
+    std::uniform_int_distribution<int> column(0, grid.getCols() - 1);
+    std::uniform_int_distribution<int> row(0, grid.getRows() - 1);
+
+    // Rejection sampling is fast for sensible wall densities; fall back to a
+    // scan so that a fully blocked map still terminates
+    for (int attempt = 0; attempt < 64; ++attempt) {
+        int x = column(rng);
+        int y = row(rng);
+        if (!grid.isWall(x, y)) {
+            return {x, y};
+        }
+    }
+    for (int y = 0; y < grid.getRows(); ++y) {
+        for (int x = 0; x < grid.getCols(); ++x) {
+            if (!grid.isWall(x, y)) {
+                return {x, y};
+            }
+        }
+    }
+    return {-1, -1};
+}
+
+std::vector<sf::Vector2i> MapGenerator::distinctConnectedCells(const Grid& grid, int count, std::mt19937& rng) {
+    ComponentIndex components;
+    components.build(grid);
+    std::vector<int> sizes(grid.getSize(), 0);
+    int largest = -1;
+    for (int index = 0; index < grid.getSize(); ++index) {
+        int component = components.component(index);
+        if (component == -1) {
+            continue;
+        }
+        if (++sizes[component] > (largest == -1 ? 0 : sizes[largest])) {
+            largest = component;
+        }
+    }
+
+    std::vector<sf::Vector2i> cells;
+    for (int index = 0; index < grid.getSize(); ++index) {
+        if (largest != -1 && components.component(index) == largest) {
+            cells.push_back({grid.indexX(index), grid.indexY(index)});
+        }
+    }
+
+    // Partial Fisher-Yates: only the first `count` slots are shuffled
+    int picked = std::min(count, static_cast<int>(cells.size()));
+    for (int i = 0; i < picked; ++i) {
+        std::uniform_int_distribution<int> pick(i, static_cast<int>(cells.size()) - 1);
+        std::swap(cells[i], cells[pick(rng)]);
+    }
+    cells.resize(picked);
+    return cells;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <random>
+#include <vector>
+#include <SFML/System/Vector2.hpp>
+#include "Grid.h"
+
+// Builds synthetic maps for verification and timing runs. Every generator is
+// deterministic for a given seed.
+class MapGenerator {
+public:
+    // Each cell becomes a wall independently with the given probability
+    static Grid randomObstacles(int rows, int cols, double density, unsigned seed);
+
+    // Perfect maze of one-cell corridors carved by a randomized depth-first
+    // walk over the cells with even coordinates; every free cell is reachable
+    static Grid maze(int rows, int cols, unsigned seed);
+
+    // Gives every cell a uniformly random terrain cost in [1, maxCost]
+    static void randomTerrain(Grid& grid, int maxCost, unsigned seed);
+
+    // Picks a uniformly random non-wall cell, or {-1, -1} if there is none
+    static sf::Vector2i randomFreeCell(const Grid& grid, std::mt19937& rng);
+
+    // Picks `count` distinct non-wall cells from the largest connected
+    // region, so any two are connected; fewer if the region is smaller
+    static std::vector<sf::Vector2i> distinctConnectedCells(const Grid& grid, int count, std::mt19937& rng);
+};
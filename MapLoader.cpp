@@ -0,0 +1,128 @@
+#include "MapLoader.h"
+#include <fstream>
+#include <sstream>
+#include <utility>
+#include <iostream>
+
+bool MapLoader::loadTerrain(const std::string& filename, Grid& grid) {
+    std::ifstream file(filename);
+    if (!file) {
+        std::cerr << "Failed to open terrain map " << filename << std::endl;
+        return false;
+    }
+
+    int rows, cols;
+    if (!(file >> rows >> cols) || rows <= 0 || cols <= 0) {
+        std::cerr << "Invalid terrain map header in " << filename << std::endl;
+        return false;
+    }
+
+    Grid loaded(rows, cols, Constants::EMPTY);
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < cols; ++x) {
+            int value;
+            if (!(file >> value) || value < 0 || value > Constants::MAX_TERRAIN_COST) {
+                std::cerr << "Invalid terrain cost at (" << x << ", " << y << ") in " << filename << std::endl;
+                return false;
+            }
+            if (value == 0) {
+                loaded.set(x, y, Constants::WALL);
+            } else {
+                loaded.setCost(x, y, value);
+            }
+        }
+    }
+
+    grid = std::move(loaded);
+    return true;
+}
+
+bool MapLoader::saveTerrain(const std::string& filename, const Grid& grid) {
+    std::ofstream file(filename);
+    if (!file) {
+        std::cerr << "Failed to write terrain map " << filename << std::endl;
+        return false;
+    }
+
+    file << grid.getRows() << " " << grid.getCols() << "\n";
+    for (int y = 0; y < grid.getRows(); ++y) {
+        for (int x = 0; x < grid.getCols(); ++x) {
+            file << (x > 0 ? " " : "") << (grid.isWall(x, y) ? 0 : grid.cost(x, y));
+        }
+        file << "\n";
+    }
+    return static_cast<bool>(file);
+}
+
+bool MapLoader::loadMovingAIMap(const std::string& filename, Grid& grid) {
+    std::ifstream file(filename);
+    if (!file) {
+        std::cerr << "Failed to open Moving AI map " << filename << std::endl;
+        return false;
+    }
+
+    // The header fields come in any order and end at "map"
+    int rows = 0;
+    int cols = 0;
+    std::string field;
+    while (file >> field && field != "map") {
+        if (field == "height") {
+            file >> rows;
+        } else if (field == "width") {
+            file >> cols;
+        } else {
+            file >> field; // type, always octile
+        }
+    }
+    if (field != "map" || rows <= 0 || cols <= 0) {
+        std::cerr << "Invalid Moving AI map header in " << filename << std::endl;
+        return false;
+    }
+
+    Grid loaded(rows, cols, Constants::EMPTY);
+    std::string line;
+    for (int y = 0; y < rows; ++y) {
+        if (!(file >> line) || static_cast<int>(line.size()) < cols) {
+            std::cerr << "Moving AI map " << filename << " ends at row " << y << std::endl;
+            return false;
+        }
+        for (int x = 0; x < cols; ++x) {
+            char terrain = line[x];
+            if (terrain != '.' && terrain != 'G' && terrain != 'S') {
+                loaded.set(x, y, Constants::WALL);
+            }
+        }
+    }
+
+    grid = std::move(loaded);
+    return true;
+}
+
+bool MapLoader::loadScenario(const std::string& filename, std::vector<ScenarioQuery>& queries) {
+    std::ifstream file(filename);
+    if (!file) {
+        std::cerr << "Failed to open scenario " << filename << std::endl;
+        return false;
+    }
+
+    std::vector<ScenarioQuery> loaded;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        if (line.find_first_not_of(" \t\r") == std::string::npos || line.compare(0, 7, "version") == 0) {
+            continue;
+        }
+        std::istringstream fields(line);
+        ScenarioQuery query;
+        if (!(fields >> query.bucket >> query.map >> query.width >> query.height >> query.start.x >> query.start.y >>
+              query.goal.x >> query.goal.y >> query.optimalLength)) {
+            std::cerr << "Invalid scenario line " << lineNumber << " in " << filename << std::endl;
+            return false;
+        }
+        loaded.push_back(query);
+    }
+
+    queries = std::move(loaded);
+    return true;
+}
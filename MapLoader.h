@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <SFML/System/Vector2.hpp>
+#include "Grid.h"
+
+// Reads and writes maps on disk. Errors are reported on std::cerr and
+// signalled by returning false, leaving the target grid untouched.
+class MapLoader {
+public:
+    // Plain-text terrain map: "rows cols" followed by rows * cols integers in
+    // row-major order, 0 for a wall and 1..255 for the cost of entering the cell
+    static bool loadTerrain(const std::string& filename, Grid& grid);
+    static bool saveTerrain(const std::string& filename, const Grid& grid);
+
+    // Moving AI benchmark map (.map): a "type", "height", "width" and "map"
+    // header, then one character per cell. '.' and 'G' are ground and 'S'
+    // swamp, all of cost 1; '@' and 'O' are out of bounds and 'T' trees.
+    // 'W' water is only passable from water, which the grid cannot express,
+    // so it becomes a wall like the rest.
+    static bool loadMovingAIMap(const std::string& filename, Grid& grid);
+
+    // One line of a Moving AI scenario: the map it was made for and its
+    // size, the endpoints, and the optimal length with diagonal steps of
+    // sqrt(2) that never cut a wall's corner
+    struct ScenarioQuery {
+        int bucket;
+        std::string map;
+        int width;
+        int height;
+        sf::Vector2i start;
+        sf::Vector2i goal;
+        double optimalLength;
+    };
+
+    // Moving AI scenario (.scen): an optional "version" line, then one
+    // query per line. Replaces the contents of `queries`.
+    static bool loadScenario(const std::string& filename, std::vector<ScenarioQuery>& queries);
+};
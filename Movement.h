@@ -0,0 +1,127 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include "Constants.h"
+#include "Grid.h"
+
+// How a search may move between cells.
+//
+// 4-connected searches step to the orthogonal neighbours and pay the terrain
+// cost of the cell entered, as they always have. 8-connected searches may
+// also step diagonally; their costs are fixed point, the terrain cost times
+// STRAIGHT_WEIGHT for a straight step or DIAGONAL_WEIGHT for a diagonal one.
+// 99/70 is within 0.005% of sqrt(2), and the largest step, 255 * 99, still
+// leaves room for paths across millions of cells in an int.
+//
+// The corner policy decides which diagonal steps past a wall are allowed:
+// CUT_CORNERS takes any diagonal onto a free cell, even squeezing between
+// two walls that touch at a corner; NO_SQUEEZE needs one of the two cells
+// beside the step to be free; NO_CUT_CORNERS needs both.
+struct Movement {
+    static const int STRAIGHT_WEIGHT = 70;
+    static const int DIAGONAL_WEIGHT = 99;
+
+    Constants::Connectivity connectivity;
+    Constants::CornerPolicy corners;
+
+    Movement(Constants::Connectivity connectivity = Constants::FOUR_CONNECTED,
+             Constants::CornerPolicy corners = Constants::NO_CUT_CORNERS)
+        : connectivity(connectivity), corners(corners) {}
+
+    bool operator==(const Movement& other) const {
+        // The policy only matters once there are diagonals
+        return connectivity == other.connectivity &&
+               (connectivity == Constants::FOUR_CONNECTED || corners == other.corners);
+    }
+    bool operator!=(const Movement& other) const { return !(*this == other); }
+
+    // Squeezing between two walls joins cells that are apart on a
+    // 4-connected grid, so 4-connected region labels no longer apply
+    bool joinsFourConnectedRegions() const {
+        return connectivity == Constants::EIGHT_CONNECTED && corners == Constants::CUT_CORNERS;
+    }
+
+    // Whether a single step from (x, y) by (dx, dy) is allowed; used to
+    // check finished paths, the searches use the tables below
+    bool allowsStep(const Grid& grid, int x, int y, int dx, int dy) const {
+        if (std::abs(dx) > 1 || std::abs(dy) > 1 || (dx == 0 && dy == 0) || !grid.isWalkable(x + dx, y + dy)) {
+            return false;
+        }
+        if (dx == 0 || dy == 0) {
+            return true;
+        }
+        if (connectivity == Constants::FOUR_CONNECTED) {
+            return false;
+        }
+        bool first = grid.isWalkable(x + dx, y);
+        bool second = grid.isWalkable(x, y + dy);
+        switch (corners) {
+            case Constants::CUT_CORNERS: return true;
+            case Constants::NO_SQUEEZE: return first || second;
+            case Constants::NO_CUT_CORNERS: return first && second;
+        }
+        return false;
+    }
+
+    // Cost of stepping by (dx, dy) into a cell of the given terrain cost
+    int stepCost(int dx, int dy, int terrainCost) const {
+        if (connectivity == Constants::FOUR_CONNECTED) {
+            return terrainCost;
+        }
+        return terrainCost * (dx != 0 && dy != 0 ? DIAGONAL_WEIGHT : STRAIGHT_WEIGHT);
+    }
+
+    // Exact 8-connected distance over unit terrain, in the fixed-point units
+    static int octileDistance(int dx, int dy) {
+        dx = std::abs(dx);
+        dy = std::abs(dy);
+        return STRAIGHT_WEIGHT * (std::max(dx, dy) - std::min(dx, dy)) + DIAGONAL_WEIGHT * std::min(dx, dy);
+    }
+
+    // "4-way", or "8-way" followed by the corner policy
+    const char* name() const {
+        if (connectivity == Constants::FOUR_CONNECTED) {
+            return "4-way";
+        }
+        switch (corners) {
+            case Constants::CUT_CORNERS: return "8-way, cut corners";
+            case Constants::NO_SQUEEZE: return "8-way, no squeeze";
+            case Constants::NO_CUT_CORNERS: return "8-way, no corner cutting";
+        }
+        return "8-way";
+    }
+};
+
+// Neighbour tables the search kernel is instantiated over. Both sizes are
+// compile-time constants, so the expansion loops over them unroll and the
+// 4-connected instantiations carry no diagonal checks at all.
+struct NeighborStep {
+    int dx;
+    int dy;
+    int weight;
+};
+
+template <Constants::Connectivity C>
+struct NeighborTable;
+
+// Up, right, down, left, the order the searches have always tried
+template <>
+struct NeighborTable<Constants::FOUR_CONNECTED> {
+    static constexpr int COUNT = 4;
+    static constexpr NeighborStep STEPS[COUNT] = {
+        {0, -1, 1}, {1, 0, 1}, {0, 1, 1}, {-1, 0, 1}
+    };
+};
+
+// The same four, then the diagonals clockwise from up-right
+template <>
+struct NeighborTable<Constants::EIGHT_CONNECTED> {
+    static constexpr int COUNT = 8;
+    static constexpr NeighborStep STEPS[COUNT] = {
+        {0, -1, Movement::STRAIGHT_WEIGHT}, {1, 0, Movement::STRAIGHT_WEIGHT},
+        {0, 1, Movement::STRAIGHT_WEIGHT}, {-1, 0, Movement::STRAIGHT_WEIGHT},
+        {1, -1, Movement::DIAGONAL_WEIGHT}, {1, 1, Movement::DIAGONAL_WEIGHT},
+        {-1, 1, Movement::DIAGONAL_WEIGHT}, {-1, -1, Movement::DIAGONAL_WEIGHT}
+    };
+};
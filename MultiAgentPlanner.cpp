@@ -0,0 +1,595 @@
+#include "MultiAgentPlanner.h"
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+
+// Four moves and a wait
+static const int STEPS[5][2] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}, {0, 0}};
+
+MultiAgentPlanner::MultiAgentPlanner()
+    : window(DEFAULT_WINDOW), cellCount(0), round(0), searchGeneration(0), nodesExpanded(0) {}
+
+bool MultiAgentPlanner::reachable(const Grid& grid, const std::vector<Agent>& agents) {
+    components.build(grid);
+    for (const Agent& agent : agents) {
+        if (!grid.isWalkable(agent.start.x, agent.start.y) || !grid.isWalkable(agent.goal.x, agent.goal.y) ||
+            !components.connected(grid.index(agent.start.x, agent.start.y), grid.index(agent.goal.x, agent.goal.y))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int MultiAgentPlanner::owner(int cell, int step) const {
+    std::size_t slot = static_cast<std::size_t>(step) * cellCount + cell;
+    return reservations[slot].stamp == round ? reservations[slot].agent : -1;
+}
+
+void MultiAgentPlanner::reserve(int cell, int step, int agent) {
+    std::size_t slot = static_cast<std::size_t>(step) * cellCount + cell;
+    reservations[slot] = {agent, round};
+}
+
+void MultiAgentPlanner::release(int cell, int step, int agent) {
+    if (owner(cell, step) == agent) {
+        reservations[static_cast<std::size_t>(step) * cellCount + cell].stamp = 0;
+    }
+}
+
+void MultiAgentPlanner::pushOpen(const OpenNode& node) {
+    open.push_back(node);
+    std::push_heap(open.begin(), open.end(), [](const OpenNode& a, const OpenNode& b) {
+        return a.estimate != b.estimate ? a.estimate > b.estimate : a.cost < b.cost;
+    });
+}
+
+MultiAgentPlanner::OpenNode MultiAgentPlanner::popOpen() {
+    std::pop_heap(open.begin(), open.end(), [](const OpenNode& a, const OpenNode& b) {
+        return a.estimate != b.estimate ? a.estimate > b.estimate : a.cost < b.cost;
+    });
+    OpenNode node = open.back();
+    open.pop_back();
+    return node;
+}
+
+bool MultiAgentPlanner::planCooperative(const Grid& grid, const std::vector<Agent>& agents,
+                                        std::vector<std::vector<sf::Vector2i>>& paths,
+                                        int windowSize, unsigned seed) {
+    int count = static_cast<int>(agents.size());
+    paths.resize(count);
+    for (int i = 0; i < count; ++i) {
+        paths[i].clear();
+        paths[i].push_back(agents[i].start);
+    }
+    nodesExpanded = 0;
+    if (!reachable(grid, agents)) {
+        return false;
+    }
+
+    window = std::max(windowSize, 2);
+    cellCount = grid.getSize();
+    std::size_t layers = static_cast<std::size_t>(window + 1) * cellCount;
+    if (reservations.size() < layers) {
+        reservations.assign(layers, {-1, 0});
+        states.assign(layers, {0, -1, 0});
+        round = 0;
+        searchGeneration = 0;
+    }
+    guideStamp.assign(cellCount, 0);
+    guideRemaining.resize(cellCount);
+
+    std::vector<int> positions(count);
+    std::vector<int> goals(count);
+    guides.resize(count);
+    for (int i = 0; i < count; ++i) {
+        positions[i] = grid.index(agents[i].start.x, agents[i].start.y);
+        goals[i] = grid.index(agents[i].goal.x, agents[i].goal.y);
+        guideSearch(grid, positions[i], goals[i], guides[i]);
+    }
+    std::vector<int> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::mt19937 rng(seed);
+
+    // Executing half the window before replanning leaves every agent some
+    // look-ahead at the moment it commits
+    int commit = window / 2;
+    std::size_t span = static_cast<std::size_t>(window) + 1;
+    std::vector<int> trajectories(count * span);
+    std::vector<int> pending;
+    std::vector<int> trajectory;
+    int stepLimit = 8 * (grid.getRows() + grid.getCols()) + 4 * window;
+
+    for (int time = 0;; time += commit) {
+        bool arrived = true;
+        for (int i = 0; i < count && arrived; ++i) {
+            arrived = positions[i] == goals[i];
+        }
+        if (arrived || time >= stepLimit) {
+            // Drop the waiting on the goal at the end of each path
+            for (int i = 0; i < count; ++i) {
+                std::vector<sf::Vector2i>& path = paths[i];
+                while (path.size() > 1 && path.back() == agents[i].goal && path[path.size() - 2] == agents[i].goal) {
+                    path.pop_back();
+                }
+            }
+            return arrived;
+        }
+
+        if (++round == 0) {
+            for (Reservation& slot : reservations) {
+                slot.stamp = 0;
+            }
+            round = 1;
+        }
+        // Everyone holds their cell now, and may still need to wait there
+        // one step until they have been planned
+        for (int i = 0; i < count; ++i) {
+            reserve(positions[i], 0, i);
+            reserve(positions[i], 1, i);
+        }
+        std::shuffle(order.begin(), order.end(), rng);
+        pending.assign(order.rbegin(), order.rend());
+        int bumps = 0;
+
+        while (!pending.empty()) {
+            int agent = pending.back();
+            pending.pop_back();
+            int* planned = &trajectories[agent * span];
+
+            if (!windowSearch(grid, agent, positions[agent], goals[agent], guides[agent], trajectory)) {
+                // Boxed in by earlier agents. It waits where it is, and the
+                // agents that meant to pass through its cell give way and
+                // are planned again; the budget stops a cascade that cannot
+                // settle, at the price of a collision.
+                trajectory.assign(span, positions[agent]);
+                for (int step = 2; step <= window && bumps < count; ++step) {
+                    int other = owner(positions[agent], step);
+                    if (other == -1 || other == agent) {
+                        continue;
+                    }
+                    // Sending it back to wait in its own cell may in turn
+                    // bump whoever planned to step in there next
+                    while (other != -1) {
+                        const int* theirs = &trajectories[other * span];
+                        for (int s = 1; s <= window; ++s) {
+                            release(theirs[s], s, other);
+                        }
+                        int next = owner(theirs[0], 1);
+                        reserve(theirs[0], 1, other);
+                        pending.push_back(other);
+                        ++bumps;
+                        other = next;
+                    }
+                }
+            }
+            release(positions[agent], 1, agent);
+            for (int step = 0; step <= window; ++step) {
+                reserve(trajectory[step], step, agent);
+                planned[step] = trajectory[step];
+            }
+        }
+
+        for (int i = 0; i < count; ++i) {
+            const int* planned = &trajectories[i * span];
+            for (int step = 1; step <= commit; ++step) {
+                paths[i].push_back({grid.indexX(planned[step]), grid.indexY(planned[step])});
+            }
+            positions[i] = planned[commit];
+        }
+    }
+}
+
+bool MultiAgentPlanner::guideSearch(const Grid& grid, int startCell, int goalCell, std::vector<int>& guide) {
+    // Plain A* in the last layer, where reservations are never looked at
+    if (++searchGeneration == 0) {
+        for (SearchState& state : states) {
+            state.stamp = 0;
+        }
+        searchGeneration = 1;
+    }
+    open.clear();
+    guide.clear();
+
+    int goalX = grid.indexX(goalCell);
+    int goalY = grid.indexY(goalCell);
+    std::size_t offset = static_cast<std::size_t>(window) * cellCount;
+    auto visit = [&](int cell, int cost, int from) {
+        std::size_t state = offset + cell;
+        SearchState& slot = states[state];
+        if (slot.stamp == searchGeneration && slot.cost <= cost) {
+            return;
+        }
+        slot = {cost, from, searchGeneration};
+        int h = std::abs(grid.indexX(cell) - goalX) + std::abs(grid.indexY(cell) - goalY);
+        pushOpen({cell, cost, cost + h});
+    };
+    visit(startCell, 0, -1);
+
+    while (!open.empty()) {
+        OpenNode current = popOpen();
+        if (current.cost > states[offset + current.state].cost) {
+            continue;
+        }
+        ++nodesExpanded;
+        if (current.state == goalCell) {
+            for (int cell = goalCell; cell != -1; cell = states[offset + cell].parent) {
+                guide.push_back(cell);
+            }
+            std::reverse(guide.begin(), guide.end());
+            return true;
+        }
+        int x = grid.indexX(current.state);
+        int y = grid.indexY(current.state);
+        for (int d = 0; d < 4; ++d) {
+            int newX = x + STEPS[d][0];
+            int newY = y + STEPS[d][1];
+            if (grid.isWalkable(newX, newY)) {
+                visit(grid.index(newX, newY), current.cost + 1, current.state);
+            }
+        }
+    }
+    return false;
+}
+
+bool MultiAgentPlanner::windowSearch(const Grid& grid, int agent, int startCell, int goalCell,
+                                     const std::vector<int>& guide, std::vector<int>& trajectory) {
+    if (++searchGeneration == 0) {
+        for (SearchState& state : states) {
+            state.stamp = 0;
+        }
+        std::fill(guideStamp.begin(), guideStamp.end(), 0u);
+        searchGeneration = 1;
+    }
+    open.clear();
+
+    // The guide is a shortest path ignoring other agents, so from any cell
+    // on it the rest of the way beyond the window is known exactly
+    int guideLength = static_cast<int>(guide.size());
+    for (int i = 0; i < guideLength; ++i) {
+        guideStamp[guide[i]] = searchGeneration;
+        guideRemaining[guide[i]] = guideLength - 1 - i;
+    }
+    int bestTotal = INT_MAX;
+    int bestEnd = -1;
+
+    int goalX = grid.indexX(goalCell);
+    int goalY = grid.indexY(goalCell);
+    auto visit = [&](int state, int cost, int from) {
+        SearchState& slot = states[state];
+        if (slot.stamp == searchGeneration && slot.cost <= cost) {
+            return;
+        }
+        slot = {cost, from, searchGeneration};
+        int cell = state % cellCount;
+        if (state / cellCount == window && guideStamp[cell] == searchGeneration) {
+            // Joining the guide ends the search at a known total; the
+            // entry only wins if nothing cheaper is still open
+            int total = cost + guideRemaining[cell];
+            if (total < bestTotal) {
+                bestTotal = total;
+                bestEnd = state;
+                pushOpen({-1, total, total});
+            }
+            return;
+        }
+        int h = guideStamp[cell] == searchGeneration
+                    ? guideRemaining[cell]
+                    : std::abs(grid.indexX(cell) - goalX) + std::abs(grid.indexY(cell) - goalY);
+        pushOpen({state, cost, cost + h});
+    };
+    visit(startCell, 0, -1);
+
+    auto extract = [&](int end, int cost) {
+        trajectory.assign(std::max(cost + 1, window + 1), goalCell);
+        for (int state = end, step = cost; state != -1; state = states[state].parent, --step) {
+            trajectory[step] = state % cellCount;
+        }
+        trajectory.resize(window + 1);
+    };
+
+    while (!open.empty()) {
+        OpenNode current = popOpen();
+        if (current.state == -1) {
+            if (current.cost == bestTotal) {
+                extract(bestEnd, states[bestEnd].cost);
+                return true;
+            }
+            continue;
+        }
+        if (current.cost > states[current.state].cost) {
+            continue;
+        }
+        ++nodesExpanded;
+
+        int layer = current.state / cellCount;
+        int cell = current.state % cellCount;
+        if (cell == goalCell) {
+            // Done once it can stay on the goal for the rest of the window
+            bool free = true;
+            for (int step = layer + 1; step <= window && free; ++step) {
+                int holder = owner(goalCell, step);
+                free = holder == -1 || holder == agent;
+            }
+            if (free) {
+                extract(current.state, current.cost);
+                return true;
+            }
+        }
+
+        int x = grid.indexX(cell);
+        int y = grid.indexY(cell);
+        if (layer == window) {
+            // Beyond the window other agents are ignored and waiting is
+            // pointless, so this is plain A* back to the guide
+            for (int d = 0; d < 4; ++d) {
+                int newX = x + STEPS[d][0];
+                int newY = y + STEPS[d][1];
+                if (grid.isWalkable(newX, newY)) {
+                    visit(layer * cellCount + grid.index(newX, newY), current.cost + 1, current.state);
+                }
+            }
+            continue;
+        }
+
+        for (auto& step : STEPS) {
+            int newX = x + step[0];
+            int newY = y + step[1];
+            if (!grid.isWalkable(newX, newY)) {
+                continue;
+            }
+            int next = grid.index(newX, newY);
+            int holder = owner(next, layer + 1);
+            if (holder != -1 && holder != agent) {
+                continue;
+            }
+            // Swapping places with the agent coming the other way
+            int oncoming = owner(next, layer);
+            if (next != cell && oncoming != -1 && oncoming != agent && owner(cell, layer + 1) == oncoming) {
+                continue;
+            }
+            visit((layer + 1) * cellCount + next, current.cost + 1, current.state);
+        }
+    }
+    return false;
+}
+
+bool MultiAgentPlanner::planConflictBased(const Grid& grid, const std::vector<Agent>& agents,
+                                          std::vector<std::vector<sf::Vector2i>>& paths, int nodeLimit) {
+    int count = static_cast<int>(agents.size());
+    paths.assign(count, std::vector<sf::Vector2i>());
+    nodesExpanded = 0;
+    if (!reachable(grid, agents)) {
+        return false;
+    }
+    cellCount = grid.getSize();
+
+    // Exact distances to each goal make the low-level searches cheap
+    std::vector<std::vector<int>> heuristics(count);
+    for (int i = 0; i < count; ++i) {
+        std::vector<int>& distance = heuristics[i];
+        distance.assign(cellCount, INT_MAX);
+        std::vector<int> queue(1, grid.index(agents[i].goal.x, agents[i].goal.y));
+        distance[queue[0]] = 0;
+        for (std::size_t head = 0; head < queue.size(); ++head) {
+            int x = grid.indexX(queue[head]);
+            int y = grid.indexY(queue[head]);
+            for (int d = 0; d < 4; ++d) {
+                int newX = x + STEPS[d][0];
+                int newY = y + STEPS[d][1];
+                if (grid.isWalkable(newX, newY) && distance[grid.index(newX, newY)] == INT_MAX) {
+                    distance[grid.index(newX, newY)] = distance[queue[head]] + 1;
+                    queue.push_back(grid.index(newX, newY));
+                }
+            }
+        }
+    }
+
+    struct TreeNode {
+        std::vector<Constraint> constraints;
+        std::vector<std::vector<sf::Vector2i>> paths;
+        long long cost;
+    };
+    std::vector<TreeNode> tree(1);
+    tree[0].paths.resize(count);
+    for (int i = 0; i < count; ++i) {
+        constrainedSearch(grid, i, grid.index(agents[i].start.x, agents[i].start.y),
+                          grid.index(agents[i].goal.x, agents[i].goal.y), tree[0].constraints, heuristics[i],
+                          tree[0].paths[i]);
+    }
+    tree[0].cost = sumOfCosts(tree[0].paths);
+
+    typedef std::pair<long long, int> Entry;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> frontier;
+    frontier.push({tree[0].cost, 0});
+
+    auto at = [](const std::vector<sf::Vector2i>& path, int time) {
+        return path[std::min<std::size_t>(time, path.size() - 1)];
+    };
+
+    for (int expanded = 0; !frontier.empty() && expanded < nodeLimit; ++expanded) {
+        int nodeIndex = frontier.top().second;
+        frontier.pop();
+
+        // Earliest collision between any two agents
+        const std::vector<std::vector<sf::Vector2i>>& current = tree[nodeIndex].paths;
+        std::size_t horizon = 0;
+        for (const std::vector<sf::Vector2i>& path : current) {
+            horizon = std::max(horizon, path.size());
+        }
+        Constraint split[2];
+        bool collided = false;
+        for (int time = 0; time < static_cast<int>(horizon) && !collided; ++time) {
+            for (int i = 0; i < count && !collided; ++i) {
+                for (int j = i + 1; j < count && !collided; ++j) {
+                    sf::Vector2i a = at(current[i], time);
+                    sf::Vector2i b = at(current[j], time);
+                    if (a == b) {
+                        int cell = grid.index(a.x, a.y);
+                        split[0] = {i, cell, -1, time};
+                        split[1] = {j, cell, -1, time};
+                        collided = true;
+                    } else if (time > 0 && a == at(current[j], time - 1) && b == at(current[i], time - 1)) {
+                        int from = grid.index(b.x, b.y);
+                        int to = grid.index(a.x, a.y);
+                        split[0] = {i, from, to, time - 1};
+                        split[1] = {j, to, from, time - 1};
+                        collided = true;
+                    }
+                }
+            }
+        }
+        if (!collided) {
+            paths = current;
+            return true;
+        }
+
+        for (const Constraint& constraint : split) {
+            TreeNode child;
+            child.constraints = tree[nodeIndex].constraints;
+            child.constraints.push_back(constraint);
+            child.paths = tree[nodeIndex].paths;
+            int i = constraint.agent;
+            if (!constrainedSearch(grid, i, grid.index(agents[i].start.x, agents[i].start.y),
+                                   grid.index(agents[i].goal.x, agents[i].goal.y), child.constraints,
+                                   heuristics[i], child.paths[i])) {
+                continue;
+            }
+            child.cost = sumOfCosts(child.paths);
+            tree.push_back(std::move(child));
+            frontier.push({tree.back().cost, static_cast<int>(tree.size()) - 1});
+        }
+    }
+    return false;
+}
+
+bool MultiAgentPlanner::constrainedSearch(const Grid& grid, int agent, int startCell, int goalCell,
+                                          const std::vector<Constraint>& constraints,
+                                          const std::vector<int>& heuristic,
+                                          std::vector<sf::Vector2i>& path) {
+    // Every step takes one unit of time, so a node's cost is its time and
+    // (cell, time) pairs are the states
+    std::unordered_set<long long> blockedCells;
+    std::unordered_set<long long> blockedSteps;
+    int lastGoalBlock = -1;
+    for (const Constraint& constraint : constraints) {
+        if (constraint.agent != agent) {
+            continue;
+        }
+        if (constraint.to == -1) {
+            blockedCells.insert(static_cast<long long>(constraint.time) * cellCount + constraint.cell);
+            if (constraint.cell == goalCell) {
+                lastGoalBlock = std::max(lastGoalBlock, constraint.time);
+            }
+        } else {
+            blockedSteps.insert((static_cast<long long>(constraint.time) * cellCount + constraint.cell) * cellCount +
+                                constraint.to);
+        }
+    }
+    int timeLimit = lastGoalBlock + cellCount + 1;
+
+    struct Node {
+        int cell;
+        int parent;
+    };
+    std::vector<Node> nodes;
+    std::unordered_set<long long> seen;
+    open.clear();
+    auto visit = [&](int cell, int time, int from) {
+        long long key = static_cast<long long>(time) * cellCount + cell;
+        if (heuristic[cell] == INT_MAX || blockedCells.count(key) || !seen.insert(key).second) {
+            return;
+        }
+        nodes.push_back({cell, from});
+        pushOpen({static_cast<int>(nodes.size()) - 1, time, time + heuristic[cell]});
+    };
+    visit(startCell, 0, -1);
+
+    while (!open.empty()) {
+        OpenNode current = popOpen();
+        int cell = nodes[current.state].cell;
+        ++nodesExpanded;
+        if (cell == goalCell && current.cost > lastGoalBlock) {
+            path.assign(current.cost + 1, sf::Vector2i());
+            for (int node = current.state, time = current.cost; node != -1; node = nodes[node].parent, --time) {
+                path[time] = {grid.indexX(nodes[node].cell), grid.indexY(nodes[node].cell)};
+            }
+            return true;
+        }
+        if (current.cost >= timeLimit) {
+            continue;
+        }
+
+        int x = grid.indexX(cell);
+        int y = grid.indexY(cell);
+        for (auto& step : STEPS) {
+            int newX = x + step[0];
+            int newY = y + step[1];
+            if (!grid.isWalkable(newX, newY)) {
+                continue;
+            }
+            int next = grid.index(newX, newY);
+            if (blockedSteps.count((static_cast<long long>(current.cost) * cellCount + cell) * cellCount + next)) {
+                continue;
+            }
+            visit(next, current.cost + 1, current.state);
+        }
+    }
+    return false;
+}
+
+long long MultiAgentPlanner::sumOfCosts(const std::vector<std::vector<sf::Vector2i>>& paths) {
+    long long total = 0;
+    for (const std::vector<sf::Vector2i>& path : paths) {
+        // Time of the last arrival: trailing waits on the goal are free
+        std::size_t arrival = path.empty() ? 0 : path.size() - 1;
+        while (arrival > 0 && path[arrival - 1] == path.back()) {
+            --arrival;
+        }
+        total += static_cast<long long>(arrival);
+    }
+    return total;
+}
+
+int MultiAgentPlanner::countConflicts(const std::vector<std::vector<sf::Vector2i>>& paths) {
+    std::size_t horizon = 0;
+    for (const std::vector<sf::Vector2i>& path : paths) {
+        horizon = std::max(horizon, path.size());
+    }
+    auto at = [](const std::vector<sf::Vector2i>& path, std::size_t time) {
+        return path[std::min(time, path.size() - 1)];
+    };
+    auto key = [](sf::Vector2i cell) {
+        return (static_cast<unsigned long long>(static_cast<unsigned>(cell.x)) << 32) | static_cast<unsigned>(cell.y);
+    };
+
+    int conflicts = 0;
+    std::unordered_set<unsigned long long> occupied;
+    std::unordered_map<unsigned long long, unsigned long long> moves;
+    for (std::size_t time = 0; time < horizon; ++time) {
+        occupied.clear();
+        moves.clear();
+        for (const std::vector<sf::Vector2i>& path : paths) {
+            if (path.empty()) {
+                continue;
+            }
+            sf::Vector2i cell = at(path, time);
+            if (!occupied.insert(key(cell)).second) {
+                ++conflicts;
+            }
+            if (time > 0 && at(path, time - 1) != cell) {
+                // Someone already went the opposite way this step
+                auto reverse = moves.find(key(cell));
+                if (reverse != moves.end() && reverse->second == key(at(path, time - 1))) {
+                    ++conflicts;
+                }
+                moves[key(at(path, time - 1))] = key(cell);
+            }
+        }
+    }
+    return conflicts;
+}
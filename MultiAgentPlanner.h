@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <SFML/System/Vector2.hpp>
+#include "ComponentIndex.h"
+#include "Grid.h"
+
+// Plans paths for many agents on one grid so that no two of them ever
+// occupy the same cell at the same time step or swap cells in one step.
+//
+// Time is discrete: every step an agent moves to a 4-neighbour or waits,
+// and both take one step whatever the terrain. paths[i][t] is agent i's
+// cell at time t; once its path ends the agent stays on its goal.
+//
+// planCooperative is Windowed Hierarchical Cooperative A* (WHCA*). Agents
+// are planned one at a time, in a shuffled order every round, by a
+// space-time A* that avoids the cells already reserved by earlier agents
+// for the next `window` steps and ignores other agents beyond that. Each
+// agent then reserves its next `window` steps, the first `window / 2` are
+// executed, and the round repeats from the new positions. Beyond the window
+// the search only has to rejoin the agent's own shortest path, found once
+// up front. An agent boxed in by earlier reservations waits in place, and
+// whoever had planned to pass through its cell gives way and is replanned.
+//
+// planConflictBased is Conflict-Based Search (CBS): agents are planned on
+// their own and every collision found splits the search in two, forbidding
+// the cell (or the swap) to one agent or the other. It minimises the sum
+// of arrival times but grows exponentially with the number of collisions,
+// so it suits a handful of agents.
+class MultiAgentPlanner {
+public:
+    struct Agent {
+        sf::Vector2i start;
+        sf::Vector2i goal;
+    };
+
+    static const int DEFAULT_WINDOW = 16;
+    static const int DEFAULT_CBS_NODE_LIMIT = 20000;
+
+    MultiAgentPlanner();
+
+    // Returns false if some agent cannot reach its goal at all or has not
+    // arrived within the step limit; the paths returned are collision-free
+    // either way, short of a round where giving way cascades through more
+    // than one replan per agent
+    bool planCooperative(const Grid& grid, const std::vector<Agent>& agents,
+                         std::vector<std::vector<sf::Vector2i>>& paths,
+                         int window = DEFAULT_WINDOW, unsigned seed = 1);
+
+    // Returns false if no solution was found within nodeLimit splits
+    bool planConflictBased(const Grid& grid, const std::vector<Agent>& agents,
+                           std::vector<std::vector<sf::Vector2i>>& paths,
+                           int nodeLimit = DEFAULT_CBS_NODE_LIMIT);
+
+    // Sum over agents of the time each reaches its goal for the last time
+    static long long sumOfCosts(const std::vector<std::vector<sf::Vector2i>>& paths);
+
+    // Number of vertex and swap collisions between the paths
+    static int countConflicts(const std::vector<std::vector<sf::Vector2i>>& paths);
+
+    // Search nodes expanded by the last plan call
+    long long getNodesExpanded() const { return nodesExpanded; }
+
+private:
+    // A forbidden cell at time `time`, or with `to` set, a forbidden step
+    // from cell to `to` between time and time + 1
+    struct Constraint {
+        int agent;
+        int cell;
+        int to;
+        int time;
+    };
+
+    struct Reservation {
+        int agent;
+        unsigned stamp;
+    };
+
+    struct SearchState {
+        int cost;
+        int parent;
+        unsigned stamp;
+    };
+
+    struct OpenNode {
+        int state;
+        int cost;
+        int estimate;
+    };
+
+    bool reachable(const Grid& grid, const std::vector<Agent>& agents);
+    int owner(int cell, int step) const;
+    void reserve(int cell, int step, int agent);
+    void release(int cell, int step, int agent);
+    bool guideSearch(const Grid& grid, int startCell, int goalCell, std::vector<int>& guide);
+    bool windowSearch(const Grid& grid, int agent, int startCell, int goalCell,
+                      const std::vector<int>& guide, std::vector<int>& trajectory);
+    bool constrainedSearch(const Grid& grid, int agent, int startCell, int goalCell,
+                           const std::vector<Constraint>& constraints,
+                           const std::vector<int>& heuristic,
+                           std::vector<sf::Vector2i>& path);
+    void pushOpen(const OpenNode& node);
+    OpenNode popOpen();
+
+    int window;
+    int cellCount;
+
+    // Reservation table indexed by step * cellCount + cell, valid where the
+    // stamp matches the current round
+    std::vector<Reservation> reservations;
+    unsigned round;
+
+    // Space-time search state over `window + 1` layers, the last one
+    // standing for every step beyond the window
+    std::vector<SearchState> states;
+    unsigned searchGeneration;
+    std::vector<OpenNode> open;
+
+    // Each agent's shortest path ignoring the others, and for the agent
+    // being planned, the steps left from each of its cells
+    std::vector<std::vector<int>> guides;
+    std::vector<unsigned> guideStamp;
+    std::vector<int> guideRemaining;
+
+    ComponentIndex components;
+    long long nodesExpanded;
+};
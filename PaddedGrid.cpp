@@ -0,0 +1,25 @@
+#include "PaddedGrid.h"
+
+PaddedGrid::PaddedGrid() : rows(0), cols(0), stride(0), revision(0), built(false) {}
+
+void PaddedGrid::build(const Grid& grid) {
+    rows = grid.getRows();
+    cols = grid.getCols();
+    stride = cols + 2;
+
+    // assign() keeps the capacity, so rebuilding for a map of the same size
+    // does not allocate
+    blocked.assign(static_cast<std::size_t>(rows + 2) * stride, 1);
+    costs.assign(static_cast<std::size_t>(rows + 2) * stride, Constants::MIN_TERRAIN_COST);
+    for (int y = 0; y < rows; ++y) {
+        const Grid::Cell* row = grid.row(y);
+        std::uint8_t* blockedRow = blocked.data() + index(0, y);
+        std::uint8_t* costRow = costs.data() + index(0, y);
+        for (int x = 0; x < cols; ++x) {
+            blockedRow[x] = row[x] == Constants::WALL;
+            costRow[x] = static_cast<std::uint8_t>(grid.cost(x, y));
+        }
+    }
+    revision = grid.getRevision();
+    built = true;
+}
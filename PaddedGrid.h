@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "Grid.h"
+
+// A copy of a Grid's walls and terrain costs inside a one-cell border of
+// walls, so a search can look at every neighbour of a cell it has reached
+// without checking bounds first. Cell (x, y) lives at
+// (y + 1) * stride + x + 1 with stride = cols + 2; a neighbour is the cell's
+// index plus a fixed offset.
+//
+// The copy remembers the revision it was taken from. A SearchWorkspace
+// keeps one and only rebuilds it when the grid has changed, so repeated
+// queries against the same map pay for it once.
+class PaddedGrid {
+public:
+    PaddedGrid();
+
+    void build(const Grid& grid);
+    bool isCurrent(const Grid& grid) const {
+        return built && revision == grid.getRevision() && rows == grid.getRows() && cols == grid.getCols();
+    }
+
+    int getStride() const { return stride; }
+    int getSize() const { return (rows + 2) * stride; }
+
+    int index(int x, int y) const { return (y + 1) * stride + x + 1; }
+    int indexX(int index) const { return index % stride - 1; }
+    int indexY(int index) const { return index / stride - 1; }
+
+    // Walls and the border are blocked
+    bool isBlocked(int index) const { return blocked[index] != 0; }
+    int cost(int index) const { return costs[index]; }
+
+private:
+    int rows;
+    int cols;
+    int stride;
+    std::vector<std::uint8_t> blocked;
+    std::vector<std::uint8_t> costs;
+    std::uint64_t revision;
+    bool built;
+};
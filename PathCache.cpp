@@ -0,0 +1,52 @@
+#include "PathCache.h"
+#include <algorithm>
+
+PathCache::PathCache(std::size_t capacity)
+    : entries(std::max<std::size_t>(capacity, 1)), used(0), clock(0), hits(0), misses(0) {}
+
+const PathCache::Entry* PathCache::find(const Key& key) {
+    for (std::size_t i = 0; i < used; ++i) {
+        if (entries[i].key == key) {
+            entries[i].lastUse = ++clock;
+            ++hits;
+            return &entries[i];
+        }
+    }
+    ++misses;
+    return nullptr;
+}
+
+void PathCache::store(const Key& key, bool found, const std::vector<sf::Vector2i>& path, const SearchStats& stats) {
+    // Overwrite the same key if present, otherwise take a free slot, otherwise
+    // the least recently used one
+    std::size_t slot = used;
+    for (std::size_t i = 0; i < used; ++i) {
+        if (entries[i].key == key) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot == used) {
+        if (used < entries.size()) {
+            ++used;
+        } else {
+            slot = 0;
+            for (std::size_t i = 1; i < used; ++i) {
+                if (entries[i].lastUse < entries[slot].lastUse) {
+                    slot = i;
+                }
+            }
+        }
+    }
+
+    Entry& entry = entries[slot];
+    entry.key = key;
+    entry.found = found;
+    entry.path.assign(path.begin(), path.end());
+    entry.stats = stats;
+    entry.lastUse = ++clock;
+}
+
+void PathCache::clear() {
+    used = 0;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <SFML/System/Vector2.hpp>
+#include "Constants.h"
+#include "Movement.h"
+#include "SearchStats.h"
+
+// Small LRU cache of finished searches, keyed on the grid revision, the
+// algorithm (and heuristic), the movement rules and the endpoints. Any edit
+// bumps the grid's revision, so stale entries can never match; they simply
+// age out.
+//
+// Entries live in a flat array that is scanned linearly: with a few dozen
+// slots that is a handful of cache lines, cheaper than hashing, and once
+// every slot has been filled, storing a path reuses the slot's vector
+// instead of allocating.
+class PathCache {
+public:
+    struct Key {
+        std::uint64_t revision;
+        Constants::AlgorithmType algorithm;
+        Constants::HeuristicType heuristic;
+        Movement movement;
+        sf::Vector2i start;
+        sf::Vector2i goal;
+
+        bool operator==(const Key& other) const {
+            return revision == other.revision && algorithm == other.algorithm &&
+                   heuristic == other.heuristic && movement == other.movement && start == other.start &&
+                   goal == other.goal;
+        }
+    };
+
+    struct Entry {
+        Key key;
+        bool found;
+        std::vector<sf::Vector2i> path;
+        SearchStats stats; // Counters of the search that produced the entry
+        std::uint64_t lastUse;
+    };
+
+    static const std::size_t DEFAULT_CAPACITY = 32;
+
+    explicit PathCache(std::size_t capacity = DEFAULT_CAPACITY);
+
+    // The cached result for `key`, or nullptr. Counts a hit or a miss and
+    // marks a hit as most recently used.
+    const Entry* find(const Key& key);
+
+    // Stores a result, evicting the least recently used entry when full
+    void store(const Key& key, bool found, const std::vector<sf::Vector2i>& path, const SearchStats& stats);
+
+    // Drops every entry; the hit and miss counters are kept
+    void clear();
+
+    std::size_t size() const { return used; }
+    std::size_t getCapacity() const { return entries.size(); }
+    long long getHits() const { return hits; }
+    long long getMisses() const { return misses; }
+
+private:
+    std::vector<Entry> entries;
+    std::size_t used;
+    std::uint64_t clock;
+    long long hits;
+    long long misses;
+};
@@ -1,20 +1,24 @@
 #include "PathfindingVisualizer.h"
+#include <algorithm>
 #include <iostream>
+#include <cmath>
+#include <cstdio>
+#include "AllocationCounter.h"
+#include "MapGenerator.h"
+#include "MapLoader.h"
+#include "Trace.h"
 
 PathfindingVisualizer::PathfindingVisualizer() :
+    grid(Constants::ROWS, Constants::COLS, Constants::EMPTY),
     startCell(-1, -1),
     goalCell(-1, -1),
     stage(1),
     pathFound(false),
     currentAlgorithm(Constants::DFS),
-    executionTime(0) {
-
-    // Initialize grid
-    for (int y = 0; y < Constants::ROWS; ++y) {
-        for (int x = 0; x < Constants::COLS; ++x) {
-            grid[y][x] = Constants::EMPTY;
-        }
-    }
+    currentHeuristic(Constants::MANHATTAN),
+    executionTime(0),
+    resultSource(SEARCHED),
+    timingMode(false) {
 
     // Load font
     if (!font.loadFromFile("DejaVuSans-Bold.ttf")) {
@@ -36,9 +40,22 @@ void PathfindingVisualizer::setupUI() {
 
     // Time text - positioned in bottom bar
     timeText = UIComponents::createText(font, "", 16, sf::Color::Black,
-                                       Constants::WINDOW_WIDTH - 250,
+                                       Constants::WINDOW_WIDTH - 300,
                                        Constants::TOP_BAR_HEIGHT + Constants::ROWS * Constants::TILE_SIZE + 10);
 
+    // Search counters - second line of the bottom bar, under the time
+    statsText = UIComponents::createText(font, "", 14, sf::Color::Black,
+                                        Constants::WINDOW_WIDTH - 300,
+                                        Constants::TOP_BAR_HEIGHT + Constants::ROWS * Constants::TILE_SIZE + 34);
+
+    // Open-list, path and allocation counters - third line, full width
+    detailText = UIComponents::createText(font, "", 12, sf::Color::Black,
+                                         10, Constants::TOP_BAR_HEIGHT + Constants::ROWS * Constants::TILE_SIZE + 56);
+
+    // Movement rules - second line of the bottom bar, under the status
+    movementText = UIComponents::createText(font, "", 14, sf::Color::Black,
+                                           10, Constants::TOP_BAR_HEIGHT + Constants::ROWS * Constants::TILE_SIZE + 34);
+
     // Find Path button
     findPathButton = UIComponents::createButton(10, 10, 130, 40, sf::Color::Green, sf::Color(0, 100, 0));
     findPathButtonText = UIComponents::createText(font, "Find Path", 16, sf::Color::White, 30, 20);
@@ -52,7 +69,7 @@ void PathfindingVisualizer::setupUI() {
     // Algorithm selection button
     algorithmButton = UIComponents::createButton(Constants::WINDOW_WIDTH - 160, 10, 150, 40,
                                                sf::Color::Blue, sf::Color(0, 0, 139));
-    algorithmButtonText = UIComponents::createText(font, "Algorithm: DFS", 16, sf::Color::White,
+    algorithmButtonText = UIComponents::createText(font, "DFS", 16, sf::Color::White,
                                                  Constants::WINDOW_WIDTH - 150, 20);
 }
 
@@ -79,23 +96,121 @@ void PathfindingVisualizer::updateUI() {
         case Constants::DFS: algoName = "DFS"; break;
         case Constants::BFS: algoName = "BFS"; break;
         case Constants::DIJKSTRA: algoName = "Dijkstra"; break;
+        case Constants::ASTAR:
+            switch (currentHeuristic) {
+                case Constants::MANHATTAN: algoName = "A* Manhattan"; break;
+                case Constants::OCTILE: algoName = "A* Octile"; break;
+                case Constants::EUCLIDEAN: algoName = "A* Euclidean"; break;
+            }
+            break;
+        case Constants::ALT: algoName = "ALT"; break;
+        case Constants::ARA_STAR: algoName = "ARA*"; break;
+        case Constants::JPS: algoName = "JPS"; break;
+        case Constants::JPS_PLUS: algoName = "JPS+"; break;
+        case Constants::BIDIRECTIONAL_BFS: algoName = "Bi-BFS"; break;
+        case Constants::BIDIRECTIONAL_DIJKSTRA: algoName = "Bi-Dijkstra"; break;
+        case Constants::BIT_PARALLEL_BFS: algoName = "Bit BFS"; break;
+        case Constants::DIRECTION_OPTIMIZING_BFS: algoName = "DO-BFS"; break;
+        case Constants::HPA_STAR: algoName = "HPA*"; break;
+        case Constants::CONTRACTION_HIERARCHY: algoName = "CH"; break;
+        case Constants::D_STAR_LITE: algoName = "D* Lite"; break;
+        case Constants::FLOW_FIELD: algoName = "Flow Field"; break;
+        case Constants::COOPERATIVE_ASTAR: algoName = "WHCA*"; break;
+        case Constants::CONFLICT_BASED_SEARCH: algoName = "CBS"; break;
     }
-    algorithmButtonText.setString("Algorithm: " + algoName);
+    // The heuristic names do not fit next to an "Algorithm: " prefix
+    algorithmButtonText.setString(algoName);
+
+    // The other searches ignore the setting, so say so rather than show
+    // a mode they are not using
+    std::string moves = supportsMovement() || movement.connectivity == Constants::FOUR_CONNECTED
+                            ? movement.name() : "4-way only";
+    movementText.setString("Moves: " + moves + " (M)");
 
     // Update time text
+    timeText.setCharacterSize(resultSource == TIMED && stage == 4 ? 12 : 16);
     if (stage == 4) {
-        timeText.setString("Execution time: " + std::to_string(executionTime) + " ms");
+        switch (resultSource) {
+            case SEARCHED:
+                timeText.setString("Execution time: " + std::to_string(executionTime) + " ms");
+                if (currentAlgorithm == Constants::ARA_STAR && pathFound) {
+                    // How far above optimal the path may be; the full
+                    // prefix would not fit next to it
+                    char bound[16];
+                    std::snprintf(bound, sizeof(bound), "%.2f", searchStats.suboptimalityBound);
+                    timeText.setString("Time: " + std::to_string(executionTime) + " ms, bound " + bound);
+                }
+                break;
+            case REPLANNED:
+                timeText.setString("Replan time: " + std::to_string(executionTime) + " ms");
+                break;
+            case CACHED:
+                timeText.setString("Cache hit: " + std::to_string(static_cast<int>(executionTime * 1e6f)) + " ns");
+                break;
+            case TIMED: {
+                // Microseconds unless the median is a millisecond or more
+                bool micro = timing.median < 1.0;
+                double scale = micro ? 1000.0 : 1.0;
+                char summary[96];
+                std::snprintf(summary, sizeof(summary), "min/med/p99 %.*f/%.*f/%.*f %s, n=%d%s",
+                              micro ? 1 : 2, timing.minimum * scale, micro ? 1 : 2, timing.median * scale,
+                              micro ? 1 : 2, timing.p99 * scale, micro ? "us" : "ms", timing.iterations,
+                              timing.converged ? "" : "+");
+                timeText.setString(summary);
+                break;
+            }
+        }
+
+        std::string counters = "Expanded: " + std::to_string(searchStats.nodesExpanded);
+        if (currentAlgorithm == Constants::BIDIRECTIONAL_BFS ||
+            currentAlgorithm == Constants::BIDIRECTIONAL_DIJKSTRA) {
+            counters += " | Frontiers: " + std::to_string(searchStats.forwardFrontier) +
+                        " / " + std::to_string(searchStats.backwardFrontier);
+        }
+        if (currentAlgorithm == Constants::DIRECTION_OPTIMIZING_BFS) {
+            counters += " | Bottom-up levels: " + std::to_string(searchStats.bottomUpLevels);
+        }
+        if (currentAlgorithm == Constants::ARA_STAR) {
+            counters += " | Paths: " + std::to_string(searchStats.solutions);
+        }
+        counters += " | Cache: " + std::to_string(pathCache.getHits()) + " hit / " +
+                    std::to_string(pathCache.getMisses()) + " miss";
+        statsText.setString(counters);
+
+        // The multi-agent planners only count expansions
+        std::string details;
+        if (SearchStats::ENABLED && !isMultiAgent()) {
+            long long bytes = searchStats.bytesAllocated;
+            details = "Generated: " + std::to_string(searchStats.nodesGenerated) + " (" +
+                      std::to_string(searchStats.duplicatePushes) + " dup) | Open max: " +
+                      std::to_string(searchStats.peakOpen) + " | Path: " + std::to_string(searchStats.pathLength) +
+                      " steps, cost " + std::to_string(searchStats.pathCost);
+            if (AllocationCounter::isActive()) {
+                details += " | Alloc: " +
+                           (bytes < 10240 ? std::to_string(bytes) + " B" : std::to_string(bytes / 1024) + " KiB");
+            }
+        }
+        detailText.setString(details);
     } else {
         timeText.setString("");
+        statsText.setString("");
+        detailText.setString("");
     }
 }
 
 void PathfindingVisualizer::reset() {
-    for (int y = 0; y < Constants::ROWS; ++y) {
-        for (int x = 0; x < Constants::COLS; ++x) {
-            grid[y][x] = Constants::EMPTY;
-        }
-    }
+    grid.fill(Constants::EMPTY);
+    grid.fillCosts(Constants::MIN_TERRAIN_COST);
+    jumpTable.clear();
+    wallBitmap.clear();
+    landmarks.clear();
+    hierarchy.clear();
+    contraction.clear();
+    components.clear();
+    planner.clear();
+    flowField.clear();
+    team.clear();
+    teamPaths.clear();
     startCell = {-1, -1};
     goalCell = {-1, -1};
     path.clear();
@@ -103,49 +218,254 @@ void PathfindingVisualizer::reset() {
     pathFound = false;
     statusMessage = "";
     executionTime = 0;
+    resultSource = SEARCHED;
+    pathCache.clear();
+    searchStats.reset();
     updateUI();
 }
 
 void PathfindingVisualizer::findPath() {
+    TRACE_SCOPE("findPath");
     if (startCell.x == -1 || goalCell.x == -1) {
         statusMessage = "Set start and goal cells first!";
         return;
     }
 
+    // Nothing that affects the answer has changed since a cached run, so
+    // its result is reused as is. The cache only holds the user's own path,
+    // so team plans are always redone.
+    PathCache::Key key = cacheKey();
+    auto lookupTime = std::chrono::steady_clock::now();
+    const PathCache::Entry* cached = isMultiAgent() || timingMode ? nullptr : pathCache.find(key);
+    if (timingMode) {
+        // Every run starts from nothing, as the first search of a new
+        // start and goal would, or D* Lite and the flow field would only
+        // be timed reusing their first run's work
+        timing = AdaptiveTimer::run(timingSettings, [&]() {
+            planner.clear();
+            flowField.clear();
+            runSearch();
+        });
+        executionTime = static_cast<float>(timing.median);
+        resultSource = TIMED;
+        if (!isMultiAgent() && !searchStats.timedOut) {
+            pathCache.store(key, pathFound, path, searchStats);
+        }
+    } else if (cached) {
+        path.assign(cached->path.begin(), cached->path.end());
+        pathFound = cached->found;
+        searchStats = cached->stats;
+        std::chrono::duration<float, std::milli> duration = std::chrono::steady_clock::now() - lookupTime;
+        executionTime = duration.count();
+        resultSource = CACHED;
+    } else {
+        // An ARA* search that ran out of time may succeed next time, so it
+        // is not cached
+        runSearch();
+        if (!isMultiAgent() && !searchStats.timedOut) {
+            pathCache.store(key, pathFound, path, searchStats);
+        }
+    }
+
+    statusMessage = pathFound              ? "Path found!"
+                    : searchStats.timedOut ? "No path before the deadline!"
+                                           : "No path exists!";
+    if (isMultiAgent()) {
+        statusMessage = pathFound ? std::to_string(team.size()) + " agents, no collisions" : "No plan found!";
+        playbackStart = std::chrono::steady_clock::now();
+    }
+
+    // These searches treat every step as cost 1 whatever the terrain says
+    bool uniformCostOnly = currentAlgorithm == Constants::DFS || currentAlgorithm == Constants::BFS ||
+                           currentAlgorithm == Constants::JPS || currentAlgorithm == Constants::JPS_PLUS ||
+                           currentAlgorithm == Constants::BIDIRECTIONAL_BFS ||
+                           currentAlgorithm == Constants::BIT_PARALLEL_BFS ||
+                           currentAlgorithm == Constants::DIRECTION_OPTIMIZING_BFS || isMultiAgent();
+    if (pathFound && uniformCostOnly && !grid.hasUniformCost()) {
+        statusMessage = "Path found (unit costs)";
+    }
+    stage = 4;
+    updateUI();
+}
+
+PathCache::Key PathfindingVisualizer::cacheKey() const {
+    // Only A* depends on the heuristic
+    Constants::HeuristicType heuristic = currentAlgorithm == Constants::ASTAR ? currentHeuristic : Constants::MANHATTAN;
+    return {grid.getRevision(), currentAlgorithm, heuristic, supportsMovement() ? movement : Movement(),
+            startCell, goalCell};
+}
+
+void PathfindingVisualizer::runSearch() {
     path.clear();
+    searchStats.reset();
+
+    // The JPS+ table, the landmark distances, the wall bitmap, the HPA* and
+    // contraction hierarchies and the component labels are preprocessing,
+    // so keep them out of the measured time
+    {
+        TRACE_SCOPE("setup");
+        if (currentAlgorithm == Constants::JPS_PLUS && !jumpTable.isBuilt()) {
+            jumpTable.build(grid);
+        }
+        if (currentAlgorithm == Constants::ALT && !landmarks.isCurrent(grid)) {
+            landmarks.build(grid, Constants::ALT_LANDMARKS);
+        }
+        if (currentAlgorithm == Constants::BIT_PARALLEL_BFS && !wallBitmap.isBuilt()) {
+            wallBitmap.build(grid);
+        }
+        if (currentAlgorithm == Constants::HPA_STAR && !hierarchy.isBuilt()) {
+            hierarchy.build(grid, Constants::HPA_CLUSTER_SIZE);
+        }
+        if (currentAlgorithm == Constants::CONTRACTION_HIERARCHY && !contraction.isCurrent(grid)) {
+            contraction.build(grid);
+        }
+        if (!components.isBuilt()) {
+            components.build(grid);
+        }
+        if (isMultiAgent()) {
+            buildTeam();
+        }
+    }
+    resultSource = SEARCHED;
+
+    TRACE_SCOPE("search");
     auto startTime = std::chrono::steady_clock::now();
 
+    // A goal in another component is unreachable whatever the algorithm,
+    // unless diagonal steps may squeeze between walls the labels keep apart
+    bool squeezes = supportsMovement() && movement.joinsFourConnectedRegions();
+    if (!squeezes && !components.connected(grid.index(startCell.x, startCell.y), grid.index(goalCell.x, goalCell.y))) {
+        pathFound = false;
+        std::chrono::duration<float, std::milli> duration = std::chrono::steady_clock::now() - startTime;
+        executionTime = duration.count();
+        return;
+    }
+
     switch (currentAlgorithm) {
         case Constants::DFS:
-            pathFound = Algorithms::depthFirstSearch(grid, startCell, goalCell, path);
+            pathFound = Algorithms::depthFirstSearch(grid, startCell, goalCell, path, workspace, &searchStats, movement);
             break;
         case Constants::BFS:
-            pathFound = Algorithms::breadthFirstSearch(grid, startCell, goalCell, path);
+            pathFound = Algorithms::breadthFirstSearch(grid, startCell, goalCell, path, workspace, &searchStats, movement);
             break;
         case Constants::DIJKSTRA:
-            pathFound = Algorithms::dijkstraAlgorithm(grid, startCell, goalCell, path);
+            pathFound = Algorithms::dijkstraAlgorithm(grid, startCell, goalCell, path, workspace, &searchStats, movement);
+            break;
+        case Constants::ASTAR:
+            pathFound = Algorithms::aStarSearch(grid, startCell, goalCell, path, workspace, currentHeuristic, &searchStats, movement);
+            break;
+        case Constants::ALT:
+            pathFound = Algorithms::landmarkSearch(grid, landmarks, startCell, goalCell, path, workspace, &searchStats);
+            break;
+        case Constants::ARA_STAR:
+            pathFound = Algorithms::anytimeSearch(grid, startCell, goalCell, path, workspace,
+                                                  startTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                      std::chrono::duration<float, std::milli>(Constants::ARA_DEADLINE_MS)),
+                                                  &searchStats);
+            break;
+        case Constants::JPS:
+            pathFound = Algorithms::jumpPointSearch(grid, startCell, goalCell, path, workspace, &searchStats);
+            break;
+        case Constants::JPS_PLUS:
+            pathFound = Algorithms::jumpPointSearchPlus(grid, jumpTable, startCell, goalCell, path, workspace, &searchStats);
+            break;
+        case Constants::BIDIRECTIONAL_BFS:
+            pathFound = Algorithms::bidirectionalBreadthFirstSearch(grid, startCell, goalCell, path, workspace, &searchStats);
+            break;
+        case Constants::BIDIRECTIONAL_DIJKSTRA:
+            pathFound = Algorithms::bidirectionalDijkstra(grid, startCell, goalCell, path, workspace, &searchStats);
+            break;
+        case Constants::BIT_PARALLEL_BFS:
+            pathFound = Algorithms::bitParallelBreadthFirstSearch(wallBitmap, startCell, goalCell, path, workspace, &searchStats);
+            break;
+        case Constants::DIRECTION_OPTIMIZING_BFS:
+            pathFound = Algorithms::directionOptimizingBreadthFirstSearch(grid, startCell, goalCell, path, workspace, &searchStats);
+            break;
+        case Constants::HPA_STAR:
+            pathFound = Algorithms::hierarchicalSearch(grid, hierarchy, startCell, goalCell, path, workspace, &searchStats);
+            break;
+        case Constants::CONTRACTION_HIERARCHY:
+            pathFound = Algorithms::contractionHierarchySearch(grid, contraction, startCell, goalCell, path, workspace, &searchStats);
+            break;
+        case Constants::D_STAR_LITE:
+            // The planner stays initialized across edits, so a repeat search
+            // only repairs what changed since the last one
+            if (!planner.isInitialized() || planner.getStart() != startCell || planner.getGoal() != goalCell) {
+                planner.initialize(grid, startCell, goalCell);
+            }
+            pathFound = planner.replan(grid, path, &searchStats);
+            break;
+        case Constants::FLOW_FIELD:
+            // One field from the goal serves every start; it is kept up to
+            // date through edits, so it is only built once per goal
+            if (!flowField.isCurrent(grid, goalCell)) {
+                flowField.build(grid, goalCell, &searchStats);
+            }
+            pathFound = flowField.followPath(grid, startCell, path);
+            searchStats.recordPath(&grid, path);
+            break;
+        case Constants::COOPERATIVE_ASTAR:
+        case Constants::CONFLICT_BASED_SEARCH:
+            pathFound = currentAlgorithm == Constants::COOPERATIVE_ASTAR
+                            ? agentPlanner.planCooperative(grid, team, teamPaths)
+                            : agentPlanner.planConflictBased(grid, team, teamPaths);
+            searchStats.nodesExpanded = static_cast<int>(agentPlanner.getNodesExpanded());
+            if (pathFound) {
+                path = teamPaths[0];
+            } else {
+                teamPaths.clear();
+            }
             break;
     }
 
     auto endTime = std::chrono::steady_clock::now();
     std::chrono::duration<float, std::milli> duration = endTime - startTime;
     executionTime = duration.count();
-
-    statusMessage = pathFound ? "Path found!" : "No path exists!";
-    stage = 4;
-    updateUI();
 }
 
 void PathfindingVisualizer::cycleAlgorithm() {
     switch (currentAlgorithm) {
         case Constants::DFS: currentAlgorithm = Constants::BFS; break;
         case Constants::BFS: currentAlgorithm = Constants::DIJKSTRA; break;
-        case Constants::DIJKSTRA: currentAlgorithm = Constants::DFS; break;
+        case Constants::DIJKSTRA:
+            currentAlgorithm = Constants::ASTAR;
+            currentHeuristic = Constants::MANHATTAN;
+            break;
+        case Constants::ASTAR:
+            // Step through every heuristic before wrapping back to DFS
+            switch (currentHeuristic) {
+                case Constants::MANHATTAN: currentHeuristic = Constants::OCTILE; break;
+                case Constants::OCTILE: currentHeuristic = Constants::EUCLIDEAN; break;
+                case Constants::EUCLIDEAN: currentAlgorithm = Constants::ALT; break;
+            }
+            break;
+        case Constants::ALT: currentAlgorithm = Constants::ARA_STAR; break;
+        case Constants::ARA_STAR: currentAlgorithm = Constants::JPS; break;
+        case Constants::JPS: currentAlgorithm = Constants::JPS_PLUS; break;
+        case Constants::JPS_PLUS: currentAlgorithm = Constants::BIDIRECTIONAL_BFS; break;
+        case Constants::BIDIRECTIONAL_BFS: currentAlgorithm = Constants::BIDIRECTIONAL_DIJKSTRA; break;
+        case Constants::BIDIRECTIONAL_DIJKSTRA: currentAlgorithm = Constants::BIT_PARALLEL_BFS; break;
+        case Constants::BIT_PARALLEL_BFS: currentAlgorithm = Constants::DIRECTION_OPTIMIZING_BFS; break;
+        case Constants::DIRECTION_OPTIMIZING_BFS: currentAlgorithm = Constants::HPA_STAR; break;
+        case Constants::HPA_STAR: currentAlgorithm = Constants::CONTRACTION_HIERARCHY; break;
+        case Constants::CONTRACTION_HIERARCHY: currentAlgorithm = Constants::D_STAR_LITE; break;
+        case Constants::D_STAR_LITE: currentAlgorithm = Constants::FLOW_FIELD; break;
+        case Constants::FLOW_FIELD: currentAlgorithm = Constants::COOPERATIVE_ASTAR; break;
+        case Constants::COOPERATIVE_ASTAR: currentAlgorithm = Constants::CONFLICT_BASED_SEARCH; break;
+        case Constants::CONFLICT_BASED_SEARCH: currentAlgorithm = Constants::DFS; break;
     }
     updateUI();
 }
 
+void PathfindingVisualizer::setAlgorithm(Constants::AlgorithmType algorithm,
+                                         Constants::HeuristicType heuristic) {
+    currentAlgorithm = algorithm;
+    currentHeuristic = heuristic;
+    updateUI();
+}
+
 void PathfindingVisualizer::handleMouseClick(int mouseX, int mouseY) {
+    TRACE_SCOPE("handleMouseClick");
     // Check if buttons were clicked
     if (UIComponents::isButtonClicked(resetButton, mouseX, mouseY)) {
         reset();
@@ -167,13 +487,13 @@ void PathfindingVisualizer::handleMouseClick(int mouseX, int mouseY) {
         int gridX = mouseX / Constants::TILE_SIZE;
         int gridY = (mouseY - Constants::TOP_BAR_HEIGHT) / Constants::TILE_SIZE;
 
-        if (gridX >= 0 && gridX < Constants::COLS && gridY >= 0 && gridY < Constants::ROWS) {
+        if (grid.isValidCell(gridX, gridY)) {
             switch (stage) {
                 case 1: // Set start cell
                     if (startCell.x != -1) {
-                        grid[startCell.y][startCell.x] = Constants::EMPTY;
+                        grid.set(startCell.x, startCell.y, Constants::EMPTY);
                     }
-                    grid[gridY][gridX] = Constants::START;
+                    grid.set(gridX, gridY, Constants::START);
                     startCell = {gridX, gridY};
                     stage = 2;
                     break;
@@ -183,9 +503,9 @@ void PathfindingVisualizer::handleMouseClick(int mouseX, int mouseY) {
                         return; // Can't set goal same as start
                     }
                     if (goalCell.x != -1) {
-                        grid[goalCell.y][goalCell.x] = Constants::EMPTY;
+                        grid.set(goalCell.x, goalCell.y, Constants::EMPTY);
                     }
-                    grid[gridY][gridX] = Constants::GOAL;
+                    grid.set(gridX, gridY, Constants::GOAL);
                     goalCell = {gridX, gridY};
                     stage = 3;
                     break;
@@ -196,19 +516,167 @@ void PathfindingVisualizer::handleMouseClick(int mouseX, int mouseY) {
                         (gridY == goalCell.y && gridX == goalCell.x)) {
                         return; // Can't modify start or goal
                     }
-                    grid[gridY][gridX] = (grid[gridY][gridX] == Constants::WALL) ? Constants::EMPTY : Constants::WALL;
-                    if (stage == 4) {
-                        path.clear(); // Clear the path if walls change
-                        stage = 3;
-                    }
+                    grid.set(gridX, gridY, grid.isWall(gridX, gridY) ? Constants::EMPTY : Constants::WALL);
+                    jumpTable.clear();
+                    wallBitmap.clear();
+                    applyEdit(gridX, gridY);
+                    break;
+            }
+            updateUI();
+        }
+    }
+}
+
+void PathfindingVisualizer::handleRightClick(int mouseX, int mouseY) {
+    // Right-clicking a free cell steps its terrain cost through the presets
+    if (mouseY >= Constants::TOP_BAR_HEIGHT && mouseY < (Constants::TOP_BAR_HEIGHT + Constants::ROWS * Constants::TILE_SIZE)) {
+        int gridX = mouseX / Constants::TILE_SIZE;
+        int gridY = (mouseY - Constants::TOP_BAR_HEIGHT) / Constants::TILE_SIZE;
+
+        if (grid.isValidCell(gridX, gridY) && !grid.isWall(gridX, gridY)) {
+            int preset = 0;
+            for (int i = 0; i < Constants::TERRAIN_PRESET_COUNT; ++i) {
+                if (Constants::TERRAIN_PRESETS[i] == grid.cost(gridX, gridY)) {
+                    preset = (i + 1) % Constants::TERRAIN_PRESET_COUNT;
                     break;
+                }
             }
+            grid.setCost(gridX, gridY, Constants::TERRAIN_PRESETS[preset]);
+            applyEdit(gridX, gridY);
             updateUI();
         }
     }
 }
 
+void PathfindingVisualizer::applyEdit(int x, int y) {
+    // Only the clusters around the cell, the components next to it, the
+    // planner's inconsistent cells and the flow field's affected branch need
+    // redoing
+    hierarchy.updateCell(grid, x, y);
+    components.updateCell(grid, x, y);
+    planner.updateCell(grid, x, y);
+
+    bool replanPlanner = currentAlgorithm == Constants::D_STAR_LITE && stage == 4 && planner.isInitialized();
+    bool followField = currentAlgorithm == Constants::FLOW_FIELD && stage == 4 && flowField.isBuilt();
+    auto startTime = std::chrono::steady_clock::now();
+    flowField.updateCell(grid, x, y, followField ? &searchStats : nullptr);
+
+    if (!replanPlanner && !followField) {
+        invalidatePath(); // Clear the path if the map changes
+        return;
+    }
+
+    // D* Lite and the flow field repair what they had, so the path stays on
+    // screen and the time shown is the latency of this one edit
+    if (replanPlanner) {
+        pathFound = planner.replan(grid, path, &searchStats);
+    } else {
+        pathFound = flowField.followPath(grid, startCell, path);
+        searchStats.recordPath(&grid, path);
+    }
+    std::chrono::duration<float, std::milli> duration = std::chrono::steady_clock::now() - startTime;
+    executionTime = duration.count();
+    resultSource = REPLANNED;
+    pathCache.store(cacheKey(), pathFound, path, searchStats);
+    statusMessage = pathFound ? "Replanned!" : "No path exists!";
+}
+
+void PathfindingVisualizer::invalidatePath() {
+    if (stage == 4) {
+        path.clear();
+        teamPaths.clear();
+        stage = 3;
+    }
+}
+
+bool PathfindingVisualizer::supportsMovement() const {
+    return currentAlgorithm == Constants::DFS || currentAlgorithm == Constants::BFS ||
+           currentAlgorithm == Constants::DIJKSTRA || currentAlgorithm == Constants::ASTAR;
+}
+
+void PathfindingVisualizer::cycleMovement() {
+    if (movement.connectivity == Constants::FOUR_CONNECTED) {
+        movement = Movement(Constants::EIGHT_CONNECTED, Constants::CUT_CORNERS);
+    } else if (movement.corners == Constants::CUT_CORNERS) {
+        movement = Movement(Constants::EIGHT_CONNECTED, Constants::NO_SQUEEZE);
+    } else if (movement.corners == Constants::NO_SQUEEZE) {
+        movement = Movement(Constants::EIGHT_CONNECTED, Constants::NO_CUT_CORNERS);
+    } else {
+        movement = Movement();
+    }
+    // The path on screen may take steps the new rules forbid
+    if (supportsMovement()) {
+        invalidatePath();
+    }
+    updateUI();
+}
+
+void PathfindingVisualizer::toggleTimingMode() {
+    timingMode = !timingMode;
+    // Show the path on screen timed the new way
+    if (stage == 4) {
+        findPath();
+    }
+}
+
+void PathfindingVisualizer::setTimingBudget(double milliseconds) {
+    timingSettings.budgetMilliseconds = milliseconds;
+}
+
+bool PathfindingVisualizer::isMultiAgent() const {
+    return currentAlgorithm == Constants::COOPERATIVE_ASTAR || currentAlgorithm == Constants::CONFLICT_BASED_SEARCH;
+}
+
+void PathfindingVisualizer::buildTeam() {
+    // The same seed every time, so the extra agents stay put while the map
+    // is edited and the plans can be compared
+    std::mt19937 rng(1);
+    team.assign(1, {startCell, goalCell});
+    auto taken = [this](sf::Vector2i cell) {
+        for (const MultiAgentPlanner::Agent& agent : team) {
+            if (agent.start == cell || agent.goal == cell) {
+                return true;
+            }
+        }
+        return false;
+    };
+    for (int attempt = 0; attempt < 100 && static_cast<int>(team.size()) <= Constants::EXTRA_AGENTS; ++attempt) {
+        sf::Vector2i from = MapGenerator::randomFreeCell(grid, rng);
+        sf::Vector2i to = MapGenerator::randomFreeCell(grid, rng);
+        if (from.x == -1 || from == to || taken(from) || taken(to) ||
+            !components.connected(grid.index(from.x, from.y), grid.index(to.x, to.y))) {
+            continue;
+        }
+        team.push_back({from, to});
+    }
+}
+
+bool PathfindingVisualizer::loadTerrain(const std::string& filename) {
+    Grid loaded;
+    if (!MapLoader::loadTerrain(filename, loaded)) {
+        return false;
+    }
+    // The window is laid out for a fixed number of tiles
+    if (loaded.getRows() != Constants::ROWS || loaded.getCols() != Constants::COLS) {
+        std::cerr << "Terrain map must be " << Constants::ROWS << "x" << Constants::COLS << std::endl;
+        return false;
+    }
+
+    reset();
+    grid = std::move(loaded);
+    return true;
+}
+
+sf::Color PathfindingVisualizer::terrainColor(int cost) {
+    // Log scale from white at cost 1 to saddle brown at the maximum cost
+    float t = std::log(static_cast<float>(cost)) / std::log(static_cast<float>(Constants::MAX_TERRAIN_COST));
+    return sf::Color(static_cast<sf::Uint8>(255 - t * (255 - 139)),
+                     static_cast<sf::Uint8>(255 - t * (255 - 69)),
+                     static_cast<sf::Uint8>(255 - t * (255 - 19)));
+}
+
 void PathfindingVisualizer::render(sf::RenderWindow& window) {
+    TRACE_SCOPE("render");
     window.clear(sf::Color(240, 240, 240)); // Light gray background
 
     // Draw the top bar background
@@ -224,16 +692,16 @@ void PathfindingVisualizer::render(sf::RenderWindow& window) {
     window.draw(bottomBar);
 
     // Draw grid cells with borders
-    for (int y = 0; y < Constants::ROWS; ++y) {
-        for (int x = 0; x < Constants::COLS; ++x) {
+    for (int y = 0; y < grid.getRows(); ++y) {
+        for (int x = 0; x < grid.getCols(); ++x) {
             sf::RectangleShape cell(sf::Vector2f(Constants::TILE_SIZE - 2, Constants::TILE_SIZE - 2)); // Slightly smaller to show borders
             cell.setPosition(x * Constants::TILE_SIZE + 1, y * Constants::TILE_SIZE + 1 + Constants::TOP_BAR_HEIGHT); // +1 for border
             cell.setOutlineThickness(1); // Add border
             cell.setOutlineColor(sf::Color::Black); // Black border
 
             // Set cell color based on type
-            switch (grid[y][x]) {
-                case Constants::EMPTY: cell.setFillColor(sf::Color::White); break;
+            switch (grid.at(x, y)) {
+                case Constants::EMPTY: cell.setFillColor(terrainColor(grid.cost(x, y))); break;
                 case Constants::WALL: cell.setFillColor(sf::Color::Black); break;
                 case Constants::START: cell.setFillColor(sf::Color::Green); break;
                 case Constants::GOAL: cell.setFillColor(sf::Color::Red); break;
@@ -244,6 +712,63 @@ void PathfindingVisualizer::render(sf::RenderWindow& window) {
         }
     }
 
+    // Show the flow field while it is selected: a heat tint from near the
+    // goal (yellow) to far from it (purple) and the step each cell takes
+    if (currentAlgorithm == Constants::FLOW_FIELD && flowField.isCurrent(grid, goalCell)) {
+        int farthest = 1;
+        for (int index = 0; index < grid.getSize(); ++index) {
+            if (flowField.distance(index) != FlowField::UNREACHABLE && flowField.distance(index) > farthest) {
+                farthest = flowField.distance(index);
+            }
+        }
+        for (int y = 0; y < grid.getRows(); ++y) {
+            for (int x = 0; x < grid.getCols(); ++x) {
+                int index = grid.index(x, y);
+                if (flowField.distance(index) == FlowField::UNREACHABLE) {
+                    continue;
+                }
+                float heat = static_cast<float>(flowField.distance(index)) / farthest;
+                sf::RectangleShape tint(sf::Vector2f(Constants::TILE_SIZE - 2, Constants::TILE_SIZE - 2));
+                tint.setPosition(x * Constants::TILE_SIZE + 1, y * Constants::TILE_SIZE + 1 + Constants::TOP_BAR_HEIGHT);
+                tint.setFillColor(sf::Color(static_cast<sf::Uint8>(255 - 127 * heat),
+                                            static_cast<sf::Uint8>(220 * (1 - heat)),
+                                            static_cast<sf::Uint8>(200 * heat), 110));
+                window.draw(tint);
+
+                if (flowField.direction(index) == FlowField::NO_DIRECTION) {
+                    continue;
+                }
+                // Drawn pointing up, then turned a quarter per direction
+                sf::ConvexShape arrow(3);
+                arrow.setPoint(0, sf::Vector2f(0, -8));
+                arrow.setPoint(1, sf::Vector2f(6, 6));
+                arrow.setPoint(2, sf::Vector2f(-6, 6));
+                arrow.setPosition(x * Constants::TILE_SIZE + Constants::TILE_SIZE / 2.0f,
+                                  y * Constants::TILE_SIZE + Constants::TILE_SIZE / 2.0f + Constants::TOP_BAR_HEIGHT);
+                arrow.setRotation(90.0f * flowField.direction(index));
+                arrow.setFillColor(sf::Color(40, 40, 40, 200));
+                window.draw(arrow);
+            }
+        }
+    }
+
+    // Show the HPA* cluster boundaries while it is selected
+    if (currentAlgorithm == Constants::HPA_STAR) {
+        sf::Color boundaryColor(255, 140, 0);
+        for (int x = Constants::HPA_CLUSTER_SIZE; x < grid.getCols(); x += Constants::HPA_CLUSTER_SIZE) {
+            sf::RectangleShape line(sf::Vector2f(2, grid.getRows() * Constants::TILE_SIZE));
+            line.setPosition(x * Constants::TILE_SIZE - 1, Constants::TOP_BAR_HEIGHT);
+            line.setFillColor(boundaryColor);
+            window.draw(line);
+        }
+        for (int y = Constants::HPA_CLUSTER_SIZE; y < grid.getRows(); y += Constants::HPA_CLUSTER_SIZE) {
+            sf::RectangleShape line(sf::Vector2f(grid.getCols() * Constants::TILE_SIZE, 2));
+            line.setPosition(0, y * Constants::TILE_SIZE - 1 + Constants::TOP_BAR_HEIGHT);
+            line.setFillColor(boundaryColor);
+            window.draw(line);
+        }
+    }
+
     // Draw path
     for (auto& p : path) {
         // Don't draw path over start or goal
@@ -260,6 +785,61 @@ void PathfindingVisualizer::render(sf::RenderWindow& window) {
         window.draw(pathCell);
     }
 
+    // Multi-agent plans: every other agent's route in its own colour, then
+    // all agents played back step by step, looping once the last arrives
+    if (isMultiAgent() && stage == 4 && !teamPaths.empty()) {
+        static const sf::Color AGENT_COLORS[] = {
+            sf::Color(30, 60, 200), sf::Color(220, 120, 0), sf::Color(150, 40, 170),
+            sf::Color(0, 150, 140), sf::Color(200, 40, 90), sf::Color(110, 110, 0)
+        };
+        const int colorCount = sizeof(AGENT_COLORS) / sizeof(AGENT_COLORS[0]);
+        std::size_t makespan = 0;
+        for (const std::vector<sf::Vector2i>& agentPath : teamPaths) {
+            makespan = std::max(makespan, agentPath.size());
+        }
+
+        for (std::size_t i = 1; i < teamPaths.size(); ++i) {
+            sf::Color color = AGENT_COLORS[i % colorCount];
+            for (const sf::Vector2i& p : teamPaths[i]) {
+                sf::RectangleShape trail(sf::Vector2f(Constants::TILE_SIZE / 3.0f, Constants::TILE_SIZE / 3.0f));
+                trail.setOrigin(Constants::TILE_SIZE / 6.0f, Constants::TILE_SIZE / 6.0f);
+                trail.setPosition(p.x * Constants::TILE_SIZE + Constants::TILE_SIZE / 2.0f,
+                                  p.y * Constants::TILE_SIZE + Constants::TILE_SIZE / 2.0f + Constants::TOP_BAR_HEIGHT);
+                trail.setFillColor(sf::Color(color.r, color.g, color.b, 90));
+                window.draw(trail);
+            }
+            // The goal is a hollow square in the agent's colour
+            sf::Vector2i goal = team[i].goal;
+            sf::RectangleShape marker(sf::Vector2f(Constants::TILE_SIZE - 8, Constants::TILE_SIZE - 8));
+            marker.setPosition(goal.x * Constants::TILE_SIZE + 4, goal.y * Constants::TILE_SIZE + 4 + Constants::TOP_BAR_HEIGHT);
+            marker.setFillColor(sf::Color::Transparent);
+            marker.setOutlineThickness(2);
+            marker.setOutlineColor(color);
+            window.draw(marker);
+        }
+
+        // One extra step of rest at the goals before starting over
+        std::chrono::duration<float> elapsed = std::chrono::steady_clock::now() - playbackStart;
+        float step = std::fmod(elapsed.count() * Constants::AGENT_STEPS_PER_SECOND, static_cast<float>(makespan + 1));
+        for (std::size_t i = 0; i < teamPaths.size(); ++i) {
+            const std::vector<sf::Vector2i>& agentPath = teamPaths[i];
+            std::size_t from = std::min(static_cast<std::size_t>(step), agentPath.size() - 1);
+            std::size_t to = std::min(from + 1, agentPath.size() - 1);
+            float t = step - std::floor(step);
+            float x = agentPath[from].x + (agentPath[to].x - agentPath[from].x) * t;
+            float y = agentPath[from].y + (agentPath[to].y - agentPath[from].y) * t;
+
+            sf::CircleShape body(Constants::TILE_SIZE / 3.0f);
+            body.setOrigin(Constants::TILE_SIZE / 3.0f, Constants::TILE_SIZE / 3.0f);
+            body.setPosition(x * Constants::TILE_SIZE + Constants::TILE_SIZE / 2.0f,
+                             y * Constants::TILE_SIZE + Constants::TILE_SIZE / 2.0f + Constants::TOP_BAR_HEIGHT);
+            body.setFillColor(AGENT_COLORS[i % colorCount]);
+            body.setOutlineThickness(1);
+            body.setOutlineColor(sf::Color::Black);
+            window.draw(body);
+        }
+    }
+
     // Draw UI elements
     window.draw(findPathButton);
     window.draw(findPathButtonText);
@@ -269,4 +849,7 @@ void PathfindingVisualizer::render(sf::RenderWindow& window) {
     window.draw(algorithmButtonText);
     window.draw(stageText);
     window.draw(timeText);
+    window.draw(statsText);
+    window.draw(detailText);
+    window.draw(movementText);
 }
\ No newline at end of file
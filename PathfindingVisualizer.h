@@ -5,12 +5,27 @@
 #include <vector>
 #include <chrono>
 #include "Constants.h"
+#include "AdaptiveTimer.h"
 #include "Algorithms.h"
+#include "ComponentIndex.h"
+#include "DStarLite.h"
+#include "FlowField.h"
+#include "Grid.h"
+#include "MultiAgentPlanner.h"
+#include "PathCache.h"
 #include "UIComponents.h"
 
 class PathfindingVisualizer {
 private:
-    int grid[Constants::ROWS][Constants::COLS];
+    // Where the path on screen came from, which decides how its time is shown
+    enum ResultSource {
+        SEARCHED,
+        REPLANNED, // D* Lite or the flow field repaired the previous path after an edit
+        CACHED,
+        TIMED // Timing mode repeated the search; executionTime is the median
+    };
+
+    Grid grid;
     sf::Vector2i startCell;
     sf::Vector2i goalCell;
     std::vector<sf::Vector2i> path;
@@ -19,12 +34,36 @@ private:
     std::string statusMessage;
     sf::Font font;
     Constants::AlgorithmType currentAlgorithm;
+    Constants::HeuristicType currentHeuristic;
+    Movement movement; // Only DFS, BFS, Dijkstra and A* can move diagonally
     float executionTime;
+    SearchStats searchStats;
+    JumpPointTable jumpTable;
+    LandmarkTable landmarks;
+    ContractionHierarchy contraction;
+    WallBitmap wallBitmap;
+    HierarchicalGraph hierarchy;
+    ComponentIndex components;
+    DStarLite planner;
+    FlowField flowField;
+    MultiAgentPlanner agentPlanner;
+    std::vector<MultiAgentPlanner::Agent> team; // team[0] is the user's start and goal
+    std::vector<std::vector<sf::Vector2i>> teamPaths;
+    std::chrono::steady_clock::time_point playbackStart;
+    ResultSource resultSource;
+    bool timingMode;
+    AdaptiveTimer::Settings timingSettings;
+    AdaptiveTimer::Result timing;
+    PathCache pathCache;
+    SearchWorkspace workspace;
 
     // UI Components
     sf::Text stageText;
     sf::Text timeText;
+    sf::Text statsText;
+    sf::Text detailText;
     sf::Text algorithmText;
+    sf::Text movementText;
     sf::RectangleShape findPathButton;
     sf::Text findPathButtonText;
     sf::RectangleShape resetButton;
@@ -36,10 +75,28 @@ private:
     void updateUI();
     void reset();
     void findPath();
+    void runSearch();
+    PathCache::Key cacheKey() const;
     void cycleAlgorithm();
+    void invalidatePath();
+    void buildTeam();
+    bool isMultiAgent() const;
+    bool supportsMovement() const;
+    void applyEdit(int x, int y);
+    static sf::Color terrainColor(int cost);
 
 public:
     PathfindingVisualizer();
+    void setAlgorithm(Constants::AlgorithmType algorithm,
+                      Constants::HeuristicType heuristic = Constants::MANHATTAN);
     void handleMouseClick(int mouseX, int mouseY);
+    void handleRightClick(int mouseX, int mouseY);
+    // Steps through 4-way moves and 8-way moves under each corner policy
+    void cycleMovement();
+    // Timing mode repeats every search from scratch until its time is
+    // known closely, and shows min/median/p99 instead of one run's time
+    void toggleTimingMode();
+    void setTimingBudget(double milliseconds);
+    bool loadTerrain(const std::string& filename);
     void render(sf::RenderWindow& window);
 };
\ No newline at end of file
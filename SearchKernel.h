@@ -0,0 +1,245 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include <SFML/System/Vector2.hpp>
+#include "Constants.h"
+#include "Movement.h"
+#include "PaddedGrid.h"
+#include "SearchWorkspace.h"
+#include "Trace.h"
+
+// The one expansion loop behind DFS, BFS, Dijkstra and A*. They differ only
+// in their open list, how much a step costs and whether a heuristic steers
+// them, so each is an instantiation of search() below with those chosen at
+// compile time, together with the connectivity and corner policy. Every
+// choice folds away: a 4-connected BFS compiles to the same queue loop it
+// always was, minus the bounds checks, which the PaddedGrid border makes
+// unnecessary.
+//
+// Labels are indexed by PaddedGrid cell. A cell is relabelled and pushed
+// whenever it is reached more cheaply; with the stack and queue, whose costs
+// never improve on a first visit, that is exactly "push each cell once".
+namespace SearchKernel {
+
+// Open lists, each over a container the workspace keeps between queries.
+// KEYED lists return the cost an entry was pushed with so that entries made
+// stale by a cheaper push can be skipped; the others never hold stale
+// entries and read the cost from the label instead.
+class Stack {
+public:
+    static const bool KEYED = false;
+
+    explicit Stack(SearchWorkspace& workspace) : workspace(workspace), items(workspace.stack) {}
+    bool empty() const { return items.empty(); }
+    void push(int index, int, int) {
+        items.push_back(index);
+        workspace.countPush(items.size());
+    }
+    int pop(int&) {
+        int index = items.back();
+        items.pop_back();
+        return index;
+    }
+
+private:
+    SearchWorkspace& workspace;
+    std::vector<int>& items;
+};
+
+// Every cell is enqueued at most once, so a vector with a read head works
+// as the FIFO without ever shifting elements
+class Queue {
+public:
+    static const bool KEYED = false;
+
+    explicit Queue(SearchWorkspace& workspace) : workspace(workspace), items(workspace.queue), head(0) {}
+    bool empty() const { return head == items.size(); }
+    void push(int index, int, int) {
+        items.push_back(index);
+        workspace.countPush(items.size() - head);
+    }
+    int pop(int&) { return items[head++]; }
+
+private:
+    SearchWorkspace& workspace;
+    std::vector<int>& items;
+    std::size_t head;
+};
+
+// Dial's buckets, for keys that grow by at most one terrain cost per step
+class Buckets {
+public:
+    static const bool KEYED = true;
+
+    explicit Buckets(SearchWorkspace& workspace) : workspace(workspace), queue(workspace.buckets) {}
+    bool empty() const { return queue.empty(); }
+    void push(int index, int cost, int) {
+        queue.push(index, cost);
+        workspace.countPush(queue.size());
+    }
+    int pop(int& cost) { return queue.pop(cost); }
+
+private:
+    SearchWorkspace& workspace;
+    BucketQueue& queue;
+};
+
+// Binary heap on the estimate, preferring the larger cost on ties
+class Heap {
+public:
+    static const bool KEYED = true;
+
+    explicit Heap(SearchWorkspace& workspace) : workspace(workspace) {}
+    bool empty() const { return workspace.heapEmpty(); }
+    void push(int index, int cost, int estimate) { workspace.pushHeap({index, cost, estimate}); }
+    int pop(int& cost) {
+        SearchWorkspace::HeapNode node = workspace.popHeap();
+        cost = node.cost;
+        return node.index;
+    }
+
+private:
+    SearchWorkspace& workspace;
+};
+
+// Cost models: what one step adds to the cost of the cell it leaves.
+// FirstReach makes every cost 0, so a cell keeps the parent it was first
+// reached from, which is all DFS needs.
+struct FirstReach {
+    static int step(const PaddedGrid&, int, int) { return 0; }
+};
+
+struct StepCount {
+    static int step(const PaddedGrid&, int, int) { return 1; }
+};
+
+// The terrain cost of the cell entered, times the step's weight, which is 1
+// on 4-connected grids
+struct TerrainCost {
+    static int step(const PaddedGrid& grid, int next, int weight) { return weight * grid.cost(next); }
+};
+
+// Lower bound on the cost between cells dx, dy apart; see
+// Algorithms::heuristicCost
+template <Constants::HeuristicType H, Constants::Connectivity C>
+inline int distanceBound(int dx, int dy) {
+    dx = std::abs(dx);
+    dy = std::abs(dy);
+    if (C == Constants::EIGHT_CONNECTED) {
+        // Manhattan would overestimate a diagonal, so it falls back to octile
+        if (H == Constants::EUCLIDEAN) {
+            return static_cast<int>(Movement::STRAIGHT_WEIGHT *
+                                    std::sqrt(static_cast<double>(dx) * dx + static_cast<double>(dy) * dy));
+        }
+        return Movement::octileDistance(dx, dy);
+    }
+    switch (H) {
+        case Constants::MANHATTAN:
+            return dx + dy;
+        case Constants::OCTILE:
+            return std::max(dx, dy) + static_cast<int>((std::sqrt(2.0) - 1.0) * std::min(dx, dy));
+        case Constants::EUCLIDEAN:
+            return static_cast<int>(std::sqrt(static_cast<double>(dx) * dx + static_cast<double>(dy) * dy));
+    }
+    return 0;
+}
+
+// Heuristics. Only those that need a cell's coordinates make the kernel
+// work them out from its index.
+struct NoHeuristic {
+    static const bool NEEDS_POSITION = false;
+    int operator()(int, int) const { return 0; }
+};
+
+template <Constants::HeuristicType H, Constants::Connectivity C>
+struct GoalDistance {
+    static const bool NEEDS_POSITION = true;
+    sf::Vector2i goal;
+
+    int operator()(int x, int y) const { return distanceBound<H, C>(goal.x - x, goal.y - y); }
+};
+
+// Searches from start to goal, both PaddedGrid indices, leaving the path in
+// the workspace's parent labels. The caller has called workspace.begin()
+// for grid.getSize() cells. Counts expanded cells into `expanded` and
+// open-list pushes into the workspace's counters.
+template <class Open, Constants::Connectivity C, Constants::CornerPolicy P, class Cost, class Heuristic>
+bool search(const PaddedGrid& grid, int start, int goal, SearchWorkspace& workspace,
+            const Heuristic& heuristic, int& expanded) {
+    typedef NeighborTable<C> Neighbors;
+    const int stride = grid.getStride();
+    int offsets[Neighbors::COUNT];
+    for (int d = 0; d < Neighbors::COUNT; ++d) {
+        offsets[d] = Neighbors::STEPS[d].dx + Neighbors::STEPS[d].dy * stride;
+    }
+
+    Open open(workspace);
+    workspace.label(start, 0, -1);
+    open.push(start, 0, heuristic(grid.indexX(start), grid.indexY(start)));
+
+    while (!open.empty()) {
+        int cost = 0;
+        int current = open.pop(cost);
+
+        if (current == goal) {
+            return true;
+        }
+
+        // Stale entry, the cell was reached more cheaply since it was pushed
+        if (Open::KEYED) {
+            if (cost > workspace.distance(current)) {
+                continue;
+            }
+        } else {
+            cost = workspace.distance(current);
+        }
+
+        ++expanded;
+
+        int x = 0;
+        int y = 0;
+        if (Heuristic::NEEDS_POSITION) {
+            x = grid.indexX(current);
+            y = grid.indexY(current);
+        }
+        for (int d = 0; d < Neighbors::COUNT; ++d) {
+            const NeighborStep& step = Neighbors::STEPS[d];
+            int next = current + offsets[d];
+            if (grid.isBlocked(next)) {
+                continue;
+            }
+            if (C == Constants::EIGHT_CONNECTED && P != Constants::CUT_CORNERS && step.dx != 0 && step.dy != 0) {
+                bool first = !grid.isBlocked(current + step.dx);
+                bool second = !grid.isBlocked(current + step.dy * stride);
+                if (P == Constants::NO_SQUEEZE ? !(first || second) : !(first && second)) {
+                    continue;
+                }
+            }
+
+            int newCost = cost + Cost::step(grid, next, step.weight);
+            if (newCost < workspace.distance(next)) {
+                workspace.countIfLabelled(next);
+                workspace.label(next, newCost, current);
+                open.push(next, newCost, newCost + heuristic(x + step.dx, y + step.dy));
+            }
+        }
+    }
+    return false;
+}
+
+// Walks the parent labels back from goal and lists the cells in grid
+// coordinates, start first
+inline void reconstructPath(const PaddedGrid& grid, const SearchWorkspace& workspace,
+                            int start, int goal, std::vector<sf::Vector2i>& path) {
+    TRACE_SCOPE("reconstructPath");
+    for (int pos = goal; pos != start; pos = workspace.parent(pos)) {
+        path.push_back({grid.indexX(pos), grid.indexY(pos)});
+    }
+    path.push_back({grid.indexX(start), grid.indexY(start)});
+    std::reverse(path.begin(), path.end());
+}
+
+}
@@ -0,0 +1,51 @@
+#include "SearchStats.h"
+#include "AllocationCounter.h"
+#include "SearchWorkspace.h"
+
+const bool SearchStats::ENABLED;
+
+SearchStats::Scope::Scope(SearchStats* stats, SearchWorkspace* workspace, const Grid* grid,
+                          const std::vector<sf::Vector2i>* path, const Movement& movement)
+    : stats(ENABLED ? stats : nullptr), workspace(workspace), grid(grid), path(path), movement(movement),
+      bytesBefore(0) {
+#if SEARCH_STATS
+    if (stats) {
+        bytesBefore = AllocationCounter::bytes();
+    }
+#endif
+    if (ENABLED && workspace) {
+        workspace->resetCounters();
+    }
+}
+
+SearchStats::Scope::~Scope() {
+    if (!stats) {
+        return;
+    }
+#if SEARCH_STATS
+    stats->bytesAllocated = AllocationCounter::bytes() - bytesBefore;
+#endif
+    if (workspace) {
+        stats->nodesGenerated = workspace->getPushes();
+        stats->duplicatePushes = workspace->getDuplicatePushes();
+        stats->peakOpen = workspace->getPeakOpen();
+    }
+
+    if (path) {
+        stats->recordPath(grid, *path, movement);
+    }
+}
+
+void SearchStats::recordPath(const Grid* grid, const std::vector<sf::Vector2i>& path, const Movement& movement) {
+    pathLength = 0;
+    pathCost = 0;
+    if (!ENABLED || path.empty()) {
+        return;
+    }
+    pathLength = static_cast<int>(path.size()) - 1;
+    for (std::size_t i = 1; i < path.size(); ++i) {
+        int dx = path[i].x - path[i - 1].x;
+        int dy = path[i].y - path[i - 1].y;
+        pathCost += grid ? movement.stepCost(dx, dy, grid->cost(path[i].x, path[i].y)) : 1;
+    }
+}
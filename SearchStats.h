@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vector>
+#include <SFML/System/Vector2.hpp>
+#include "Movement.h"
+
+// Building with SEARCH_STATS defined as 0 compiles the open-list counters
+// out of every search loop and leaves nodesGenerated through
+// bytesAllocated at zero. The other counters are kept either way.
+#ifndef SEARCH_STATS
+#define SEARCH_STATS 1
+#endif
+
+class SearchWorkspace;
+
+// Counters filled in by the search algorithms when the caller passes a
+// SearchStats pointer. A node counts as expanded once its neighbours have
+// been examined; stale priority-queue entries that are skipped do not count.
+struct SearchStats {
+    static const bool ENABLED = SEARCH_STATS != 0;
+
+    int nodesExpanded = 0;
+
+    // Open-list pushes, those of a cell already pushed earlier in the same
+    // query, and the most entries open at once. Searches that update keys
+    // in place count an update as a duplicate.
+    long long nodesGenerated = 0;
+    long long duplicatePushes = 0;
+    long long peakOpen = 0;
+
+    // Steps in the path found and their cost under the grid's terrain and
+    // the search's movement; both 0 without a path
+    int pathLength = 0;
+    long long pathCost = 0;
+
+    // Bytes requested from operator new while the search ran; 0 unless
+    // AllocationCounter's allocator is linked in
+    long long bytesAllocated = 0;
+
+    // Open-list sizes of the two searches when a bidirectional search stops
+    int forwardFrontier = 0;
+    int backwardFrontier = 0;
+
+    // Levels the direction-optimizing BFS ran bottom-up
+    int bottomUpLevels = 0;
+
+    // Paths an anytime search found before its deadline, and the factor by
+    // which the last one may cost more than the optimal path (1 if optimal).
+    // timedOut is set if the deadline passed before the first path, in
+    // which case the search returns none.
+    int solutions = 0;
+    float suboptimalityBound = 1.0f;
+    bool timedOut = false;
+
+    void reset() { *this = SearchStats(); }
+
+    // Sets pathLength and pathCost for a path from a search that moves as
+    // `movement` says; with no grid every step costs 1
+    void recordPath(const Grid* grid, const std::vector<sf::Vector2i>& path, const Movement& movement = Movement());
+
+    // Fills in what every search reports the same way when it goes out of
+    // scope: the bytes allocated meanwhile, the workspace's open-list
+    // counters and the length and cost of the path. A search declares one
+    // first thing, so that it sees the finished path, and the workspace's
+    // counters start from zero even if the search returns before begin().
+    // Without a workspace the search counts its open list itself, and
+    // without a path it sets pathLength and pathCost itself if at all.
+    // Does nothing if stats is null or SEARCH_STATS is 0.
+    class Scope {
+    public:
+        Scope(SearchStats* stats, SearchWorkspace* workspace, const Grid* grid,
+              const std::vector<sf::Vector2i>* path, const Movement& movement = Movement());
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        SearchStats* stats;
+        SearchWorkspace* workspace;
+        const Grid* grid;
+        const std::vector<sf::Vector2i>* path;
+        Movement movement;
+        long long bytesBefore;
+    };
+};
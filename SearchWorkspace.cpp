@@ -0,0 +1,62 @@
+#include "SearchWorkspace.h"
+#include <algorithm>
+
+namespace {
+    struct HeapOrder {
+        // std heap functions build a max-heap, so "less" means "popped later"
+        bool operator()(const SearchWorkspace::HeapNode& a, const SearchWorkspace::HeapNode& b) const {
+            if (a.estimate != b.estimate) {
+                return a.estimate > b.estimate;
+            }
+            return a.cost < b.cost;
+        }
+    };
+}
+
+SearchWorkspace::SearchWorkspace() : generation(0), pushes(0), duplicatePushes(0), peakOpen(0) {}
+
+void SearchWorkspace::begin(const Grid& grid) {
+    begin(static_cast<std::size_t>(grid.getSize()));
+}
+
+void SearchWorkspace::begin(std::size_t cells) {
+    for (int side = 0; side < 2; ++side) {
+        if (stamps[side].size() < cells) {
+            stamps[side].resize(cells, 0);
+            labels[side].resize(cells, Label{-1, INT_MAX});
+        }
+    }
+
+    // Stamp 0 is never current, so a wrapped counter needs one real clear
+    if (++generation == 0) {
+        for (auto& side : stamps) {
+            std::fill(side.begin(), side.end(), 0);
+        }
+        generation = 1;
+    }
+
+    stack.clear();
+    queue.clear();
+    frontier[0].clear();
+    frontier[1].clear();
+    next.clear();
+    heaps[0].clear();
+    heaps[1].clear();
+    buckets.clear();
+    levelWords.clear();
+    levelStarts.clear();
+    resetCounters();
+}
+
+void SearchWorkspace::pushHeap(const HeapNode& node, int side) {
+    heaps[side].push_back(node);
+    std::push_heap(heaps[side].begin(), heaps[side].end(), HeapOrder());
+    countPush(heaps[0].size() + heaps[1].size());
+}
+
+SearchWorkspace::HeapNode SearchWorkspace::popHeap(int side) {
+    std::pop_heap(heaps[side].begin(), heaps[side].end(), HeapOrder());
+    HeapNode node = heaps[side].back();
+    heaps[side].pop_back();
+    return node;
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <vector>
+#include "BucketQueue.h"
+#include "Grid.h"
+#include "PaddedGrid.h"
+#include "SearchStats.h"
+
+// Per-caller scratch state for the search algorithms, kept between queries.
+//
+// Every cell has a label (distance and parent) per search direction. Labels
+// are only valid if their stamp equals the current generation, so begin()
+// invalidates all of them in O(1) by bumping the generation instead of
+// clearing O(cells) memory. The open-list containers are kept here as well
+// and only ever cleared, so once a workspace has seen its largest query,
+// further queries do not touch the heap.
+//
+// A workspace is not thread-safe; give each thread its own.
+class SearchWorkspace {
+public:
+    // Open-list entry ordered by estimate, preferring the larger cost on ties
+    struct HeapNode {
+        int index;
+        int cost;
+        int estimate;
+    };
+
+    SearchWorkspace();
+
+    // Starts a new query on the given grid, growing the tables if needed
+    void begin(const Grid& grid);
+
+    // Same, for a query whose labels are indexed some other way, such as
+    // the cells of a PaddedGrid
+    void begin(std::size_t cells);
+
+    bool isLabelled(int index, int side = 0) const {
+        return stamps[side][index] == generation;
+    }
+    int distance(int index, int side = 0) const {
+        return isLabelled(index, side) ? labels[side][index].distance : INT_MAX;
+    }
+    int parent(int index, int side = 0) const {
+        return isLabelled(index, side) ? labels[side][index].parent : -1;
+    }
+    void label(int index, int distance, int parent, int side = 0) {
+        stamps[side][index] = generation;
+        labels[side][index] = {parent, distance};
+    }
+
+    bool heapEmpty(int side = 0) const { return heaps[side].empty(); }
+    int heapSize(int side = 0) const { return static_cast<int>(heaps[side].size()); }
+    const HeapNode& heapTop(int side = 0) const { return heaps[side].front(); }
+    void pushHeap(const HeapNode& node, int side = 0);
+    HeapNode popHeap(int side = 0);
+
+    // Open-list counters of the current query, which SearchStats reports.
+    // The heap counts its own pushes; searches with other open lists call
+    // countPush() after each push with the entries now open. A search
+    // calls countDuplicate() when the cell it pushes was pushed before in
+    // the query, or countIfLabelled() just before relabelling a cell it is
+    // about to push, which amounts to the same. begin() resets them. With
+    // SEARCH_STATS 0 they compile to nothing.
+    void countPush(std::size_t open) {
+        if (SearchStats::ENABLED) {
+            ++pushes;
+            peakOpen = std::max(peakOpen, static_cast<long long>(open));
+        }
+    }
+    void countDuplicate() {
+        if (SearchStats::ENABLED) {
+            ++duplicatePushes;
+        }
+    }
+    void countIfLabelled(int index, int side = 0) {
+        if (SearchStats::ENABLED && isLabelled(index, side)) {
+            ++duplicatePushes;
+        }
+    }
+    void resetCounters() {
+        pushes = 0;
+        duplicatePushes = 0;
+        peakOpen = 0;
+    }
+    long long getPushes() const { return pushes; }
+    long long getDuplicatePushes() const { return duplicatePushes; }
+    long long getPeakOpen() const { return peakOpen; }
+
+    // Reusable containers; begin() empties them but keeps their capacity
+    std::vector<int> stack;
+    std::vector<int> queue;
+    std::vector<int> frontier[2];
+    std::vector<int> next;
+    BucketQueue buckets;
+
+    // Bit planes for the word-parallel BFS (frontier, next frontier, visited),
+    // kept all-zero between queries, and the non-zero words of every level's
+    // frontier for path reconstruction
+    struct LevelWord {
+        int index;
+        std::uint64_t bits;
+    };
+    std::vector<std::uint64_t> bitPlanes[3];
+    std::vector<LevelWord> levelWords;
+    std::vector<int> levelStarts;
+
+    // Bordered copy of the last grid the search kernel ran on
+    PaddedGrid padded;
+
+    // Cluster-local distances and parents for HPA*, indexed within a cluster
+    std::vector<int> clusterDistance[2];
+    std::vector<int> clusterParent;
+
+private:
+    // Stamps live in their own array so that visited checks, the most
+    // frequent access, stream through 4 bytes per cell rather than 12
+    struct Label {
+        int parent;
+        int distance;
+    };
+
+    std::vector<std::uint32_t> stamps[2];
+    std::vector<Label> labels[2];
+    std::vector<HeapNode> heaps[2];
+    std::uint32_t generation;
+    long long pushes;
+    long long duplicatePushes;
+    long long peakOpen;
+};
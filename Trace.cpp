@@ -0,0 +1,165 @@
+#include "Trace.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+const bool Trace::ENABLED;
+const std::uint32_t Trace::BUFFER_EVENTS;
+
+std::atomic<bool> Trace::recording(false);
+
+namespace {
+
+struct Event {
+    const char* name;
+    std::int64_t begin;
+    std::int64_t end;
+};
+
+// One thread's events. Only the owning thread writes them; `head` counts
+// every event ever recorded, and is published after the event it covers so
+// a reader never sees a slot before it is filled.
+// `name` and `exited` are guarded by registryMutex.
+struct ThreadBuffer {
+    std::unique_ptr<Event[]> events;
+    std::atomic<std::uint64_t> head{0};
+    const char* name = nullptr;
+    int id = 0;
+    bool exited = false;
+};
+
+// Buffers outlive their threads, so a batch's workers can still be written
+// out after they exit; clear() frees those of threads that have exited. The
+// lock is only taken when a thread records its first event, names itself
+// or exits, and by the functions that read every buffer.
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> registry;
+int nextThreadId = 1;
+
+thread_local ThreadBuffer* threadBuffer = nullptr;
+
+// Marks the thread's buffer as orphaned when the thread exits. Kept apart
+// from threadBuffer, whose reads in record() then need no guard for a
+// thread_local with a destructor.
+struct BufferOwner {
+    ThreadBuffer* buffer = nullptr;
+    ~BufferOwner() {
+        if (buffer) {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            buffer->exited = true;
+        }
+    }
+};
+thread_local BufferOwner bufferOwner;
+
+// Held until the thread records something, so naming a thread that never
+// does costs no buffer
+thread_local const char* threadName = nullptr;
+
+const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+ThreadBuffer& currentBuffer() {
+    if (!threadBuffer) {
+        std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer());
+        buffer->events.reset(new Event[Trace::BUFFER_EVENTS]);
+        buffer->name = threadName;
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffer->id = nextThreadId++;
+        threadBuffer = buffer.get();
+        registry.push_back(std::move(buffer));
+        bufferOwner.buffer = threadBuffer;
+    }
+    return *threadBuffer;
+}
+
+void writeString(std::ostream& out, const char* text) {
+    out << '"';
+    for (; *text; ++text) {
+        if (*text == '"' || *text == '\\') {
+            out << '\\';
+        }
+        out << *text;
+    }
+    out << '"';
+}
+
+}
+
+void Trace::setRecording(bool on) {
+    recording.store(on, std::memory_order_relaxed);
+}
+
+void Trace::clear() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    registry.erase(std::remove_if(registry.begin(), registry.end(),
+                                  [](const std::unique_ptr<ThreadBuffer>& buffer) { return buffer->exited; }),
+                   registry.end());
+    for (const auto& buffer : registry) {
+        buffer->head.store(0, std::memory_order_relaxed);
+    }
+}
+
+void Trace::setThreadName(const char* name) {
+    threadName = name;
+    if (threadBuffer) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        threadBuffer->name = name;
+    }
+}
+
+std::int64_t Trace::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Trace::record(const char* name, std::int64_t begin, std::int64_t end) {
+    ThreadBuffer& buffer = currentBuffer();
+    std::uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    buffer.events[head & (BUFFER_EVENTS - 1)] = {name, begin, end};
+    buffer.head.store(head + 1, std::memory_order_release);
+}
+
+bool Trace::write(const std::string& filename) {
+    std::ofstream file(filename);
+    if (!file) {
+        std::cerr << "Failed to write trace " << filename << std::endl;
+        return false;
+    }
+
+    // Nanoseconds become microseconds with three decimals, so nothing is lost
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto& buffer : registry) {
+        if (buffer->name) {
+            file << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id
+                 << ",\"args\":{\"name\":";
+            writeString(file, buffer->name);
+            file << "}}";
+            first = false;
+        }
+
+        std::uint64_t head = buffer->head.load(std::memory_order_acquire);
+        std::uint64_t oldest = head > BUFFER_EVENTS ? head - BUFFER_EVENTS : 0;
+        for (std::uint64_t i = oldest; i < head; ++i) {
+            const Event& event = buffer->events[i & (BUFFER_EVENTS - 1)];
+            file << (first ? "" : ",") << "\n{\"name\":";
+            writeString(file, event.name);
+            file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id << ",\"ts\":" << event.begin / 1000.0
+                 << ",\"dur\":" << (event.end - event.begin) / 1000.0 << "}";
+            first = false;
+        }
+    }
+    file << "\n]}\n";
+
+    if (!file) {
+        std::cerr << "Failed to write trace " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Building with TRACING defined as 0 turns every TRACE_SCOPE into nothing.
+// Built in, a scope costs one relaxed load while recording is off.
+#ifndef TRACING
+#define TRACING 1
+#endif
+
+// Scoped timeline markers, written out as Chrome trace-event JSON that
+// chrome://tracing and ui.perfetto.dev open.
+//
+// Each thread records into its own ring buffer of BUFFER_EVENTS events
+// (1.5 MB), made the first time the thread records anything, so marking a
+// scope takes no lock and never allocates afterwards. A full buffer
+// overwrites its oldest events. A buffer outlives its thread, so write()
+// still sees the workers of a BatchPlanner that is gone, and is freed by
+// the next clear() after the thread exits. Names must be string literals,
+// or otherwise outlive the trace, since only the pointer is kept.
+//
+// Stop recording before write() or clear(): they read every thread's buffer
+// without stopping the threads.
+class Trace {
+public:
+    static const bool ENABLED = TRACING != 0;
+
+    // Events each thread keeps; a power of two
+    static const std::uint32_t BUFFER_EVENTS = 1u << 16;
+
+    static bool isRecording() { return recording.load(std::memory_order_relaxed); }
+    static void setRecording(bool on);
+
+    // Drops every event recorded so far, and the buffers of threads that
+    // have exited
+    static void clear();
+
+    // Names the calling thread in the trace; `name` is kept as a pointer.
+    // Costs nothing until the thread records an event.
+    static void setThreadName(const char* name);
+
+    // Writes every thread's events as a JSON object with a traceEvents
+    // array of complete ("X") events, timed in microseconds from the first
+    // use of the trace. Returns false if the file cannot be written.
+    static bool write(const std::string& filename);
+
+    // Appends a complete event to the calling thread's buffer; times are
+    // from now()
+    static void record(const char* name, std::int64_t begin, std::int64_t end);
+
+    // Nanoseconds since the trace's epoch
+    static std::int64_t now();
+
+    // Records its own lifetime if recording was on when it was made
+    class Scope {
+    public:
+        explicit Scope(const char* name) : name(name), begin(isRecording() ? now() : -1) {}
+        ~Scope() {
+            if (begin >= 0) {
+                record(name, begin, now());
+            }
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* name;
+        std::int64_t begin;
+    };
+
+private:
+    static std::atomic<bool> recording;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#if TRACING
+#define TRACE_SCOPE(name) Trace::Scope TRACE_CONCAT(traceScope, __LINE__)(name)
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#endif
@@ -0,0 +1,892 @@
+#include "Verification.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iterator>
+#include "AllocationCounter.h"
+#include "Algorithms.h"
+#include "BatchPlanner.h"
+#include "ComponentIndex.h"
+#include "ContractionHierarchy.h"
+#include "DStarLite.h"
+#include "FlowField.h"
+#include "HierarchicalGraph.h"
+#include "JumpPointTable.h"
+#include "LandmarkTable.h"
+#include "MapGenerator.h"
+#include "MultiAgentPlanner.h"
+#include "PathCache.h"
+#include "WallBitmap.h"
+
+// Per-map preprocessing, built on first use by the algorithms that need it
+struct Preprocessing {
+    JumpPointTable table;
+    LandmarkTable landmarks;
+    WallBitmap bitmap;
+    HierarchicalGraph hierarchy;
+    ContractionHierarchy contraction;
+    DStarLite planner;
+    FlowField field;
+    MultiAgentPlanner agents;
+    std::vector<MultiAgentPlanner::Agent> team;
+    std::vector<std::vector<sf::Vector2i>> teamPaths;
+
+    void clear() {
+        table.clear();
+        landmarks.clear();
+        bitmap.clear();
+        hierarchy.clear();
+        contraction.clear();
+        planner.clear();
+        field.clear();
+    }
+};
+
+static bool runAlgorithm(Constants::AlgorithmType algorithm,
+                         const Grid& grid,
+                         sf::Vector2i startCell,
+                         sf::Vector2i goalCell,
+                         std::vector<sf::Vector2i>& path,
+                         SearchWorkspace& workspace,
+                         Preprocessing& preprocessing) {
+    switch (algorithm) {
+        case Constants::DFS:
+            return Algorithms::depthFirstSearch(grid, startCell, goalCell, path, workspace);
+        case Constants::BFS:
+            return Algorithms::breadthFirstSearch(grid, startCell, goalCell, path, workspace);
+        case Constants::DIJKSTRA:
+            return Algorithms::dijkstraAlgorithm(grid, startCell, goalCell, path, workspace);
+        case Constants::ASTAR:
+            return Algorithms::aStarSearch(grid, startCell, goalCell, path, workspace);
+        case Constants::ALT:
+            if (!preprocessing.landmarks.isBuilt()) {
+                preprocessing.landmarks.build(grid, Constants::ALT_LANDMARKS);
+            }
+            return Algorithms::landmarkSearch(grid, preprocessing.landmarks, startCell, goalCell, path, workspace);
+        case Constants::ARA_STAR:
+            // With no deadline it runs down to weight 1 and must be optimal;
+            // checkAnytimeSearch covers the deadline
+            return Algorithms::anytimeSearch(grid, startCell, goalCell, path, workspace,
+                                             std::chrono::steady_clock::time_point::max());
+        case Constants::JPS:
+            return Algorithms::jumpPointSearch(grid, startCell, goalCell, path, workspace);
+        case Constants::JPS_PLUS:
+            if (!preprocessing.table.isBuilt()) {
+                preprocessing.table.build(grid);
+            }
+            return Algorithms::jumpPointSearchPlus(grid, preprocessing.table, startCell, goalCell, path, workspace);
+        case Constants::BIDIRECTIONAL_BFS:
+            return Algorithms::bidirectionalBreadthFirstSearch(grid, startCell, goalCell, path, workspace);
+        case Constants::BIDIRECTIONAL_DIJKSTRA:
+            return Algorithms::bidirectionalDijkstra(grid, startCell, goalCell, path, workspace);
+        case Constants::BIT_PARALLEL_BFS:
+            if (!preprocessing.bitmap.isBuilt()) {
+                preprocessing.bitmap.build(grid);
+            }
+            return Algorithms::bitParallelBreadthFirstSearch(preprocessing.bitmap, startCell, goalCell, path, workspace);
+        case Constants::DIRECTION_OPTIMIZING_BFS:
+            return Algorithms::directionOptimizingBreadthFirstSearch(grid, startCell, goalCell, path, workspace);
+        case Constants::HPA_STAR:
+            if (!preprocessing.hierarchy.isBuilt()) {
+                preprocessing.hierarchy.build(grid);
+            }
+            return Algorithms::hierarchicalSearch(grid, preprocessing.hierarchy, startCell, goalCell, path, workspace);
+        case Constants::CONTRACTION_HIERARCHY:
+            if (!preprocessing.contraction.isBuilt()) {
+                preprocessing.contraction.build(grid);
+            }
+            return Algorithms::contractionHierarchySearch(grid, preprocessing.contraction, startCell, goalCell, path, workspace);
+        case Constants::D_STAR_LITE:
+            // A fresh plan per query; checkIncrementalReplanning covers the repairs
+            preprocessing.planner.initialize(grid, startCell, goalCell);
+            return preprocessing.planner.replan(grid, path);
+        case Constants::FLOW_FIELD:
+            // Fields are per goal, so one only carries over between queries
+            // for the same goal on the same map
+            if (!preprocessing.field.isCurrent(grid, goalCell)) {
+                preprocessing.field.build(grid, goalCell);
+            }
+            return preprocessing.field.followPath(grid, startCell, path);
+        case Constants::COOPERATIVE_ASTAR:
+        case Constants::CONFLICT_BASED_SEARCH: {
+            // A team of one; checkMultiAgentPlanning covers real teams
+            preprocessing.team.assign(1, {startCell, goalCell});
+            bool found = algorithm == Constants::COOPERATIVE_ASTAR
+                             ? preprocessing.agents.planCooperative(grid, preprocessing.team, preprocessing.teamPaths)
+                             : preprocessing.agents.planConflictBased(grid, preprocessing.team, preprocessing.teamPaths);
+            path.swap(preprocessing.teamPaths[0]);
+            if (!found) {
+                path.clear();
+            }
+            return found;
+        }
+    }
+    return false;
+}
+
+bool Verification::isValidPath(const Grid& grid,
+                               sf::Vector2i startCell,
+                               sf::Vector2i goalCell,
+                               const std::vector<sf::Vector2i>& path,
+                               const Movement& movement) {
+    if (path.empty() || path.front() != startCell || path.back() != goalCell) {
+        return false;
+    }
+    for (size_t i = 0; i < path.size(); ++i) {
+        if (!grid.isWalkable(path[i].x, path[i].y)) {
+            return false;
+        }
+        if (i > 0 && !movement.allowsStep(grid, path[i - 1].x, path[i - 1].y,
+                                          path[i].x - path[i - 1].x, path[i].y - path[i - 1].y)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+long long Verification::pathCost(const Grid& grid, const std::vector<sf::Vector2i>& path,
+                                 const Movement& movement) {
+    long long cost = 0;
+    for (size_t i = 1; i < path.size(); ++i) {
+        cost += movement.stepCost(path[i].x - path[i - 1].x, path[i].y - path[i - 1].y,
+                                  grid.cost(path[i].x, path[i].y));
+    }
+    return cost;
+}
+
+bool Verification::compareWithBreadthFirst(Constants::AlgorithmType algorithm,
+                                           int rows, int cols, int trials,
+                                           unsigned seed, std::ostream& out) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> density(0.0, 0.45);
+    std::vector<sf::Vector2i> expected;
+    std::vector<sf::Vector2i> path;
+    Preprocessing preprocessing;
+    SearchWorkspace workspace;
+    int failures = 0;
+    long long expectedSteps = 0;
+    long long actualSteps = 0;
+
+    for (int trial = 0; trial < trials; ++trial) {
+        Grid grid = MapGenerator::randomObstacles(rows, cols, density(rng), rng());
+        sf::Vector2i startCell = MapGenerator::randomFreeCell(grid, rng);
+        sf::Vector2i goalCell = MapGenerator::randomFreeCell(grid, rng);
+        if (startCell.x == -1) {
+            continue;
+        }
+
+        preprocessing.clear();
+        bool expectedFound = Algorithms::breadthFirstSearch(grid, startCell, goalCell, expected, workspace);
+        bool found = runAlgorithm(algorithm, grid, startCell, goalCell, path, workspace, preprocessing);
+
+        // DFS and HPA* are complete but not optimal, so only their reachability is compared
+        bool optimal = algorithm != Constants::DFS && algorithm != Constants::HPA_STAR;
+        bool lengthMatches = !optimal || path.size() == expected.size();
+        if (found && expectedFound) {
+            expectedSteps += static_cast<long long>(expected.size()) - 1;
+            actualSteps += static_cast<long long>(path.size()) - 1;
+        }
+        if (found != expectedFound || (found && (!lengthMatches || !isValidPath(grid, startCell, goalCell, path)))) {
+            ++failures;
+            out << "  mismatch in trial " << trial << ": start (" << startCell.x << ", " << startCell.y
+                << ") goal (" << goalCell.x << ", " << goalCell.y << ") expected length "
+                << (expectedFound ? static_cast<int>(expected.size()) - 1 : -1) << ", got "
+                << (found ? static_cast<int>(path.size()) - 1 : -1) << "\n";
+        }
+    }
+
+    out << Algorithms::algorithmName(algorithm) << ": " << (trials - failures) << "/" << trials
+        << " queries agree with BFS on " << cols << "x" << rows << " maps";
+    if (algorithm == Constants::HPA_STAR && expectedSteps > 0) {
+        out << ", paths " << 100.0 * (actualSteps - expectedSteps) / expectedSteps << "% longer";
+    }
+    out << "\n";
+    return failures == 0;
+}
+
+bool Verification::compareWithDijkstra(Constants::AlgorithmType algorithm,
+                                       int rows, int cols, int trials,
+                                       unsigned seed, std::ostream& out) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> density(0.0, 0.35);
+    std::vector<sf::Vector2i> expected;
+    std::vector<sf::Vector2i> path;
+    Preprocessing preprocessing;
+    SearchWorkspace workspace;
+    int failures = 0;
+
+    for (int trial = 0; trial < trials; ++trial) {
+        Grid grid = MapGenerator::randomObstacles(rows, cols, density(rng), rng());
+        MapGenerator::randomTerrain(grid, Constants::MAX_TERRAIN_COST, rng());
+        sf::Vector2i startCell = MapGenerator::randomFreeCell(grid, rng);
+        sf::Vector2i goalCell = MapGenerator::randomFreeCell(grid, rng);
+        if (startCell.x == -1) {
+            continue;
+        }
+
+        preprocessing.clear();
+        bool expectedFound = Algorithms::dijkstraAlgorithm(grid, startCell, goalCell, expected, workspace);
+        bool found = runAlgorithm(algorithm, grid, startCell, goalCell, path, workspace, preprocessing);
+
+        if (found != expectedFound ||
+            (found && (pathCost(grid, path) != pathCost(grid, expected) ||
+                       !isValidPath(grid, startCell, goalCell, path)))) {
+            ++failures;
+            out << "  mismatch in trial " << trial << ": start (" << startCell.x << ", " << startCell.y
+                << ") goal (" << goalCell.x << ", " << goalCell.y << ") expected cost "
+                << (expectedFound ? pathCost(grid, expected) : -1) << ", got "
+                << (found ? pathCost(grid, path) : -1) << "\n";
+        }
+    }
+
+    out << Algorithms::algorithmName(algorithm) << ": " << (trials - failures) << "/" << trials
+        << " weighted queries agree with Dijkstra on " << cols << "x" << rows << " maps\n";
+    return failures == 0;
+}
+
+bool Verification::checkSteadyStateAllocations(Constants::AlgorithmType algorithm,
+                                               int rows, int cols, int queries,
+                                               unsigned seed, std::ostream& out) {
+    std::mt19937 rng(seed);
+    Grid grid = MapGenerator::randomObstacles(rows, cols, 0.25, rng());
+    std::vector<sf::Vector2i> starts, goals;
+    for (int i = 0; i < queries; ++i) {
+        starts.push_back(MapGenerator::randomFreeCell(grid, rng));
+        goals.push_back(MapGenerator::randomFreeCell(grid, rng));
+    }
+
+    Preprocessing preprocessing;
+    SearchWorkspace workspace;
+    std::vector<sf::Vector2i> path;
+
+    // The first pass grows the workspace and the path to their final sizes
+    for (int i = 0; i < queries; ++i) {
+        runAlgorithm(algorithm, grid, starts[i], goals[i], path, workspace, preprocessing);
+    }
+
+    long long before = AllocationCounter::allocations();
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < queries; ++i) {
+            runAlgorithm(algorithm, grid, starts[i], goals[i], path, workspace, preprocessing);
+        }
+    }
+    long long allocations = AllocationCounter::allocations() - before;
+
+    out << Algorithms::algorithmName(algorithm) << ": " << allocations << " heap allocations in "
+        << 3 * queries << " queries after warm-up\n";
+    return allocations == 0;
+}
+
+bool Verification::compareBatchWithSequential(Constants::AlgorithmType algorithm,
+                                              int rows, int cols, int queries, int threads,
+                                              unsigned seed, std::ostream& out) {
+    std::mt19937 rng(seed);
+    Grid grid = MapGenerator::randomObstacles(rows, cols, 0.3, rng());
+    std::vector<BatchPlanner::Query> batch;
+    for (int i = 0; i < queries; ++i) {
+        batch.push_back({MapGenerator::randomFreeCell(grid, rng), MapGenerator::randomFreeCell(grid, rng)});
+    }
+
+    BatchPlanner planner(threads);
+    std::vector<std::vector<sf::Vector2i>> paths;
+    std::vector<int> lengths;
+    planner.findPaths(grid, batch.data(), batch.size(), paths, algorithm);
+    planner.findLengths(grid, batch.data(), batch.size(), lengths, algorithm);
+
+    SearchWorkspace workspace;
+    std::vector<sf::Vector2i> expected;
+    int failures = 0;
+    for (int i = 0; i < queries; ++i) {
+        const BatchPlanner::Query& query = batch[i];
+        bool expectedFound = Algorithms::breadthFirstSearch(grid, query.start, query.goal, expected, workspace);
+        int expectedLength = expectedFound ? static_cast<int>(expected.size()) - 1 : -1;
+        int pathLength = paths[i].empty() ? -1 : static_cast<int>(paths[i].size()) - 1;
+        bool pathValid = paths[i].empty() || isValidPath(grid, query.start, query.goal, paths[i]);
+        if (pathLength != expectedLength || lengths[i] != expectedLength || !pathValid) {
+            ++failures;
+            out << "  mismatch in query " << i << ": expected length " << expectedLength
+                << ", got path " << pathLength << " and length " << lengths[i] << "\n";
+        }
+    }
+
+    // Bit BFS lengths must come from the distance-only search, not from
+    // paths recorded and then measured
+    bool distanceOnly = algorithm != Constants::BIT_PARALLEL_BFS ||
+                        planner.getDistanceOnlyQueries() == static_cast<std::size_t>(queries);
+    if (!distanceOnly) {
+        out << "  only " << planner.getDistanceOnlyQueries() << " of " << queries
+            << " lengths came from the distance-only search\n";
+    }
+
+    out << Algorithms::algorithmName(algorithm) << ": " << (queries - failures) << "/" << queries
+        << " batch queries on " << planner.getThreadCount() << " threads agree with sequential BFS\n";
+    return failures == 0 && distanceOnly;
+}
+
+bool Verification::checkHierarchyUpdates(int rows, int cols, int edits,
+                                         unsigned seed, std::ostream& out) {
+    std::mt19937 rng(seed);
+    Grid grid = MapGenerator::randomObstacles(rows, cols, 0.25, rng());
+    MapGenerator::randomTerrain(grid, 8, rng());
+    std::uniform_int_distribution<int> column(0, cols - 1);
+    std::uniform_int_distribution<int> row(0, rows - 1);
+
+    HierarchicalGraph updated;
+    HierarchicalGraph rebuilt;
+    updated.build(grid);
+    SearchWorkspace workspace;
+    std::vector<sf::Vector2i> expected;
+    std::vector<sf::Vector2i> path;
+    int failures = 0;
+
+    for (int edit = 0; edit < edits; ++edit) {
+        int x = column(rng);
+        int y = row(rng);
+        grid.set(x, y, grid.isWall(x, y) ? Constants::EMPTY : Constants::WALL);
+        updated.updateCell(grid, x, y);
+
+        // The patched graph must answer exactly like one built from scratch
+        rebuilt.build(grid);
+        sf::Vector2i startCell = MapGenerator::randomFreeCell(grid, rng);
+        sf::Vector2i goalCell = MapGenerator::randomFreeCell(grid, rng);
+        bool expectedFound = Algorithms::hierarchicalSearch(grid, rebuilt, startCell, goalCell, expected, workspace);
+        bool found = Algorithms::hierarchicalSearch(grid, updated, startCell, goalCell, path, workspace);
+        if (found != expectedFound || (found && pathCost(grid, path) != pathCost(grid, expected))) {
+            ++failures;
+            out << "  mismatch after edit " << edit << " at (" << x << ", " << y << ")\n";
+        }
+    }
+
+    out << "HPA*: " << (edits - failures) << "/" << edits
+        << " queries after single-cell edits agree with a full rebuild\n";
+    return failures == 0;
+}
+
+bool Verification::checkComponentUpdates(int rows, int cols, int edits,
+                                         unsigned seed, std::ostream& out) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> column(0, cols - 1);
+    std::uniform_int_distribution<int> row(0, rows - 1);
+    // Near the percolation threshold, where single walls split and join
+    // large regions most often
+    Grid grid = MapGenerator::randomObstacles(rows, cols, 0.4, rng());
+    ComponentIndex patched;
+    ComponentIndex rebuilt;
+    patched.build(grid);
+    std::vector<int> fromPatched(grid.getSize());
+    std::vector<int> fromRebuilt(grid.getSize());
+    int failures = 0;
+
+    for (int edit = 0; edit < edits; ++edit) {
+        sf::Vector2i cell(column(rng), row(rng));
+        grid.set(cell.x, cell.y, grid.isWall(cell.x, cell.y) ? Constants::EMPTY : Constants::WALL);
+        patched.updateCell(grid, cell.x, cell.y);
+        rebuilt.build(grid);
+
+        // The ids differ, but they must map one-to-one onto each other
+        std::fill(fromPatched.begin(), fromPatched.end(), -1);
+        std::fill(fromRebuilt.begin(), fromRebuilt.end(), -1);
+        bool agree = patched.getComponentCount() == rebuilt.getComponentCount();
+        for (int index = 0; index < grid.getSize() && agree; ++index) {
+            int a = patched.component(index);
+            int b = rebuilt.component(index);
+            if ((a == -1) != (b == -1)) {
+                agree = false;
+            } else if (a != -1) {
+                if (fromPatched[a] == -1 && fromRebuilt[b] == -1) {
+                    fromPatched[a] = b;
+                    fromRebuilt[b] = a;
+                }
+                agree = fromPatched[a] == b && fromRebuilt[b] == a;
+            }
+        }
+        if (!agree) {
+            ++failures;
+            out << "  components differ after toggling (" << cell.x << ", " << cell.y << "): "
+                << patched.getComponentCount() << " patched, " << rebuilt.getComponentCount() << " rebuilt\n";
+        }
+    }
+
+    out << "Components: " << (edits - failures) << "/" << edits << " wall toggles on " << cols << "x" << rows
+        << " match a full relabelling\n";
+    return failures == 0;
+}
+
+bool Verification::checkIncrementalReplanning(int rows, int cols, int edits,
+                                              unsigned seed, std::ostream& out) {
+    std::mt19937 rng(seed);
+    Grid grid = MapGenerator::randomObstacles(rows, cols, 0.2, rng());
+    MapGenerator::randomTerrain(grid, 8, rng());
+    std::uniform_int_distribution<int> column(0, cols - 1);
+    std::uniform_int_distribution<int> row(0, rows - 1);
+    sf::Vector2i startCell = MapGenerator::randomFreeCell(grid, rng);
+    sf::Vector2i goalCell = MapGenerator::randomFreeCell(grid, rng);
+
+    DStarLite planner;
+    planner.initialize(grid, startCell, goalCell);
+    SearchWorkspace workspace;
+    SearchStats stats;
+    std::vector<sf::Vector2i> expected;
+    std::vector<sf::Vector2i> path;
+    planner.replan(grid, path);
+    int failures = 0;
+    long long repaired = 0;
+
+    for (int edit = 0; edit < edits; ++edit) {
+        sf::Vector2i cell(column(rng), row(rng));
+        if (cell == planner.getStart() || cell == goalCell) {
+            continue;
+        }
+        if (edit % 3 == 0) {
+            grid.setCost(cell.x, cell.y, 1 + static_cast<int>(rng() % 8));
+        } else {
+            grid.set(cell.x, cell.y, grid.isWall(cell.x, cell.y) ? Constants::EMPTY : Constants::WALL);
+        }
+        planner.updateCell(grid, cell.x, cell.y);
+
+        // Every few edits the agent takes a step along its current path. Once
+        // it arrives it is sent somewhere new; that plan starts from scratch
+        // and is not counted as a repair.
+        if (edit % 4 == 0 && path.size() >= 2) {
+            planner.moveStart(path[1]);
+        } else if (planner.getStart() == goalCell) {
+            goalCell = MapGenerator::randomFreeCell(grid, rng);
+            planner.initialize(grid, planner.getStart(), goalCell);
+            planner.replan(grid, path);
+        }
+
+        bool found = planner.replan(grid, path, &stats);
+        repaired += stats.nodesExpanded;
+        bool expectedFound = Algorithms::dijkstraAlgorithm(grid, planner.getStart(), goalCell, expected, workspace);
+        if (found != expectedFound ||
+            (found && (pathCost(grid, path) != pathCost(grid, expected) ||
+                       !isValidPath(grid, planner.getStart(), goalCell, path)))) {
+            ++failures;
+            out << "  mismatch after edit " << edit << " at (" << cell.x << ", " << cell.y << "): expected cost "
+                << (expectedFound ? pathCost(grid, expected) : -1) << ", got "
+                << (found ? pathCost(grid, path) : -1) << "\n";
+        }
+    }
+
+    out << "D* Lite: " << (edits - failures) << "/" << edits << " replans after edits agree with Dijkstra on "
+        << cols << "x" << rows << ", " << static_cast<double>(repaired) / std::max(edits, 1)
+        << " cells repaired per edit\n";
+    return failures == 0;
+}
+
+bool Verification::checkFlowFieldUpdates(int rows, int cols, int edits,
+                                         unsigned seed, std::ostream& out) {
+    std::mt19937 rng(seed);
+    Grid grid = MapGenerator::randomObstacles(rows, cols, 0.2, rng());
+    MapGenerator::randomTerrain(grid, 8, rng());
+    std::uniform_int_distribution<int> column(0, cols - 1);
+    std::uniform_int_distribution<int> row(0, rows - 1);
+    sf::Vector2i goalCell = MapGenerator::randomFreeCell(grid, rng);
+
+    FlowField patched;
+    FlowField rebuilt;
+    SearchStats stats;
+    patched.build(grid, goalCell, &stats);
+    int fullBuild = stats.nodesExpanded;
+    long long settled = 0;
+    std::vector<sf::Vector2i> path;
+    int failures = 0;
+
+    for (int edit = 0; edit < edits; ++edit) {
+        sf::Vector2i cell(column(rng), row(rng));
+        if (edit % 3 == 0) {
+            grid.setCost(cell.x, cell.y, 1 + static_cast<int>(rng() % 8));
+        } else if (cell != goalCell) {
+            grid.set(cell.x, cell.y, grid.isWall(cell.x, cell.y) ? Constants::EMPTY : Constants::WALL);
+        }
+        patched.updateCell(grid, cell.x, cell.y, &stats);
+        settled += stats.nodesExpanded;
+        rebuilt.build(grid, goalCell);
+
+        // Directions may break ties differently; distances may not, and
+        // following either field must cost exactly the distance
+        bool agree = patched.isCurrent(grid, goalCell);
+        for (int index = 0; index < grid.getSize() && agree; ++index) {
+            agree = patched.distance(index) == rebuilt.distance(index);
+        }
+        sf::Vector2i from = MapGenerator::randomFreeCell(grid, rng);
+        bool found = patched.followPath(grid, from, path);
+        int expected = rebuilt.distance(grid.index(from.x, from.y));
+        if (found != (expected != FlowField::UNREACHABLE) ||
+            (found && (pathCost(grid, path) != expected || !isValidPath(grid, from, goalCell, path)))) {
+            agree = false;
+        }
+        if (!agree) {
+            ++failures;
+            out << "  field differs from a rebuild after editing (" << cell.x << ", " << cell.y << ")\n";
+        }
+    }
+
+    out << "Flow field: " << (edits - failures) << "/" << edits << " patched fields match a rebuild on " << cols
+        << "x" << rows << ", " << static_cast<double>(settled) / std::max(edits, 1) << " cells settled per edit vs "
+        << fullBuild << " for a full build\n";
+    return failures == 0;
+}
+
+bool Verification::checkPathCache(int rows, int cols, int queries,
+                                  unsigned seed, std::ostream& out) {
+    const Constants::AlgorithmType algorithms[] = {Constants::BFS, Constants::DIJKSTRA, Constants::ASTAR};
+    std::mt19937 rng(seed);
+    Grid grid = MapGenerator::randomObstacles(rows, cols, 0.25, rng());
+    MapGenerator::randomTerrain(grid, 8, rng());
+    std::uniform_int_distribution<int> column(0, cols - 1);
+    std::uniform_int_distribution<int> row(0, rows - 1);
+
+    // Few enough endpoints that queries repeat between edits
+    sf::Vector2i endpoints[6];
+    for (sf::Vector2i& endpoint : endpoints) {
+        endpoint = MapGenerator::randomFreeCell(grid, rng);
+    }
+
+    PathCache cache;
+    Preprocessing preprocessing;
+    SearchWorkspace workspace;
+    SearchStats stats;
+    std::vector<sf::Vector2i> path;
+    int failures = 0;
+
+    for (int query = 0; query < queries; ++query) {
+        if (rng() % 20 == 0) {
+            std::uint64_t before = grid.getRevision();
+            sf::Vector2i cell(column(rng), row(rng));
+            if (std::find(std::begin(endpoints), std::end(endpoints), cell) != std::end(endpoints)) {
+                grid.setCost(cell.x, cell.y, 1 + static_cast<int>(rng() % 8));
+            } else {
+                grid.set(cell.x, cell.y, grid.isWall(cell.x, cell.y) ? Constants::EMPTY : Constants::WALL);
+            }
+            if (grid.getRevision() == before) {
+                ++failures;
+                out << "  edit at (" << cell.x << ", " << cell.y << ") kept revision " << before << "\n";
+            }
+        }
+
+        Constants::AlgorithmType algorithm = algorithms[rng() % 3];
+        sf::Vector2i startCell = endpoints[rng() % 6];
+        sf::Vector2i goalCell = endpoints[rng() % 6];
+        PathCache::Key key = {grid.getRevision(), algorithm, Constants::MANHATTAN, Movement(), startCell, goalCell};
+
+        const PathCache::Entry* cached = cache.find(key);
+        preprocessing.clear();
+        bool found = runAlgorithm(algorithm, grid, startCell, goalCell, path, workspace, preprocessing);
+        if (!cached) {
+            cache.store(key, found, path, stats);
+        } else if (cached->found != found || cached->path != path) {
+            ++failures;
+            out << "  stale " << Algorithms::algorithmName(algorithm) << " entry for (" << startCell.x << ", "
+                << startCell.y << ") -> (" << goalCell.x << ", " << goalCell.y << ") at query " << query << "\n";
+        }
+    }
+
+    out << "Path cache: " << (queries - failures) << "/" << queries << " queries consistent on " << cols << "x"
+        << rows << ", " << cache.getHits() << " hits / " << cache.getMisses() << " misses\n";
+    return failures == 0;
+}
+
+// Like isValidPath, but an agent may also wait in place
+static bool isValidTrajectory(const Grid& grid, const MultiAgentPlanner::Agent& agent,
+                              const std::vector<sf::Vector2i>& path) {
+    if (path.empty() || path.front() != agent.start || path.back() != agent.goal) {
+        return false;
+    }
+    for (size_t i = 0; i < path.size(); ++i) {
+        if (!grid.isWalkable(path[i].x, path[i].y)) {
+            return false;
+        }
+        if (i > 0 && std::abs(path[i].x - path[i - 1].x) + std::abs(path[i].y - path[i - 1].y) > 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Verification::checkMultiAgentPlanning(int rows, int cols, int agents, int trials,
+                                           unsigned seed, std::ostream& out) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> density(0.0, 0.3);
+    MultiAgentPlanner planner;
+    SearchWorkspace workspace;
+    std::vector<sf::Vector2i> path;
+    std::vector<std::vector<sf::Vector2i>> cooperative;
+    std::vector<std::vector<sf::Vector2i>> conflictBased;
+    bool runConflictBased = agents <= 8;
+    int failures = 0;
+    int solved = 0;
+    long long independentCost = 0;
+    long long cooperativeCost = 0;
+    long long conflictBasedCost = 0;
+    long long solvedIndependentCost = 0;
+
+    for (int trial = 0; trial < trials; ++trial) {
+        Grid grid = MapGenerator::randomObstacles(rows, cols, density(rng), rng());
+        std::vector<sf::Vector2i> starts = MapGenerator::distinctConnectedCells(grid, agents, rng);
+        std::vector<sf::Vector2i> goals = MapGenerator::distinctConnectedCells(grid, agents, rng);
+        if (static_cast<int>(starts.size()) < agents) {
+            continue;
+        }
+
+        // Planned alone, every agent takes its BFS distance; no team can do better
+        std::vector<MultiAgentPlanner::Agent> team;
+        long long lowerBound = 0;
+        for (int i = 0; i < agents; ++i) {
+            team.push_back({starts[i], goals[i]});
+            Algorithms::breadthFirstSearch(grid, starts[i], goals[i], path, workspace);
+            lowerBound += static_cast<long long>(path.size()) - 1;
+        }
+
+        bool found = planner.planCooperative(grid, team, cooperative, MultiAgentPlanner::DEFAULT_WINDOW, rng());
+        bool valid = found && MultiAgentPlanner::countConflicts(cooperative) == 0;
+        for (int i = 0; i < agents && valid; ++i) {
+            valid = isValidTrajectory(grid, team[i], cooperative[i]);
+        }
+        long long cost = MultiAgentPlanner::sumOfCosts(cooperative);
+        if (!valid || cost < lowerBound) {
+            ++failures;
+            out << "  WHCA* failed in trial " << trial << ": found " << found << ", "
+                << MultiAgentPlanner::countConflicts(cooperative) << " collisions, cost " << cost
+                << " vs lower bound " << lowerBound << "\n";
+            continue;
+        }
+        independentCost += lowerBound;
+        cooperativeCost += cost;
+
+        // CBS may give up on a crowded map; whatever it returns must still be right
+        if (!runConflictBased || !planner.planConflictBased(grid, team, conflictBased)) {
+            continue;
+        }
+        valid = MultiAgentPlanner::countConflicts(conflictBased) == 0;
+        for (int i = 0; i < agents && valid; ++i) {
+            valid = isValidTrajectory(grid, team[i], conflictBased[i]);
+        }
+        long long optimalCost = MultiAgentPlanner::sumOfCosts(conflictBased);
+        if (!valid || optimalCost < lowerBound || optimalCost > cost) {
+            ++failures;
+            out << "  CBS failed in trial " << trial << ": " << MultiAgentPlanner::countConflicts(conflictBased)
+                << " collisions, cost " << optimalCost << " vs WHCA* " << cost << " and lower bound "
+                << lowerBound << "\n";
+            continue;
+        }
+        ++solved;
+        solvedIndependentCost += lowerBound;
+        conflictBasedCost += optimalCost;
+    }
+
+    out << "Multi-agent: " << (trials - failures) << "/" << trials << " teams of " << agents
+        << " collision-free on " << cols << "x" << rows << ", WHCA* cost +"
+        << 100.0 * (cooperativeCost - independentCost) / std::max(independentCost, 1LL) << "% over planning alone";
+    if (runConflictBased) {
+        out << ", CBS solved " << solved << " at +"
+            << 100.0 * (conflictBasedCost - solvedIndependentCost) / std::max(solvedIndependentCost, 1LL) << "%";
+    }
+    out << "\n";
+    return failures == 0;
+}
+
+bool Verification::checkEightConnected(int rows, int cols, int trials,
+                                       unsigned seed, std::ostream& out) {
+    const Constants::CornerPolicy policies[] = {
+        Constants::CUT_CORNERS, Constants::NO_SQUEEZE, Constants::NO_CUT_CORNERS
+    };
+    const Constants::HeuristicType heuristics[] = {Constants::MANHATTAN, Constants::OCTILE, Constants::EUCLIDEAN};
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> density(0.0, 0.35);
+    SearchWorkspace workspace;
+    std::vector<sf::Vector2i> straight;
+    std::vector<sf::Vector2i> expected;
+    std::vector<sf::Vector2i> path;
+    int failures = 0;
+    long long straightCost = 0;
+    long long diagonalCost = 0;
+
+    for (int trial = 0; trial < trials; ++trial) {
+        Grid grid = MapGenerator::randomObstacles(rows, cols, density(rng), rng());
+        MapGenerator::randomTerrain(grid, 8, rng());
+        sf::Vector2i startCell = MapGenerator::randomFreeCell(grid, rng);
+        sf::Vector2i goalCell = MapGenerator::randomFreeCell(grid, rng);
+        if (startCell.x == -1) {
+            continue;
+        }
+
+        bool straightFound = Algorithms::dijkstraAlgorithm(grid, startCell, goalCell, straight, workspace);
+        long long looserCost = 0;
+        bool agree = true;
+        for (Constants::CornerPolicy policy : policies) {
+            Movement movement(Constants::EIGHT_CONNECTED, policy);
+            bool found = Algorithms::dijkstraAlgorithm(grid, startCell, goalCell, expected, workspace, nullptr, movement);
+            long long cost = found ? pathCost(grid, expected, movement) : 0;
+
+            // Diagonals that need a free side cell never reach anything a
+            // 4-connected search cannot, and never cost more than its path
+            if (found && !isValidPath(grid, startCell, goalCell, expected, movement)) {
+                agree = false;
+            }
+            if (policy != Constants::CUT_CORNERS && found != straightFound) {
+                agree = false;
+            }
+            if (found && straightFound && cost > Movement::STRAIGHT_WEIGHT * pathCost(grid, straight)) {
+                agree = false;
+            }
+            if (found && cost < looserCost) {
+                agree = false;
+            }
+            looserCost = cost;
+
+            for (Constants::HeuristicType heuristic : heuristics) {
+                bool aStarFound = Algorithms::aStarSearch(grid, startCell, goalCell, path, workspace, heuristic,
+                                                          nullptr, movement);
+                if (aStarFound != found ||
+                    (found && (pathCost(grid, path, movement) != cost ||
+                               !isValidPath(grid, startCell, goalCell, path, movement)))) {
+                    agree = false;
+                }
+            }
+            bool breadthFound = Algorithms::breadthFirstSearch(grid, startCell, goalCell, path, workspace,
+                                                               nullptr, movement);
+            if (breadthFound != found || (found && !isValidPath(grid, startCell, goalCell, path, movement))) {
+                agree = false;
+            }
+            bool depthFound = Algorithms::depthFirstSearch(grid, startCell, goalCell, path, workspace,
+                                                           nullptr, movement);
+            if (depthFound != found || (found && !isValidPath(grid, startCell, goalCell, path, movement))) {
+                agree = false;
+            }
+
+            if (policy == Constants::NO_CUT_CORNERS && found && straightFound) {
+                straightCost += Movement::STRAIGHT_WEIGHT * pathCost(grid, straight);
+                diagonalCost += cost;
+            }
+        }
+
+        if (!agree) {
+            ++failures;
+            out << "  mismatch in trial " << trial << ": start (" << startCell.x << ", " << startCell.y
+                << ") goal (" << goalCell.x << ", " << goalCell.y << ")\n";
+        }
+    }
+
+    out << "8-connected: " << (trials - failures) << "/" << trials << " queries agree across DFS, BFS, Dijkstra "
+        << "and A* under every corner policy on " << cols << "x" << rows << " maps, paths "
+        << 100.0 * (straightCost - diagonalCost) / std::max(straightCost, 1LL)
+        << "% cheaper than 4-connected without corner cutting\n";
+    return failures == 0;
+}
+
+bool Verification::checkContractionHierarchy(int rows, int cols, int queries,
+                                             unsigned seed, std::ostream& out) {
+    std::mt19937 rng(seed);
+    Grid grid = MapGenerator::randomObstacles(rows, cols, 0.25, rng());
+    MapGenerator::randomTerrain(grid, 9, rng());
+
+    ContractionHierarchy single;
+    ContractionHierarchy parallel;
+    single.build(grid, 1);
+    parallel.build(grid, 4);
+
+    std::string filename = (std::filesystem::temp_directory_path() / "verify_contraction_hierarchy.ch").string();
+    ContractionHierarchy loaded;
+    bool roundTrip = parallel.save(filename) && loaded.load(filename, grid);
+    std::remove(filename.c_str());
+    if (!roundTrip) {
+        out << "CH: failed to save and reload the hierarchy\n";
+        return false;
+    }
+
+    int failures = 0;
+    if (single.getShortcutCount() != parallel.getShortcutCount()) {
+        ++failures;
+        out << "  1 thread added " << single.getShortcutCount() << " shortcuts, 4 threads "
+            << parallel.getShortcutCount() << "\n";
+    }
+
+    SearchWorkspace workspace;
+    std::vector<sf::Vector2i> expected, path, singlePath;
+    for (int i = 0; i < queries; ++i) {
+        sf::Vector2i startCell = MapGenerator::randomFreeCell(grid, rng);
+        sf::Vector2i goalCell = MapGenerator::randomFreeCell(grid, rng);
+        bool expectedFound = Algorithms::dijkstraAlgorithm(grid, startCell, goalCell, expected, workspace);
+        bool found = Algorithms::contractionHierarchySearch(grid, loaded, startCell, goalCell, path, workspace);
+        Algorithms::contractionHierarchySearch(grid, single, startCell, goalCell, singlePath, workspace);
+
+        bool agrees = found == expectedFound && singlePath == path;
+        if (agrees && found) {
+            agrees = isValidPath(grid, startCell, goalCell, path) &&
+                     pathCost(grid, path) == pathCost(grid, expected);
+        }
+        if (!agrees) {
+            ++failures;
+            out << "  (" << startCell.x << ", " << startCell.y << ") -> (" << goalCell.x << ", " << goalCell.y
+                << "): Dijkstra cost " << (expectedFound ? pathCost(grid, expected) : -1) << ", CH cost "
+                << (found ? pathCost(grid, path) : -1) << "\n";
+        }
+    }
+
+    out << "CH: " << (queries - failures) << "/" << queries << " queries match Dijkstra on " << cols << "x" << rows
+        << " after a save and reload, " << parallel.getShortcutCount() << " shortcuts over "
+        << parallel.getNodeCount() << " cells, identical on 1 and 4 threads\n";
+    return failures == 0;
+}
+
+bool Verification::checkAnytimeSearch(int rows, int cols, int queries,
+                                      unsigned seed, std::ostream& out) {
+    std::mt19937 rng(seed);
+    Grid grid = MapGenerator::randomObstacles(rows, cols, 0.25, rng());
+    MapGenerator::randomTerrain(grid, 9, rng());
+
+    SearchWorkspace workspace;
+    std::vector<sf::Vector2i> expected, first, path, late;
+    SearchStats firstStats, stats, lateStats;
+    int failures = 0;
+    int found = 0;
+    int timeouts = 0;
+    double excess = 0.0;
+    double bounds = 0.0;
+    for (int i = 0; i < queries; ++i) {
+        sf::Vector2i startCell = MapGenerator::randomFreeCell(grid, rng);
+        sf::Vector2i goalCell = MapGenerator::randomFreeCell(grid, rng);
+        bool expectedFound = Algorithms::dijkstraAlgorithm(grid, startCell, goalCell, expected, workspace);
+        bool firstFound = Algorithms::anytimeSearch(grid, startCell, goalCell, first, workspace,
+                                                    std::chrono::steady_clock::time_point::max(), &firstStats, 1);
+        bool pathFound = Algorithms::anytimeSearch(grid, startCell, goalCell, path, workspace,
+                                                   std::chrono::steady_clock::time_point::max(), &stats);
+        bool lateFound = Algorithms::anytimeSearch(grid, startCell, goalCell, late, workspace,
+                                                   std::chrono::steady_clock::time_point::min(), &lateStats);
+
+        bool agrees = firstFound == expectedFound && pathFound == expectedFound && (expectedFound || !lateFound);
+        timeouts += lateStats.timedOut;
+        if (agrees && expectedFound) {
+            long long optimal = pathCost(grid, expected);
+            agrees = firstStats.solutions == 1 && isValidPath(grid, startCell, goalCell, first) &&
+                     pathCost(grid, first) <= firstStats.suboptimalityBound * optimal + 1e-3 &&
+                     isValidPath(grid, startCell, goalCell, path) && pathCost(grid, path) == optimal &&
+                     stats.suboptimalityBound == 1.0f &&
+                     (lateFound ? !lateStats.timedOut && isValidPath(grid, startCell, goalCell, late) &&
+                                      pathCost(grid, late) <= lateStats.suboptimalityBound * optimal + 1e-3
+                                : lateStats.timedOut && late.empty());
+            if (optimal > 0) {
+                ++found;
+                excess += static_cast<double>(pathCost(grid, first) - optimal) / optimal;
+                bounds += firstStats.suboptimalityBound;
+            }
+        }
+        if (!agrees) {
+            ++failures;
+            out << "  (" << startCell.x << ", " << startCell.y << ") -> (" << goalCell.x << ", " << goalCell.y
+                << "): Dijkstra cost " << (expectedFound ? pathCost(grid, expected) : -1) << ", first path "
+                << (firstFound ? pathCost(grid, first) : -1) << " within " << firstStats.suboptimalityBound
+                << ", final path " << (pathFound ? pathCost(grid, path) : -1) << " within "
+                << stats.suboptimalityBound << "\n";
+        }
+    }
+
+    out << "ARA*: " << (queries - failures) << "/" << queries << " queries within their bound on " << cols << "x"
+        << rows << ", first paths " << (found > 0 ? 100.0 * excess / found : 0.0) << "% above optimal on average"
+        << " with a mean bound of " << (found > 0 ? bounds / found : 1.0) << ", " << timeouts
+        << " timed out with the deadline passed\n";
+    return failures == 0;
+}
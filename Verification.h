@@ -0,0 +1,110 @@
+#pragma once
+
+#include <ostream>
+#include <vector>
+#include <SFML/System/Vector2.hpp>
+#include "Constants.h"
+#include "Grid.h"
+#include "Movement.h"
+
+// Cross-checks the optimal planners against breadth-first search, which is
+// trivially correct on unit-cost grids, using randomly generated maps.
+class Verification {
+public:
+    // Runs `trials` random queries on fresh random maps and reports every
+    // mismatch in reachability or path length. Returns true if all agree.
+    static bool compareWithBreadthFirst(Constants::AlgorithmType algorithm,
+                                        int rows, int cols, int trials,
+                                        unsigned seed, std::ostream& out);
+
+    // Same as compareWithBreadthFirst, but on maps with random terrain costs,
+    // comparing path costs against Dijkstra instead of lengths against BFS
+    static bool compareWithDijkstra(Constants::AlgorithmType algorithm,
+                                    int rows, int cols, int trials,
+                                    unsigned seed, std::ostream& out);
+
+    // Runs the same queries repeatedly through one SearchWorkspace and checks
+    // that nothing reaches the heap once the first pass has warmed it up
+    static bool checkSteadyStateAllocations(Constants::AlgorithmType algorithm,
+                                            int rows, int cols, int queries,
+                                            unsigned seed, std::ostream& out);
+
+    // Answers the same queries through a multi-threaded BatchPlanner, as
+    // paths and as lengths, and checks both against sequential BFS. Bit
+    // BFS lengths must all come from its distance-only search.
+    static bool compareBatchWithSequential(Constants::AlgorithmType algorithm,
+                                           int rows, int cols, int queries, int threads,
+                                           unsigned seed, std::ostream& out);
+
+    // Toggles random walls, patching a HierarchicalGraph cluster by cluster,
+    // and checks after every edit that it answers like a freshly built one
+    static bool checkHierarchyUpdates(int rows, int cols, int edits,
+                                      unsigned seed, std::ostream& out);
+
+    // Toggles random walls, patching a ComponentIndex after each one, and
+    // checks that it groups the free cells exactly like a fresh labelling
+    static bool checkComponentUpdates(int rows, int cols, int edits,
+                                      unsigned seed, std::ostream& out);
+
+    // Walks an agent along its D* Lite path while toggling random walls and
+    // terrain, replanning incrementally after each edit, and checks every
+    // replanned path cost against a fresh Dijkstra
+    static bool checkIncrementalReplanning(int rows, int cols, int edits,
+                                           unsigned seed, std::ostream& out);
+
+    // Edits random walls and terrain under a FlowField, patching it after
+    // each edit, and checks every distance and direction against a freshly
+    // built field
+    static bool checkFlowFieldUpdates(int rows, int cols, int edits,
+                                      unsigned seed, std::ostream& out);
+
+    // Repeats queries from a small pool of endpoints and algorithms while
+    // editing random cells, and checks that every PathCache hit returns what
+    // a fresh search of the current map would, and that edits bump the
+    // grid revision so nothing stale is served
+    static bool checkPathCache(int rows, int cols, int queries,
+                               unsigned seed, std::ostream& out);
+
+    // Plans teams of agents between distinct random cells with WHCA*, and
+    // for small teams with CBS, and checks that every path moves in unit
+    // steps or waits, arrives, and never collides with another. CBS must
+    // cost no more than WHCA* and no less than the agents planned alone.
+    static bool checkMultiAgentPlanning(int rows, int cols, int agents, int trials,
+                                       unsigned seed, std::ostream& out);
+
+    // Runs 8-connected DFS, BFS, Dijkstra and A* (every heuristic) under
+    // each corner policy on maps with random terrain, and checks that they
+    // agree on reachability, that every step obeys the policy, that A*
+    // matches Dijkstra's cost, and that looser policies never cost more
+    static bool checkEightConnected(int rows, int cols, int trials,
+                                    unsigned seed, std::ostream& out);
+
+    // Builds a contraction hierarchy on one thread and on several, saves
+    // the second to a temporary file and loads it back, and checks that both
+    // builds are identical and that the loaded one answers random queries
+    // with valid paths of the same cost as Dijkstra
+    static bool checkContractionHierarchy(int rows, int cols, int queries,
+                                          unsigned seed, std::ostream& out);
+
+    // Runs ARA* on random weighted queries three times: limited to its
+    // first path, with no deadline, and with a deadline already passed.
+    // Checks that the first path is valid and costs no more than its
+    // reported bound times Dijkstra's cost, that the unhurried run is
+    // optimal with a bound of 1, and that the late run either returns such
+    // a first path or reports a timeout and returns none
+    static bool checkAnytimeSearch(int rows, int cols, int queries,
+                                   unsigned seed, std::ostream& out);
+
+    // Sum of the costs of every step after the first cell: the terrain cost
+    // of the cell entered, weighted as the movement rules weigh that step
+    static long long pathCost(const Grid& grid, const std::vector<sf::Vector2i>& path,
+                              const Movement& movement = Movement());
+
+    // A path is valid if it runs from start to goal over free cells in
+    // steps the movement rules allow, unit steps by default
+    static bool isValidPath(const Grid& grid,
+                            sf::Vector2i startCell,
+                            sf::Vector2i goalCell,
+                            const std::vector<sf::Vector2i>& path,
+                            const Movement& movement = Movement());
+};
@@ -0,0 +1,91 @@
+#include "WallBitmap.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define WALL_BITMAP_HAS_AVX2_KERNEL 1
+#endif
+
+WallBitmap::WallBitmap() : rows(0), cols(0), wordsPerRow(0), revision(0), built(false) {}
+
+void WallBitmap::clear() {
+    open.clear();
+    built = false;
+}
+
+void WallBitmap::build(const Grid& grid) {
+    rows = grid.getRows();
+    cols = grid.getCols();
+
+    // Keep one spare bit after the last column, then round up to 4 words
+    int words = (cols + 1 + 63) / 64;
+    wordsPerRow = (words + 3) & ~3;
+    open.assign(planeSize(), 0);
+
+    for (int y = 0; y < rows; ++y) {
+        for (int x = 0; x < cols; ++x) {
+            if (!grid.isWall(x, y)) {
+                open[wordIndex(x, y)] |= bit(x);
+            }
+        }
+    }
+    revision = grid.getRevision();
+    built = true;
+}
+
+// Bit x of a word is column 64 * word + x, so moving one column right is a
+// left shift with the carry coming from the top bit of the previous word.
+static bool expandRowScalar(const WallBitmap::Word* open, const WallBitmap::Word* frontier,
+                            WallBitmap::Word* next, WallBitmap::Word* visited,
+                            int words, int stride) {
+    WallBitmap::Word any = 0;
+    for (int w = 0; w < words; ++w) {
+        WallBitmap::Word f = frontier[w];
+        WallBitmap::Word reached = (f << 1) | (frontier[w - 1] >> 63) |
+                                   (f >> 1) | (frontier[w + 1] << 63) |
+                                   frontier[w - stride] | frontier[w + stride];
+        reached &= open[w] & ~visited[w];
+        next[w] = reached;
+        visited[w] |= reached;
+        any |= reached;
+    }
+    return any != 0;
+}
+
+#ifdef WALL_BITMAP_HAS_AVX2_KERNEL
+__attribute__((target("avx2")))
+static bool expandRowAvx2(const WallBitmap::Word* open, const WallBitmap::Word* frontier,
+                          WallBitmap::Word* next, WallBitmap::Word* visited,
+                          int words, int stride) {
+    __m256i any = _mm256_setzero_si256();
+    for (int w = 0; w < words; w += 4) {
+        __m256i f = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(frontier + w));
+        __m256i before = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(frontier + w - 1));
+        __m256i after = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(frontier + w + 1));
+        __m256i above = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(frontier + w - stride));
+        __m256i below = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(frontier + w + stride));
+
+        __m256i reached = _mm256_or_si256(
+            _mm256_or_si256(_mm256_slli_epi64(f, 1), _mm256_srli_epi64(before, 63)),
+            _mm256_or_si256(_mm256_srli_epi64(f, 1), _mm256_slli_epi64(after, 63)));
+        reached = _mm256_or_si256(reached, _mm256_or_si256(above, below));
+
+        __m256i seen = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(visited + w));
+        __m256i free = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(open + w));
+        reached = _mm256_andnot_si256(seen, _mm256_and_si256(reached, free));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(next + w), reached);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(visited + w), _mm256_or_si256(seen, reached));
+        any = _mm256_or_si256(any, reached);
+    }
+    return !_mm256_testz_si256(any, any);
+}
+#endif
+
+WallBitmap::RowKernel WallBitmap::rowKernel() {
+#ifdef WALL_BITMAP_HAS_AVX2_KERNEL
+    static const RowKernel kernel = __builtin_cpu_supports("avx2") ? expandRowAvx2 : expandRowScalar;
+    return kernel;
+#else
+    return expandRowScalar;
+#endif
+}
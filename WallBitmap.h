@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Grid.h"
+
+// One bit per cell, set where the cell is walkable, for word-parallel BFS.
+//
+// Each row is padded to a multiple of four 64-bit words (one AVX2 register)
+// with at least one spare bit past the last column, and the plane has an
+// all-zero guard row above and below. Shifting a row by one bit or reading
+// the row above/below therefore never needs a bounds check, and bits can
+// never leak from one row into the next.
+class WallBitmap {
+public:
+    typedef std::uint64_t Word;
+
+    WallBitmap();
+
+    void build(const Grid& grid);
+    void clear();
+    bool isBuilt() const { return built; }
+
+    // True if built for exactly this grid revision
+    bool isCurrent(const Grid& grid) const { return built && revision == grid.getRevision(); }
+
+    int getRows() const { return rows; }
+    int getCols() const { return cols; }
+    int getWordsPerRow() const { return wordsPerRow; }
+
+    // Size of a plane with this layout, guard rows included
+    std::size_t planeSize() const { return static_cast<std::size_t>(rows + 2) * wordsPerRow; }
+
+    // Word holding cell (x, y) within a plane, and the cell's bit within it
+    std::size_t wordIndex(int x, int y) const {
+        return static_cast<std::size_t>(y + 1) * wordsPerRow + (x >> 6);
+    }
+    static Word bit(int x) { return Word(1) << (x & 63); }
+
+    bool isOpen(int x, int y) const {
+        return x >= 0 && x < cols && y >= 0 && y < rows && (open[wordIndex(x, y)] & bit(x)) != 0;
+    }
+
+    const Word* data() const { return open.data(); }
+
+    // One BFS step over `words` consecutive words of the planes (a whole
+    // number of rows): every open, unvisited cell next to a frontier cell is
+    // written to next and marked visited. The AVX2 kernel is used when the
+    // CPU has it. Returns true if any cell was reached.
+    typedef bool (*RowKernel)(const Word* open, const Word* frontier, Word* next, Word* visited,
+                              int words, int stride);
+    static RowKernel rowKernel();
+
+private:
+    std::vector<Word> open;
+    int rows;
+    int cols;
+    int wordsPerRow;
+    std::uint64_t revision;
+    bool built;
+};
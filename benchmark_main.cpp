@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include "Algorithms.h"
+#include "Benchmark.h"
+#include "Constants.h"
+#include "MapGenerator.h"
+#include "MultiAgentPlanner.h"
+
+// Headless benchmark runner; unlike the visualizer it links no SFML library
+// and opens no window, so it runs on a machine without a display.
+
+// WHCA* throughput: teams of growing size, each on a map large enough that
+// its agents fill about a sixth of the free cells at most
+static int runAgentThroughput() {
+    const int teamSizes[] = {100, 1000, 10000};
+    const int mapSizes[] = {64, 128, 256};
+
+    MultiAgentPlanner planner;
+    std::vector<std::vector<sf::Vector2i>> paths;
+    for (int i = 0; i < 3; ++i) {
+        std::mt19937 rng(17 + i);
+        Grid grid = MapGenerator::randomObstacles(mapSizes[i], mapSizes[i], 0.1, rng());
+        std::vector<sf::Vector2i> starts = MapGenerator::distinctConnectedCells(grid, teamSizes[i], rng);
+        std::vector<sf::Vector2i> goals = MapGenerator::distinctConnectedCells(grid, teamSizes[i], rng);
+        std::vector<MultiAgentPlanner::Agent> team;
+        for (std::size_t agent = 0; agent < starts.size() && agent < goals.size(); ++agent) {
+            team.push_back({starts[agent], goals[agent]});
+        }
+
+        auto startTime = std::chrono::steady_clock::now();
+        planner.planCooperative(grid, team, paths);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+
+        // Random endpoints can leave an agent sealed in a dead end behind one
+        // parked on its goal, which no planner can untangle
+        std::size_t arrived = 0;
+        for (std::size_t agent = 0; agent < team.size(); ++agent) {
+            arrived += paths[agent].back() == team[agent].goal;
+        }
+
+        std::cout << "WHCA*: " << team.size() << " agents on " << mapSizes[i] << "x" << mapSizes[i] << " in "
+                  << elapsed.count() * 1000.0 << " ms, " << team.size() / elapsed.count() << " agents/s, "
+                  << planner.getNodesExpanded() / elapsed.count() << " nodes/s, sum of costs "
+                  << MultiAgentPlanner::sumOfCosts(paths) << ", " << MultiAgentPlanner::countConflicts(paths)
+                  << " collisions, " << arrived << " arrived\n";
+    }
+    return 0;
+}
+
+// The search kernel against the loops it replaced, ALT against plain A*,
+// and contraction hierarchy queries
+static int runComparisons() {
+    bool passed = Benchmark::compareSearchKernel(256, 256, 200, 21, std::cout);
+    passed &= Benchmark::compareLandmarks(256, 256, 500, 22, std::cout);
+    passed &= Benchmark::compareContractionHierarchy(256, 256, 1000, 23, std::cout);
+    return passed ? 0 : 1;
+}
+
+// Comma-separated names as the tables print them, such as "A*,JPS+,CH"
+static bool parseAlgorithms(const std::string& list, std::vector<Constants::AlgorithmType>& algorithms) {
+    const std::vector<Constants::AlgorithmType> known = Benchmark::singleAgentAlgorithms();
+    algorithms.clear();
+    std::size_t begin = 0;
+    while (begin <= list.size()) {
+        std::size_t end = std::min(list.find(',', begin), list.size());
+        std::string name = list.substr(begin, end - begin);
+        auto match = std::find_if(known.begin(), known.end(), [&](Constants::AlgorithmType algorithm) {
+            return name == Algorithms::algorithmName(algorithm);
+        });
+        if (match == known.end()) {
+            std::cerr << "Unknown algorithm \"" << name << "\"\n";
+            return false;
+        }
+        algorithms.push_back(*match);
+        begin = end + 1;
+    }
+    return true;
+}
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--agents | --compare | --scen FILE [--map FILE] | options]\n"
+              << "  --agents         time WHCA* on teams of 100, 1,000 and 10,000 agents\n"
+              << "  --compare        time the search kernel, ALT and contraction hierarchies\n"
+              << "  --scen FILE      run a Moving AI scenario bucket by bucket, checking every path\n"
+              << "                   against its optimal length; --map names the .map file if it\n"
+              << "                   is not next to the scenario\n"
+              << "Otherwise every single-agent planner is timed on one map:\n"
+              << "  --map FILE       the visualizer's terrain map format, instead of a generated map\n"
+              << "  --rows N         generated map size (256 x 256)\n"
+              << "  --cols N\n"
+              << "  --walls P        chance of a cell being a wall (0.25)\n"
+              << "  --terrain MAX    random terrain costs from 1 to MAX (1)\n"
+              << "  --maze           a maze instead of random walls\n"
+              << "  --queries N      start/goal pairs (1000)\n"
+              << "  --warmup N       untimed passes over the queries (1)\n"
+              << "  --repeats N      timed passes over the queries (5)\n"
+              << "  --seed N         seed for the map and the queries (1)\n"
+              << "  --json FILE      where to write the results as JSON (benchmark.json), \"\" for nowhere\n"
+              << "Either way:\n"
+              << "  --algorithms A,B only these planners, named as in the tables (all)\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::strcmp(argv[1], "--agents") == 0) {
+        return runAgentThroughput();
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--compare") == 0) {
+        return runComparisons();
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--help") == 0) {
+        printUsage(argv[0]);
+        return 0;
+    }
+
+    Benchmark::SuiteSettings settings;
+    std::string scenarioFile;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (hasValue && std::strcmp(argv[i], "--scen") == 0) {
+            scenarioFile = argv[++i];
+        } else if (hasValue && std::strcmp(argv[i], "--algorithms") == 0) {
+            if (!parseAlgorithms(argv[++i], settings.algorithms)) {
+                return 2;
+            }
+        } else if (std::strcmp(argv[i], "--maze") == 0) {
+            settings.maze = true;
+        } else if (hasValue && std::strcmp(argv[i], "--map") == 0) {
+            settings.mapFile = argv[++i];
+        } else if (hasValue && std::strcmp(argv[i], "--rows") == 0) {
+            settings.rows = std::atoi(argv[++i]);
+        } else if (hasValue && std::strcmp(argv[i], "--cols") == 0) {
+            settings.cols = std::atoi(argv[++i]);
+        } else if (hasValue && std::strcmp(argv[i], "--walls") == 0) {
+            settings.wallDensity = std::atof(argv[++i]);
+        } else if (hasValue && std::strcmp(argv[i], "--terrain") == 0) {
+            settings.maxTerrainCost = std::atoi(argv[++i]);
+        } else if (hasValue && std::strcmp(argv[i], "--queries") == 0) {
+            settings.queries = std::atoi(argv[++i]);
+        } else if (hasValue && std::strcmp(argv[i], "--warmup") == 0) {
+            settings.warmup = std::atoi(argv[++i]);
+        } else if (hasValue && std::strcmp(argv[i], "--repeats") == 0) {
+            settings.repetitions = std::atoi(argv[++i]);
+        } else if (hasValue && std::strcmp(argv[i], "--seed") == 0) {
+            settings.seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (hasValue && std::strcmp(argv[i], "--json") == 0) {
+            settings.jsonFile = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (!scenarioFile.empty()) {
+        return Benchmark::runScenarios(scenarioFile, settings.mapFile, settings.algorithms, std::cout) ? 0 : 1;
+    }
+    if (settings.rows <= 0 || settings.cols <= 0 || settings.queries <= 0 ||
+        settings.maxTerrainCost < 1 || settings.maxTerrainCost > Constants::MAX_TERRAIN_COST) {
+        printUsage(argv[0]);
+        return 2;
+    }
+    return Benchmark::runSuite(settings, std::cout) ? 0 : 1;
+}
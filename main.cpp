@@ -1,17 +1,54 @@
 #include <SFML/Graphics.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
 #include "PathfindingVisualizer.h"
 #include "Constants.h"
+#include "Trace.h"
 
-int main() {
+// Starts recording a trace, or stops and writes it out
+static void toggleTrace(const std::string& filename) {
+    if (!Trace::ENABLED) {
+        std::cerr << "Built without tracing" << std::endl;
+        return;
+    }
+    if (!Trace::isRecording()) {
+        Trace::clear();
+        Trace::setRecording(true);
+        std::cout << "Recording trace" << std::endl;
+        return;
+    }
+    Trace::setRecording(false);
+    if (Trace::write(filename)) {
+        std::cout << "Trace written to " << filename << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
     sf::RenderWindow window(sf::VideoMode(Constants::WINDOW_WIDTH, Constants::WINDOW_HEIGHT),
                           "Pathfinding Visualizer", sf::Style::Close);
     window.setFramerateLimit(60);
 
     PathfindingVisualizer visualizer;
+    std::string traceFile = "trace.json";
+    Trace::setThreadName("main");
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--terrain") == 0) {
+            visualizer.loadTerrain(argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--timing-budget") == 0) {
+            visualizer.setTimingBudget(std::atof(argv[i + 1]));
+        } else if (std::strcmp(argv[i], "--trace") == 0) {
+            traceFile = argv[i + 1];
+            toggleTrace(traceFile);
+        }
+    }
 
     while (window.isOpen()) {
+        TRACE_SCOPE("frame");
         sf::Event event;
         while (window.pollEvent(event)) {
+            TRACE_SCOPE("event");
             if (event.type == sf::Event::Closed) {
                 window.close();
             }
@@ -19,11 +56,34 @@ int main() {
             if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
                 visualizer.handleMouseClick(event.mouseButton.x, event.mouseButton.y);
             }
+
+            if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Right) {
+                visualizer.handleRightClick(event.mouseButton.x, event.mouseButton.y);
+            }
+
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::M) {
+                visualizer.cycleMovement();
+            }
+
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::T) {
+                visualizer.toggleTimingMode();
+            }
+
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::R) {
+                toggleTrace(traceFile);
+            }
         }
 
         visualizer.render(window);
-        window.display();
+        {
+            TRACE_SCOPE("display");
+            window.display();
+        }
     }
 
+    // A trace still recording when the window closes is written out
+    if (Trace::isRecording()) {
+        toggleTrace(traceFile);
+    }
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include <cstring>
+#include <iostream>
+#include "Constants.h"
+#include "Verification.h"
+
+// Headless self-check, run by CTest; like the benchmark it links no SFML
+// library and opens no window, so it runs on a machine without a display.
+//
+// By default it runs every check on few queries and small maps, in seconds.
+// --full runs them ten to fifty times over, which takes several minutes,
+// mostly building a contraction hierarchy for every random map.
+
+// Every planner must agree with BFS on random maps, on path length too for
+// the optimal ones
+static int runVerification(bool full) {
+    const Constants::AlgorithmType algorithms[] = {
+        Constants::DIJKSTRA, Constants::ASTAR, Constants::ALT, Constants::ARA_STAR, Constants::JPS,
+        Constants::JPS_PLUS, Constants::BIDIRECTIONAL_BFS, Constants::BIDIRECTIONAL_DIJKSTRA,
+        Constants::BIT_PARALLEL_BFS, Constants::DIRECTION_OPTIMIZING_BFS, Constants::HPA_STAR,
+        Constants::CONTRACTION_HIERARCHY, Constants::D_STAR_LITE, Constants::FLOW_FIELD
+    };
+
+    // The larger maps of each check, and their query counts
+    int wideRows = full ? 128 : 64;
+    int wideCols = full ? 96 : 48;
+    int wideTrials = full ? 200 : 4;
+    int largeSide = full ? 256 : 128;
+    int largeQueries = full ? 50 : 10;
+
+    bool passed = true;
+    for (Constants::AlgorithmType algorithm : algorithms) {
+        passed &= Verification::compareWithBreadthFirst(algorithm, 32, 32, full ? 2000 : 40, 1, std::cout);
+        passed &= Verification::compareWithBreadthFirst(algorithm, wideRows, wideCols, wideTrials, 2, std::cout);
+    }
+
+    // The multi-agent planners must find shortest paths for a lone agent;
+    // they set up per-team state on every call, so they are left out of the
+    // allocation check below
+    const Constants::AlgorithmType multiAgentAlgorithms[] = {
+        Constants::COOPERATIVE_ASTAR, Constants::CONFLICT_BASED_SEARCH
+    };
+    for (Constants::AlgorithmType algorithm : multiAgentAlgorithms) {
+        passed &= Verification::compareWithBreadthFirst(algorithm, 32, 32, full ? 500 : 40, 1, std::cout);
+    }
+
+    // Planners that honour terrain costs are checked against Dijkstra too
+    const Constants::AlgorithmType weightedAlgorithms[] = {
+        Constants::ASTAR, Constants::ALT, Constants::ARA_STAR, Constants::BIDIRECTIONAL_DIJKSTRA, Constants::CONTRACTION_HIERARCHY,
+        Constants::D_STAR_LITE, Constants::FLOW_FIELD
+    };
+    for (Constants::AlgorithmType algorithm : weightedAlgorithms) {
+        passed &= Verification::compareWithDijkstra(algorithm, 32, 32, full ? 2000 : 40, 3, std::cout);
+    }
+
+    // Diagonal moves, under each corner policy
+    passed &= Verification::checkEightConnected(48, 48, full ? 1000 : 100, 17, std::cout);
+
+    // A warmed-up SearchWorkspace must serve repeated queries without allocating
+    for (Constants::AlgorithmType algorithm : algorithms) {
+        passed &= Verification::checkSteadyStateAllocations(algorithm, largeSide, largeSide, largeQueries, 4, std::cout);
+    }
+    passed &= Verification::checkSteadyStateAllocations(Constants::BFS, largeSide, largeSide, largeQueries, 4, std::cout);
+    passed &= Verification::checkSteadyStateAllocations(Constants::DFS, largeSide, largeSide, largeQueries, 4, std::cout);
+
+    // ARA* stopped at its first path must stay within the bound it reports
+    passed &= Verification::checkAnytimeSearch(128, 128, full ? 1000 : 100, 19, std::cout);
+
+    // A contraction hierarchy must not depend on the thread count that
+    // built it, and must survive a trip through a file
+    passed &= Verification::checkContractionHierarchy(largeSide / 2, largeSide / 2, full ? 2000 : 200, 18,
+                                                        std::cout);
+
+    // Patching the HPA* graph after an edit must match rebuilding it
+    passed &= Verification::checkHierarchyUpdates(96, 80, full ? 500 : 50, 8, std::cout);
+
+    // Patched component labels must match a fresh labelling edit by edit
+    passed &= Verification::checkComponentUpdates(48, 64, full ? 3000 : 300, 12, std::cout);
+
+    // Incremental replanning must track a from-scratch search edit by edit
+    passed &= Verification::checkIncrementalReplanning(64, 64, full ? 2000 : 200, 9, std::cout);
+    passed &= Verification::checkIncrementalReplanning(200, 150, full ? 500 : 50, 10, std::cout);
+
+    // A patched flow field must match one built from scratch
+    passed &= Verification::checkFlowFieldUpdates(64, 64, full ? 2000 : 200, 13, std::cout);
+    passed &= Verification::checkFlowFieldUpdates(200, 150, full ? 300 : 20, 14, std::cout);
+
+    // Teams must reach their goals without two agents ever colliding
+    passed &= Verification::checkMultiAgentPlanning(16, 16, 6, full ? 200 : 20, 15, std::cout);
+    passed &= Verification::checkMultiAgentPlanning(64, 64, 200, full ? 10 : 2, 16, std::cout);
+
+    // Cached paths must never outlive the map revision they were found on
+    passed &= Verification::checkPathCache(64, 64, full ? 5000 : 500, 11, std::cout);
+
+    // Batches fanned out over several threads must match the sequential answers
+    int batchQueries = full ? 2000 : 200;
+    passed &= Verification::compareBatchWithSequential(Constants::ASTAR, 128, 128, batchQueries, 4, 5, std::cout);
+    passed &= Verification::compareBatchWithSequential(Constants::JPS_PLUS, 128, 128, batchQueries, 4, 6, std::cout);
+    passed &= Verification::compareBatchWithSequential(Constants::BIT_PARALLEL_BFS, 128, 128, batchQueries, 4, 7, std::cout);
+    return passed ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    return runVerification(argc > 1 && std::strcmp(argv[1], "--full") == 0);
+}